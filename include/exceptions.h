@@ -17,4 +17,23 @@ private:
     std::string msg_;
 };
 
+// Синтаксическая ошибка в тексте KRL с позицией (строка и столбец считаются с 1)
+class KRLSyntaxError : public std::exception {
+public:
+    KRLSyntaxError(const std::string& message, size_t line, size_t column)
+        : msg_(std::to_string(line) + ":" + std::to_string(column) + ": " + message), line_(line), column_(column) {}
+
+    virtual const char* what() const noexcept override {
+        return msg_.c_str();
+    }
+
+    size_t getLine() const { return line_; }
+    size_t getColumn() const { return column_; }
+
+private:
+    std::string msg_;
+    size_t line_;
+    size_t column_;
+};
+
 #endif // UTILS_H
\ No newline at end of file
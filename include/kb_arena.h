@@ -0,0 +1,87 @@
+#ifndef KB_ARENA_H
+#define KB_ARENA_H
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+using namespace std;
+
+// Монотонный распределитель памяти для сущностей базы знаний.
+// Пока активен KBArenaScope, все объекты KBEntity (узлы выражений, NonFactor, типы,
+// функции принадлежности), создаваемые вручную или через fromXML/fromJSON, размещаются
+// в непрерывных блоках арены. delete для таких объектов вызывает деструктор, но не
+// освобождает память; вся память арены освобождается разом в release() или деструкторе.
+// release() сам разрушает сущности, которые еще не удалены: каждая получает деструктор ровно
+// один раз, поэтому строки и векторы сущностей освобождаются, а удалять деревья заранее не нужно.
+class KBArena
+{
+private:
+    struct Block
+    {
+        char *data;
+        size_t size;
+        size_t used;
+    };
+
+    vector<Block> blocks;
+    size_t blockSize;
+    size_t bytesUsed = 0;
+    // Все сущности, размещенные в арене, в порядке выделения
+    vector<void *> entities;
+    // Сущности, размещенные в арене и еще не удаленные; delete может выполняться в другом потоке
+    atomic<size_t> liveCount{0};
+
+    Block &addBlock(size_t minSize);
+
+public:
+    explicit KBArena(size_t blockSize = 64 * 1024);
+    ~KBArena();
+
+    KBArena(const KBArena &) = delete;
+    KBArena &operator=(const KBArena &) = delete;
+
+    void *allocate(size_t size, size_t alignment = alignof(max_align_t));
+
+    // Разрушает оставшиеся сущности и освобождает все блоки. Деструкторы сущностей не удаляют
+    // дочерние сущности этой арены (см. kbDeleteChild): их разрушает тот же проход, поэтому порядок
+    // обхода не важен и память узлов не освобождается по одному. Указатели на сущности арены
+    // после release() недействительны.
+    void release();
+
+    bool owns(const void *ptr) const;
+    size_t getBlockCount() const { return blocks.size(); }
+    size_t getBytesUsed() const { return bytesUsed; }
+    size_t getLiveCount() const { return liveCount.load(); }
+
+    // Арена, активная в текущем потоке, либо nullptr
+    static KBArena *current();
+    // Арена, в которой размещена сущность, либо nullptr для сущности из кучи
+    static KBArena *of(const void *entity);
+
+    friend class KBArenaScope;
+    friend void *kbEntityAllocate(size_t size);
+    friend void kbEntityDeallocate(void *ptr);
+};
+
+// Делает арену текущей для потока на время жизни объекта
+class KBArenaScope
+{
+private:
+    KBArena *previous;
+
+public:
+    explicit KBArenaScope(KBArena &arena);
+    ~KBArenaScope();
+
+    KBArenaScope(const KBArenaScope &) = delete;
+    KBArenaScope &operator=(const KBArenaScope &) = delete;
+};
+
+// Выделение памяти под сущность: из текущей арены, если она задана, иначе из кучи
+void *kbEntityAllocate(size_t size);
+void kbEntityDeallocate(void *ptr);
+// Сущность принадлежит арене, которая сейчас выполняет release() в этом потоке
+bool kbEntityReleasing(const void *entity);
+
+#endif // KB_ARENA_H
@@ -0,0 +1,134 @@
+#ifndef KB_BACKWARD_H
+#define KB_BACKWARD_H
+
+#include "knowledge_base.h"
+#include "kb_program.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+class KBBackwardSolver;
+
+// Сеанс консультации: введенные факты и таблица уже доказанных подцелей. Один сеанс можно
+// использовать для нескольких запросов - доказанные подцели повторно не выводятся.
+class KBSolverSession
+{
+private:
+    friend class KBBackwardSolver;
+
+    // INCOMPLETE - ответ получен при незавершенной внешней подцели (лидере компоненты
+    // сильной связности) и берется из таблицы, пока лидер не завершит доказательство
+    enum State : uint8_t
+    {
+        OPEN,
+        ACTIVE,
+        INCOMPLETE,
+        SOLVED,
+        FACT
+    };
+
+    vector<KBEvalValue> values;
+    vector<State> states;
+    // Условия правил вычисляются один раз за сеанс
+    vector<KBEvalValue> conditions;
+    vector<State> conditionStates;
+    // Глубина доказательства активных подцелей и условий; у незавершенных - наименьшая глубина
+    // активной подцели, от которой зависит ответ
+    vector<uint32_t> depths;
+    vector<uint32_t> conditionDepths;
+    // Незавершенные подцели и условия в порядке получения ответа
+    vector<uint32_t> pendingGoals;
+    vector<uint32_t> pendingConditions;
+    uint32_t depth = 0;
+    bool derived = false;
+    size_t memoHits = 0;
+    size_t cycles = 0;
+
+    KBSolverSession(size_t slotCount, size_t ruleCount);
+
+public:
+    void setFact(uint32_t slot, const KBEvalValue &value);
+    // Забывает выведенные значения, введенные факты сохраняются
+    void clearDerived();
+
+    bool isSolved(uint32_t slot) const { return states.at(slot) >= SOLVED; }
+    const KBEvalValue &getValue(uint32_t slot) const { return values.at(slot); }
+    // Число ответов, взятых из таблицы доказанных подцелей
+    size_t getMemoHits() const { return memoHits; }
+    // Число обнаруженных циклических зависимостей подцелей
+    size_t getCycles() const { return cycles; }
+};
+
+// Обратный вывод: цель - значение атрибута. Правила индексируются по атрибутам, которые
+// присваивают их действия; для доказательства цели сначала доказываются атрибуты, на которые
+// ссылаются условие и правая часть присваивания. Уверенность вывода не выше уверенности условия
+// правила; из нескольких сработавших правил выбирается вывод с наибольшей уверенностью.
+//
+// Циклы разрешаются табличным выводом: подцель, уже находящаяся в доказательстве, дает свой
+// текущий ответ (сначала неопределенный). Ответы, зависящие от нее, запоминаются как незавершенные
+// и внутри доказательства повторно не выводятся. Лидер компоненты - самая внешняя подцель цикла -
+// повторяет доказательство, пока его ответ не перестанет меняться, и завершает всю компоненту,
+// поэтому ответ не зависит от порядка запросов.
+class KBBackwardSolver
+{
+private:
+    struct RuleEntry
+    {
+        uint32_t condition;
+        vector<uint32_t> premises;
+    };
+
+    struct Conclusion
+    {
+        uint32_t rule;
+        uint32_t value;
+        vector<uint32_t> premises;
+        bool elseBranch;
+    };
+
+    const KnowledgeBase &kb;
+    const KBSlotLayout &layout;
+    uint64_t schemaVersion;
+    vector<KBProgram> programs;
+    vector<RuleEntry> rules;
+    vector<Conclusion> conclusions;
+    // Выводы, присваивающие слот
+    vector<vector<uint32_t>> producers;
+    KBVirtualMachine vm;
+    size_t rulesTried = 0;
+
+    uint32_t addProgram(const Evaluatable *node, vector<uint32_t> &premises);
+    void addConclusions(uint32_t rule, const vector<KBAssign *> &instructions, bool elseBranch);
+    // low - наименьшая глубина незавершенной подцели, от которой зависел результат
+    KBEvalValue solveCondition(KBSolverSession &session, uint32_t rule, uint32_t &low);
+    KBEvalValue solveGoal(KBSolverSession &session, uint32_t slot, uint32_t &low);
+    KBEvalValue proveGoal(KBSolverSession &session, uint32_t slot, uint32_t &reached);
+    // Завершает (solved) либо сбрасывает для нового прохода незавершенные ответы компоненты,
+    // полученные после отметок goalMark и conditionMark
+    void closeComponent(KBSolverSession &session, size_t goalMark, size_t conditionMark, bool solved);
+    void checkSession(const KBSolverSession &session) const;
+
+public:
+    static constexpr uint32_t NONE = UINT32_MAX;
+    // Предел проходов лидера компоненты; цикл через отрицание может не сходиться
+    static constexpr size_t MAX_FIXPOINT_PASSES = 16;
+
+    explicit KBBackwardSolver(KnowledgeBase &kb);
+
+    const KBSlotLayout &getLayout() const { return layout; }
+    KBSolverSession createSession() const;
+
+    // Правила, присваивающие атрибут слота, в порядке базы
+    vector<uint32_t> getProducers(uint32_t slot) const;
+
+    // Значение атрибута; неопределенное, если ни одно правило не дает вывода
+    const KBEvalValue &solve(KBSolverSession &session, uint32_t slot);
+    const KBEvalValue &solve(KBSolverSession &session, const string &path);
+
+    // Число проверенных выводов правил за все запросы
+    size_t getRulesTried() const { return rulesTried; }
+};
+
+#endif // KB_BACKWARD_H
@@ -0,0 +1,54 @@
+#ifndef KB_BATCH_H
+#define KB_BATCH_H
+
+#include "kb_program.h"
+#include <cstddef>
+#include <vector>
+
+using namespace std;
+
+// Столбец значений одной ссылки программы.
+// Числа хранятся как есть, логические значения - как 0/1, символы - как дескриптор KBSymbol,
+// неопределенное значение - NaN. Вид значений задается для всего столбца и учитывается
+// операциями так же, как в KBVirtualMachine: сравнение по порядку и арифметика определены
+// только для чисел, символ не имеет истинности, значения разных видов не равны.
+struct KBColumn
+{
+    const double *values = nullptr;
+    KBEvalValue::Kind kind = KBEvalValue::NUMBER;
+    const double *belief = nullptr;      // nullptr - для всех строк используется defaultBelief
+    const double *probability = nullptr; // nullptr - для всех строк используется defaultProbability
+    double defaultBelief = 50.0;
+    double defaultProbability = 100.0;
+};
+
+// Векторное вычисление KBProgram над множеством строк фактов в столбцовом формате
+class KBBatchEvaluator
+{
+private:
+    const KBProgram &program;
+    vector<double> values;
+    vector<double> belief;
+    vector<double> probability;
+    vector<double> constants;
+    // Вид значений каждого элемента стека; одинаков для всех строк блока
+    vector<KBEvalValue::Kind> kinds;
+    KBEvalValue::Kind resultKind = KBEvalValue::UNDEFINED;
+
+    void runBlock(const vector<KBColumn> &columns, size_t offset, size_t count);
+
+public:
+    // Количество строк, обрабатываемых одним проходом по программе
+    static constexpr size_t BLOCK_SIZE = 256;
+
+    KBBatchEvaluator(const KBProgram &program);
+
+    // columns - по одному столбцу на каждую ссылку программы (в порядке getReferences()),
+    // у программы с раскладкой - на каждый слот раскладки;
+    // result и resultBelief должны вмещать rows значений, resultProbability может быть nullptr
+    void run(const vector<KBColumn> &columns, size_t rows, double *result, double *resultBelief, double *resultProbability = nullptr);
+    // Вид значений результата последнего run(); строки с NaN не определены
+    KBEvalValue::Kind getResultKind() const { return resultKind; }
+};
+
+#endif // KB_BATCH_H
@@ -0,0 +1,76 @@
+#ifndef KB_DEFUZZIFY_H
+#define KB_DEFUZZIFY_H
+
+#include "kb_type.h"
+#include <cstddef>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Дефазификация объединения термов выходного нечеткого типа. Каждый терм ограничивается (CLIP, min)
+// или масштабируется (SCALE, произведение) своей степенью активации, результат - максимум по термам.
+// Объединение кусочно-линейно, поэтому площадь, момент и максимум считаются аналитически по отрезкам,
+// без выборки по сетке. Разбиение области по точкам всех термов строится один раз в конструкторе.
+class KBDefuzzifier
+{
+public:
+    enum Implication
+    {
+        CLIP,
+        SCALE
+    };
+
+    enum Method
+    {
+        CENTROID,
+        BISECTOR,
+        MEAN_OF_MAX
+    };
+
+    // Линейный отрезок объединения: y0 - предел справа в x0, y1 - предел слева в x1
+    struct Segment
+    {
+        double x0;
+        double x1;
+        double y0;
+        double y1;
+    };
+
+private:
+    vector<string> names;
+    Implication implication;
+    // Границы отрезков разбиения: на каждом отрезке все термы линейны
+    vector<double> bounds;
+    // Значения термов на концах отрезков: [interval * termCount + term]
+    vector<double> left;
+    vector<double> right;
+
+    void addEnvelope(double x0, double x1, const vector<double> &y0, const vector<double> &y1, vector<Segment> &out) const;
+
+public:
+    explicit KBDefuzzifier(const KBFuzzyType &type, Implication implication = CLIP);
+    explicit KBDefuzzifier(const vector<MembershipFunction *> &functions, Implication implication = CLIP);
+
+    size_t getTermCount() const { return names.size(); }
+    const string &getTermName(size_t term) const { return names.at(term); }
+    Implication getImplication() const { return implication; }
+    // Область определения - объединение [min, max] термов
+    double getMin() const { return bounds.empty() ? 0.0 : bounds.front(); }
+    double getMax() const { return bounds.empty() ? 0.0 : bounds.back(); }
+
+    // Объединение термов с активациями activations[getTermCount()]; активации ограничиваются [0, 1]
+    void aggregate(const double *activations, vector<Segment> &out) const;
+    vector<Segment> aggregate(const vector<double> &activations) const;
+
+    // Четкое значение; NaN, если площадь объединения равна 0
+    double defuzzify(const double *activations, Method method) const;
+    double defuzzify(const vector<double> &activations, Method method) const;
+
+    static double centroid(const vector<Segment> &segments);
+    static double bisector(const vector<Segment> &segments);
+    // Среднее точек максимума: центр масс участков на уровне максимума, либо среднее отдельных точек
+    static double meanOfMax(const vector<Segment> &segments);
+};
+
+#endif // KB_DEFUZZIFY_H
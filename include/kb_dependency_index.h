@@ -0,0 +1,51 @@
+#ifndef KB_DEPENDENCY_INDEX_H
+#define KB_DEPENDENCY_INDEX_H
+
+#include "kb_symbol_index.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+class Evaluatable;
+class KBReference;
+class KBRule;
+
+// Использование атрибута в правиле
+struct KBDependency
+{
+    const KBReference *ref;
+    // Ближайшее выражение, содержащее ссылку (по цепочке owner), либо сама ссылка,
+    // если она - все выражение
+    const Evaluatable *expression;
+    // Номер правила в KnowledgeBase::getRules()
+    uint32_t rule;
+    // true - ссылка из условия, false - из правой части присваивания
+    bool condition;
+};
+
+// Обратный индекс: путь ОБЪЕКТ.АТРИБУТ -> выражения правил, которые его читают.
+// Пополняется по одному правилу; цели присваиваний не индексируются, так как их значение
+// правилом не читается.
+class KBDependencyIndex
+{
+private:
+    KBSymbolIndex pathIndex;
+    vector<vector<KBDependency>> dependents;
+
+    void addExpression(const Evaluatable *node, uint32_t rule, bool condition);
+
+public:
+    void addRule(const KBRule *rule, uint32_t ruleIndex);
+    void clear();
+
+    // Количество различных путей в индексе
+    size_t size() const { return dependents.size(); }
+
+    const vector<KBDependency> &getDependents(KBSymbol path) const;
+    // Номера правил, условия которых читают хотя бы один из путей, по возрастанию без повторов
+    vector<uint32_t> getAffectedRules(const vector<KBSymbol> &paths) const;
+};
+
+#endif // KB_DEPENDENCY_INDEX_H
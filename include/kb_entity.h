@@ -6,31 +6,62 @@
 #include <vector>
 #include <libxml/tree.h>
 #include <json/value.h>
+#include "kb_arena.h"
+#include "kb_symbol.h"
+#include "kb_xml_writer.h"
+#include "kb_json_writer.h"
 
 using namespace std;
 
 class KnowledgeBase;
+class KBEntity;
+
+// Ошибка, найденная при проверке сущности в контексте базы знаний
+struct KBDiagnostic
+{
+    const KBEntity *entity;
+    string message;
+};
 
 class KBEntity
 {
 private:
-    string tag;
+    KBSymbol tag;
     bool validated = false;
 
 public:
-    KBEntity(const string tag);
-    string getTag() const { return tag; };
-    void setTag(const string& tag) { this->tag = tag; };
-    virtual string KRL() const { return ""; };
+    KBEntity(KBSymbol tag);
+    const string& getTag() const { return tag.str(); };
+    KBSymbol getTagSymbol() const { return tag; };
+    void setTag(KBSymbol tag) { this->tag = tag; };
+    virtual string KRL() const;
+    // Дописывает KRL-представление сущности в общий буфер
+    virtual void writeKRL(string &) const { };
     virtual map<string, string> getAttrs() const;
+    // Атрибуты сущности; наследники дополняют список базового класса
+    virtual void collectAttrs(KBAttrList &) const { };
     virtual xmlNodePtr toXML() const;
     virtual vector<xmlNodePtr> getInnerXML() const;
+    // Потоковая запись XML без построения дерева xmlNode (см. KBXMLWriter)
+    virtual void writeXML(KBXMLWriter &writer) const;
+    virtual void writeInnerXML(KBXMLWriter &) const { };
     virtual Json::Value toJSON() const;
-    virtual bool validate(const KnowledgeBase &kb) { return true; };
+    // Потоковая запись JSON без построения Json::Value (см. KBJSONWriter)
+    virtual void writeJSON(KBJSONWriter &writer) const;
+    // Проверка сущности в контексте базы знаний: наследники дописывают найденные ошибки
+    // и проверяют вложенные сущности через validate(kb, diagnostics)
+    virtual void collectDiagnostics(const KnowledgeBase &, vector<KBDiagnostic> &) const { };
+    // Проверяет сущность и отмечает ее проверенной, если ошибок не найдено
+    bool validate(const KnowledgeBase &kb, vector<KBDiagnostic> &diagnostics);
+    virtual bool validate(const KnowledgeBase &kb);
     virtual ~KBEntity() { };
     virtual string getXMLOwnerPath() const { return ""; };
 
     bool isValidated() const { return validated; }
+
+    // Размещение в текущей арене (см. KBArenaScope) либо в куче
+    static void *operator new(size_t size) { return kbEntityAllocate(size); }
+    static void operator delete(void *ptr) { kbEntityDeallocate(ptr); }
     // static KBEntity fromXML(xmlNodePtr node);
     // static KBEntity fromJSON(const Json::Value &json);
 
@@ -38,25 +69,36 @@ public:
     KBEntity *owner = nullptr;
 };
 
+// Удаляет дочернюю сущность из деструктора владельца. Во время KBArena::release() дочерние
+// сущности освобождаемой арены пропускаются: их разрушает сама арена.
+inline void kbDeleteChild(KBEntity *child)
+{
+    if (child != nullptr && !kbEntityReleasing(child))
+    {
+        delete child;
+    }
+}
+
 
 class KBIdentity : public KBEntity 
 {
 private:
-    string id;
+    KBSymbol id;
     char* desc;
 
 public:
-    KBIdentity(const string id, const string tag, const char* desc);
-    string getId() const { return id; };
-    void setId(const string& id) { this->id = id; };
+    KBIdentity(KBSymbol id, KBSymbol tag, const char* desc);
+    const string& getId() const { return id.str(); };
+    KBSymbol getIdSymbol() const { return id; };
+    void setId(KBSymbol id) { this->id = id; };
 
     char* getDesc() const { return desc; };
     void setDesc(const char* desc);
-    string getComment() const { return desc != nullptr ? desc : id; };
+    string getComment() const { return desc != nullptr ? desc : id.str(); };
 
     virtual ~KBIdentity() {free(desc);}
 
-    virtual map<string, string> getAttrs() const;
+    virtual void collectAttrs(KBAttrList &attrs) const override;
 };
 
 #endif // KB_ENTITY_H
\ No newline at end of file
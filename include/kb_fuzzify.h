@@ -0,0 +1,65 @@
+#ifndef KB_FUZZIFY_H
+#define KB_FUZZIFY_H
+
+#include "kb_type.h"
+#include <cstddef>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Пакетная фазификация значений по всем термам нечеткого типа.
+// Кривая терма раскладывается в сумму ограниченных рамп и ступенек:
+//   μ(x) = y0 + Σ slope * (clamp(x, a, b) - a) + Σ jump * (x >= s),
+// поэтому каждый отрезок обрабатывается одним проходом без ветвлений по блоку значений,
+// который векторизуется компилятором. Результат совпадает с MembershipFunction::evaluateExact():
+// разложение точной кривой не дороже таблицы, поэтому режим таблицы терма не используется.
+// NaN (неопределенное значение) дает NaN.
+class KBFuzzifier
+{
+private:
+    struct Ramp
+    {
+        double from;
+        double to;
+        double slope;
+    };
+
+    struct Step
+    {
+        double at;
+        double jump;
+    };
+
+    struct Term
+    {
+        string name;
+        double base;
+        size_t firstRamp;
+        size_t rampCount;
+        size_t firstStep;
+        size_t stepCount;
+        // Терм без точек тождественно равен 0, в том числе для NaN
+        bool empty;
+    };
+
+    vector<Term> terms;
+    vector<Ramp> ramps;
+    vector<Step> steps;
+
+public:
+    // Количество значений, обрабатываемых одним проходом по отрезкам
+    static constexpr size_t BLOCK_SIZE = 256;
+
+    explicit KBFuzzifier(const KBFuzzyType &type);
+    explicit KBFuzzifier(const vector<MembershipFunction *> &functions);
+
+    size_t getTermCount() const { return terms.size(); }
+    const string &getTermName(size_t term) const { return terms.at(term).name; }
+
+    // degrees - матрица getTermCount() x count по строкам: degrees[term * count + i] = μ_term(x[i])
+    void fuzzify(const double *x, size_t count, double *degrees) const;
+    vector<double> fuzzify(const vector<double> &x) const;
+};
+
+#endif // KB_FUZZIFY_H
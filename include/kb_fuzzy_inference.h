@@ -0,0 +1,148 @@
+#ifndef KB_FUZZY_INFERENCE_H
+#define KB_FUZZY_INFERENCE_H
+
+#include "knowledge_base.h"
+#include "kb_fuzzify.h"
+#include "kb_defuzzify.h"
+#include "kb_batch.h"
+#include "kb_program.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+// Нечеткий вывод по правилам базы знаний. Нечеткое правило - правило, условие которого состоит из
+// сравнений ОБЪЕКТ.АТРИБУТ == "терм" (атрибут нечеткого типа), связанных &, | и !; ветка ИНАЧЕ
+// не используется. Действие правила определяет модель выхода:
+//   - атрибут нечеткого типа = "терм" - Мамдани: термы выхода ограничиваются или масштабируются
+//     активацией правила, объединяются по максимуму и дефазифицируются KBDefuzzifier;
+//   - числовой атрибут = выражение - Сугено: среднее значений выражений, взвешенное активациями.
+// Правила с другими условиями в вывод не входят.
+//
+// Входы - нечеткие атрибуты из условий и атрибуты из выражений Сугено; они обрабатываются пакетами
+// строк: фазификация всех входов, активации всех правил и выражения Сугено вычисляются по блоку
+// строк циклами без ветвлений, после чего выходы собираются по строкам.
+class KBFuzzyInference
+{
+public:
+    // Операции И/ИЛИ: min/max либо произведение и вероятностная сумма a + b - ab; НЕ - 1 - a
+    enum Norm
+    {
+        MIN_MAX,
+        PRODUCT
+    };
+
+    struct Options
+    {
+        Norm norm = MIN_MAX;
+        KBDefuzzifier::Implication implication = KBDefuzzifier::CLIP;
+        KBDefuzzifier::Method method = KBDefuzzifier::CENTROID;
+    };
+
+private:
+    enum Code : uint8_t
+    {
+        TERM,
+        AND,
+        OR,
+        NOT
+    };
+
+    // Постфиксная запись условия; arg команды TERM - строка матрицы степеней принадлежности
+    struct Instruction
+    {
+        Code code;
+        uint32_t arg;
+    };
+
+    struct Input
+    {
+        uint32_t slot;
+        // Фазификатор нечеткого входа; у входа, используемого только выражениями Сугено, - nullptr
+        unique_ptr<KBFuzzifier> fuzzifier;
+        uint32_t firstRow;
+    };
+
+    struct Output
+    {
+        uint32_t slot;
+        // Дефазификатор выхода Мамдани; у выхода Сугено - nullptr
+        unique_ptr<KBDefuzzifier> defuzzifier;
+    };
+
+    struct Consequent
+    {
+        uint32_t rule;
+        uint32_t output;
+        // Терм выхода Мамдани либо индекс выражения Сугено
+        uint32_t term;
+    };
+
+    struct Rule
+    {
+        const KBRule *rule;
+        size_t firstInstruction;
+        size_t instructionCount;
+    };
+
+    KnowledgeBase &kb;
+    const KBSlotLayout &layout;
+    uint64_t schemaVersion;
+    // Количество правил базы при создании, включая не нечеткие
+    size_t ruleCount;
+    Options options;
+    vector<Input> inputs;
+    vector<Output> outputs;
+    vector<Rule> rules;
+    vector<Instruction> code;
+    vector<Consequent> consequents;
+    vector<KBProgram> programs;
+    vector<KBBatchEvaluator> evaluators;
+    size_t termRows = 0;
+    size_t maxDepth = 0;
+    vector<double> degrees;
+    vector<double> stack;
+
+    uint32_t addInput(uint32_t slot);
+    uint32_t addFuzzyInput(uint32_t slot, const KBFuzzyType *type);
+    uint32_t addOutput(uint32_t slot, const KBFuzzyType *type);
+    // Условие в постфиксной записи; arg команды TERM - номер сравнения в atoms
+    bool compileCondition(const Evaluatable *node, vector<Instruction> &out, vector<pair<const KBReference *, uint32_t>> &atoms) const;
+    bool addRule(const KBRule *rule);
+    void activateBlock(const double *inputValues, size_t rows, size_t offset, size_t count, double *activations);
+    void checkCurrent() const;
+
+public:
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    explicit KBFuzzyInference(KnowledgeBase &kb);
+    KBFuzzyInference(KnowledgeBase &kb, const Options &options);
+
+    const KBSlotLayout &getLayout() const { return layout; }
+    const Options &getOptions() const { return options; }
+
+    size_t getInputCount() const { return inputs.size(); }
+    uint32_t getInputSlot(size_t input) const { return inputs.at(input).slot; }
+    // Номер входа по пути ОБЪЕКТ.АТРИБУТ либо NONE
+    uint32_t getInputIndex(const string &path) const;
+    size_t getOutputCount() const { return outputs.size(); }
+    uint32_t getOutputSlot(size_t output) const { return outputs.at(output).slot; }
+    uint32_t getOutputIndex(const string &path) const;
+    bool isSugeno(size_t output) const { return !outputs.at(output).defuzzifier; }
+    size_t getRuleCount() const { return rules.size(); }
+    const KBRule *getRule(size_t rule) const { return rules.at(rule).rule; }
+
+    // Матрицы хранятся по столбцам: inputValues[input * rows + row], activations[rule * rows + row],
+    // outputValues[output * rows + row]. Неопределенный вход (NaN) не принадлежит ни одному терму.
+    void activate(const double *inputValues, size_t rows, double *activations);
+    // Выходы; выход, на который не подействовало ни одно правило, - NaN
+    void run(const double *inputValues, size_t rows, double *outputValues);
+    // Выходы для одного вектора входов в порядке getInputSlot()
+    vector<double> infer(const vector<double> &inputValues);
+};
+
+#endif // KB_FUZZY_INFERENCE_H
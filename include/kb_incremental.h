@@ -0,0 +1,79 @@
+#ifndef KB_INCREMENTAL_H
+#define KB_INCREMENTAL_H
+
+#include "knowledge_base.h"
+#include "kb_program.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Инкрементальное вычисление условий правил. Каждый узел условия хранит последний результат
+// вместе с коэффициентом уверенности; изменение факта помечает устаревшими только узлы-ссылки
+// на его слот и их предков (родитель узла - его owner), следующий запрос пересчитывает лишь
+// устаревшие узлы. Состояние вычислителя - снимок схемы и правил базы на момент создания:
+// после их изменения вычислитель нужно создать заново.
+class KBIncrementalEvaluator
+{
+private:
+    enum NodeKind : uint8_t
+    {
+        CONSTANT,
+        REFERENCE,
+        OPERATION
+    };
+
+    struct Node
+    {
+        KBEvalValue value;
+        KBNonFactorValue with;
+        uint32_t parent;
+        uint32_t left;
+        uint32_t right;
+        uint32_t slot;
+        KBOpCode code;
+        NodeKind kind;
+        bool hasWith;
+        bool dirty;
+    };
+
+    const KnowledgeBase &kb;
+    const KBSlotLayout &layout;
+    uint64_t schemaVersion;
+    vector<KBEvalValue> memory;
+    vector<Node> nodes;
+    // Корень условия каждого правила базы либо NONE
+    vector<uint32_t> conditions;
+    // Узлы-ссылки каждого слота
+    vector<vector<uint32_t>> slotReferences;
+    size_t recomputed = 0;
+
+    uint32_t build(const Evaluatable *node, uint32_t parent);
+    void markDirty(uint32_t node);
+    const KBEvalValue &compute(uint32_t node);
+    void checkCurrent() const;
+
+public:
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    // Привязывает ссылки правил базы (KnowledgeBase::bindReferences()) и строит узлы условий
+    explicit KBIncrementalEvaluator(KnowledgeBase &kb);
+
+    const KBSlotLayout &getLayout() const { return layout; }
+    const vector<KBEvalValue> &getMemory() const { return memory; }
+    // Число пересчитанных узлов с момента создания
+    size_t getRecomputedCount() const { return recomputed; }
+
+    // Записывает факт; возвращает false, если значение не изменилось (узлы остаются актуальными)
+    bool set(uint32_t slot, const KBEvalValue &value);
+    bool set(KBSymbol object, KBSymbol property, const KBEvalValue &value);
+    bool set(const string &path, const KBEvalValue &value);
+
+    // Значение условия правила с номером rule в KnowledgeBase::getRules();
+    // правило без условия считается истинным
+    KBEvalValue evaluateCondition(uint32_t rule);
+    KBEvalValue evaluateCondition(const KBRule *rule);
+};
+
+#endif // KB_INCREMENTAL_H
@@ -0,0 +1,78 @@
+#ifndef KB_JSON_READER_H
+#define KB_JSON_READER_H
+
+#include "kb_type.h"
+#include "kb_value.h"
+#include "kb_operation.h"
+#include "kb_reference.h"
+#include "non_factor.h"
+#include "membership_function.h"
+#include <string>
+#include <string_view>
+#include <functional>
+
+using namespace std;
+
+// Потоковое чтение JSON: лексер идет по тексту один раз, сущности строятся по мере
+// чтения полей объекта, дерево Json::Value не создается. Порядок ключей в объектах не важен,
+// неизвестные ключи пропускаются.
+class KBJSONReader
+{
+private:
+    string buffer;
+    void *mapped = nullptr;
+    size_t mappedSize = 0;
+    const char *begin = nullptr;
+    const char *pos = nullptr;
+    const char *end = nullptr;
+    // Строки с escape-последовательностями раскодируются сюда
+    string scratch;
+
+    void open(const char *data, size_t size);
+    [[noreturn]] void error(const string &message) const;
+    char peek();
+    void expect(char c);
+    void expectWord(const char *word);
+    string_view readStringView();
+    string readString();
+    double readNumber();
+    bool readBool();
+    bool readNull();
+    void skipValue();
+
+    // Обходит поля объекта. Обработчик обязан прочитать значение поля;
+    // ключ действителен только до начала чтения значения.
+    void readObject(const function<void(string_view key)> &onMember);
+    void readArray(const function<void()> &onElement);
+
+    KBJSONReader() = default;
+
+public:
+    explicit KBJSONReader(const string &json);
+    ~KBJSONReader();
+
+    KBJSONReader(const KBJSONReader &) = delete;
+    KBJSONReader &operator=(const KBJSONReader &) = delete;
+
+    // Открывает файл через mmap; содержимое не копируется в память процесса
+    static KBJSONReader *fromFile(const string &path);
+
+    bool atEnd();
+    void expectEnd();
+
+    // Читает массив верхнего уровня; handler должен прочитать очередной элемент
+    void forEachElement(const function<void(KBJSONReader &)> &handler);
+
+    // Чтение сущностей. Текущим должно быть начало объекта сущности;
+    // после возврата читатель стоит за его закрывающей скобкой.
+    KBType *readType();
+    Evaluatable *readEvaluatable();
+    KBReference *readReference();
+    KBOperation *readOperation();
+    KBValue *readValue();
+    NonFactor *readNonFactor();
+    MembershipFunction *readMembershipFunction();
+    MFPoint *readPoint();
+};
+
+#endif // KB_JSON_READER_H
@@ -0,0 +1,65 @@
+#ifndef KB_JSON_WRITER_H
+#define KB_JSON_WRITER_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace std;
+
+class KBEntity;
+
+// Потоковый сериализатор JSON: пишет сущности в растущий буфер или в файловый дескриптор
+// за один проход, без построения Json::Value. Форма объектов совпадает с toJSON(): те же ключи
+// в том же (алфавитном) порядке, вещественные числа с дробной частью, как у jsoncpp.
+// Строки выводятся в UTF-8 без \u-экранирования.
+class KBJSONWriter
+{
+private:
+    string buffer;
+    int fd = -1;
+    size_t flushThreshold = 0;
+    // Для каждого открытого объекта или массива: записан ли в него хотя бы один элемент
+    vector<bool> nonEmpty;
+    bool afterKey = false;
+
+    void beforeValue();
+    void maybeFlush();
+    void escape(string_view value);
+
+public:
+    KBJSONWriter() = default;
+    // Запись в файловый дескриптор; буфер сбрасывается при превышении bufferSize байт
+    explicit KBJSONWriter(int fd, size_t bufferSize = 64 * 1024);
+    ~KBJSONWriter();
+
+    KBJSONWriter(const KBJSONWriter &) = delete;
+    KBJSONWriter &operator=(const KBJSONWriter &) = delete;
+
+    void startObject();
+    void endObject();
+    void startArray();
+    void endArray();
+    void key(string_view name);
+
+    void value(string_view value);
+    void value(const string &value) { this->value(string_view(value)); }
+    void value(const char *value) { this->value(string_view(value)); }
+    void value(double value);
+    void value(bool value);
+    void null();
+
+    template <typename T>
+    void member(string_view name, const T &value)
+    {
+        key(name);
+        this->value(value);
+    }
+
+    void write(const KBEntity &entity);
+
+    void flush();
+    const string &str() const { return buffer; }
+};
+
+#endif // KB_JSON_WRITER_H
@@ -0,0 +1,90 @@
+#ifndef KB_KRL_PARSER_H
+#define KB_KRL_PARSER_H
+
+#include "kb_type.h"
+#include "kb_value.h"
+#include "kb_operation.h"
+#include "kb_reference.h"
+#include "non_factor.h"
+#include "membership_function.h"
+#include "exceptions.h"
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace std;
+
+// Разбор текста KRL в том виде, в котором его формируют методы KRL() сущностей.
+// Лексемы ссылаются на исходный текст без копирования, поэтому текст должен жить дольше разборщика.
+// При ошибке бросается KRLSyntaxError с номером строки и столбца.
+class KBKRLParser
+{
+private:
+    enum class TokenKind
+    {
+        END,
+        IDENT,
+        NUMBER,
+        STRING,
+        SIGN,
+        LPAREN,
+        RPAREN,
+        LBRACKET,
+        RBRACKET,
+        LBRACE,
+        RBRACE,
+        SEMICOLON,
+        DOT,
+    };
+
+    struct Token
+    {
+        TokenKind kind = TokenKind::END;
+        string_view text;
+        size_t offset = 0;
+        size_t line = 1;
+        size_t column = 1;
+    };
+
+    string_view text;
+    size_t pos = 0;
+    size_t line = 1;
+    size_t lineStart = 0;
+    Token current;
+
+    Token lex();
+    void advance() { current = lex(); }
+    Token peekNext();
+    [[noreturn]] void fail(const string &message) const;
+    [[noreturn]] void fail(const string &message, const Token &token) const;
+    bool isKeyword(string_view keyword) const;
+    void expect(TokenKind kind, const char *what);
+    void expectKeyword(string_view keyword);
+    string restOfLine();
+
+    double parseNumber();
+    Evaluatable *parseBinary(int minPrecedence);
+    Evaluatable *parseUnary();
+    Evaluatable *parsePrimary();
+    KBReference *parseReference();
+    bool parseBinaryOperator(KBOperator &op);
+    MembershipFunction *parseMembershipFunction();
+
+public:
+    explicit KBKRLParser(string_view text);
+
+    bool atEnd() const { return current.kind == TokenKind::END; }
+    // Бросает KRLSyntaxError, если после разобранной сущности остался текст
+    void expectEnd() const;
+
+    // ТИП <имя> ЧИСЛО|СИМВОЛ|НЕЧЕТКИЙ|АБСТРАКТНЫЙ ... КОММЕНТАРИЙ <текст>
+    KBType *parseType();
+    // Все типы до конца текста
+    vector<KBType *> parseTypes();
+    // Выражение с необязательным суффиксом УВЕРЕННОСТЬ [b; p] ТОЧНОСТЬ a
+    Evaluatable *parseExpression();
+    // УВЕРЕННОСТЬ [b; p] ТОЧНОСТЬ a
+    NonFactor *parseNonFactor();
+};
+
+#endif // KB_KRL_PARSER_H
@@ -0,0 +1,70 @@
+#ifndef KB_OBJECT_H
+#define KB_OBJECT_H
+
+#include "kb_entity.h"
+#include "kb_symbol_index.h"
+#include <libxml/tree.h>
+#include <json/json.h>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Атрибут объекта: имя и ссылка на тип по идентификатору
+class KBProperty : public KBIdentity
+{
+private:
+    KBSymbol type;
+
+public:
+    KBProperty(KBSymbol id, KBSymbol type, const char *desc = nullptr);
+
+    const string &getType() const { return type.str(); }
+    KBSymbol getTypeSymbol() const { return type; }
+
+    void collectAttrs(KBAttrList &attrs) const override;
+    void writeKRL(string &out) const override;
+    void collectDiagnostics(const KnowledgeBase &kb, vector<KBDiagnostic> &diagnostics) const override;
+
+    static KBProperty *fromXML(xmlNodePtr node);
+    static KBProperty *fromJSON(const Json::Value &json);
+};
+
+// Объект (класс) базы знаний со списком атрибутов
+class KBObject : public KBIdentity
+{
+private:
+    KBSymbol group;
+    vector<KBProperty *> properties;
+    KBSymbolIndex propertyIndex;
+
+public:
+    KBObject(KBSymbol id, const vector<KBProperty *> &properties = {}, KBSymbol group = KBSymbol(), const char *desc = nullptr);
+    ~KBObject();
+
+    KBObject(const KBObject &) = delete;
+    KBObject &operator=(const KBObject &) = delete;
+
+    const string &getGroup() const { return group.str(); }
+    KBSymbol getGroupSymbol() const { return group; }
+    const vector<KBProperty *> &getProperties() const { return properties; }
+
+    // Принимает владение атрибутом; бросает invalid_argument при повторном имени
+    void addProperty(KBProperty *property);
+    // Номер атрибута в getProperties() либо KBSymbolIndex::NOT_FOUND
+    uint32_t getPropertyIndex(KBSymbol id) const { return propertyIndex.find(id); }
+    KBProperty *getProperty(KBSymbol id) const;
+
+    void collectAttrs(KBAttrList &attrs) const override;
+    vector<xmlNodePtr> getInnerXML() const override;
+    void writeInnerXML(KBXMLWriter &writer) const override;
+    Json::Value toJSON() const override;
+    void writeJSON(KBJSONWriter &writer) const override;
+    void writeKRL(string &out) const override;
+    void collectDiagnostics(const KnowledgeBase &kb, vector<KBDiagnostic> &diagnostics) const override;
+
+    static KBObject *fromXML(xmlNodePtr node);
+    static KBObject *fromJSON(const Json::Value &json);
+};
+
+#endif // KB_OBJECT_H
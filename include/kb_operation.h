@@ -8,18 +8,63 @@
 #include <string>
 #include <map>
 #include <vector>
+#include <cstdint>
 
 using namespace std;
 
 extern const map<string, map<string, string>> TAGS_SIGNS;
 
+enum class KBOperator : uint8_t {
+    EQ, GT, GE, LT, LE, NE,
+    AND, OR, NOT, XOR,
+    NEG, ADD, SUB, MUL, DIV, MOD, POW
+};
+
+// Описание операции: тег XML, допустимые знаки (первый - канонический), арность, метакласс
+struct KBOperatorInfo {
+    KBOperator op;
+    const char* tag;
+    const char* signs[3];
+    bool binary;
+    bool convertNonFactor;
+    const char* meta;
+};
+
+inline constexpr KBOperatorInfo KB_OPERATORS[] = {
+    {KBOperator::EQ, "eq", {"==", "=", "eq"}, true, true, "eq"},
+    {KBOperator::GT, "gt", {">", "gt", nullptr}, true, true, "eq"},
+    {KBOperator::GE, "ge", {">=", "ge", nullptr}, true, true, "eq"},
+    {KBOperator::LT, "lt", {"<", "lt", nullptr}, true, true, "eq"},
+    {KBOperator::LE, "le", {"<=", "le", nullptr}, true, true, "eq"},
+    {KBOperator::NE, "ne", {"!=", "<>", "ne"}, true, true, "eq"},
+    {KBOperator::AND, "and", {"&&", "&", "and"}, true, false, "log"},
+    {KBOperator::OR, "or", {"||", "|", "or"}, true, false, "log"},
+    {KBOperator::NOT, "not", {"!", "~", "not"}, false, false, "log"},
+    {KBOperator::XOR, "xor", {"xor", nullptr, nullptr}, true, false, "log"},
+    {KBOperator::NEG, "neg", {"-", "neg", nullptr}, false, false, "super_math"},
+    {KBOperator::ADD, "add", {"+", "add", nullptr}, true, false, "math"},
+    {KBOperator::SUB, "sub", {"-", "sub", nullptr}, true, false, "math"},
+    {KBOperator::MUL, "mul", {"*", "mul", nullptr}, true, false, "math"},
+    {KBOperator::DIV, "div", {"/", "div", nullptr}, true, false, "math"},
+    {KBOperator::MOD, "mod", {"%", "mod", nullptr}, true, false, "super_math"},
+    {KBOperator::POW, "pow", {"^", "**", "pow"}, true, false, "super_math"},
+};
+
+inline constexpr size_t KB_OPERATORS_COUNT = sizeof(KB_OPERATORS) / sizeof(KB_OPERATORS[0]);
+
+constexpr const KBOperatorInfo& operatorInfo(KBOperator op) { return KB_OPERATORS[static_cast<size_t>(op)]; }
+
+// Точное сопоставление знака с операцией заданной арности
+bool parseOperatorSign(const string& sign, bool binary, KBOperator& op);
+// Поиск операции по тегу XML (eq, add, ...)
+bool parseOperatorTag(const string& tag, KBOperator& op);
+
 class KBOperation : public Evaluatable {
 private:
     string id;
     Evaluatable* left;
     Evaluatable* right;
-    string op;
-    bool convert_non_factor;
+    KBOperator op;
 
 public:
     KBOperation(const string& sign, Evaluatable* left, Evaluatable* right = nullptr, NonFactor* non_factor = nullptr);
@@ -34,20 +79,28 @@ public:
     const Evaluatable* getRight() const { return right; }
     void setRight(Evaluatable* right) { this->right = right; }
 
-    string getOp() const { return op; }
-    void setOp(const string& op) { this->op = op; }
+    string getOp() const { return operatorInfo(op).tag; }
+    void setOp(const string& op);
+
+    KBOperator getOperator() const { return op; }
+    void setOperator(KBOperator op);
 
-    bool isBinary() const;
-    string getSign() const;
+    bool isBinary() const { return operatorInfo(op).binary; }
+    string getSign() const { return operatorInfo(op).signs[0]; }
+    string getMeta() const { return operatorInfo(op).meta; }
+    bool getConvertOperatorNonFactor() const { return operatorInfo(op).convertNonFactor; }
 
-    map<string, string> getAttrs() const override;
+    void collectAttrs(KBAttrList& attrs) const override;
     vector<xmlNodePtr> getInnerXML() const override;
+    void writeInnerXML(KBXMLWriter& writer) const override;
     Json::Value toJSON() const override;
+    void writeJSON(KBJSONWriter& writer) const override;
 
     static KBOperation* fromXML(xmlNodePtr node);
     static KBOperation* fromJSON(const Json::Value& json);
 
-    string getInnerKRL() const override;
+    void writeInnerKRL(string& out) const override;
+    void collectDiagnostics(const KnowledgeBase& kb, vector<KBDiagnostic>& diagnostics) const override;
 };
 
 #endif // KB_OPERATION_H
\ No newline at end of file
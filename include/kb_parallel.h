@@ -0,0 +1,22 @@
+#ifndef KB_PARALLEL_H
+#define KB_PARALLEL_H
+
+#include <cstddef>
+#include <functional>
+
+using namespace std;
+
+// Число потоков по умолчанию: std::thread::hardware_concurrency(), но не меньше 1
+size_t kbDefaultThreadCount();
+
+// Выполняет body(worker, begin, end) над диапазоном [0, count) в threadCount потоках
+// (0 - kbDefaultThreadCount()); вызывающий поток работает как поток 0.
+// Диапазон делится между потоками поровну, каждый забирает из своей части порции по grain
+// элементов. Поток, исчерпавший свою часть, забирает порции из частей других потоков
+// (work stealing), поэтому неравная стоимость элементов не приводит к простою.
+// Порции выделяются атомарным сдвигом счетчика, без блокировок. Первое исключение из body
+// останавливает раздачу порций и пробрасывается вызывающему после завершения всех потоков.
+void kbParallelFor(size_t count, size_t threadCount, size_t grain,
+                   const function<void(size_t worker, size_t begin, size_t end)> &body);
+
+#endif // KB_PARALLEL_H
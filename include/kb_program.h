@@ -0,0 +1,143 @@
+#ifndef KB_PROGRAM_H
+#define KB_PROGRAM_H
+
+#include "kb_value.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <map>
+
+using namespace std;
+
+class KBReference;
+class KBOperation;
+class KBSlotLayout;
+
+// Результат вычисления выражения
+struct KBEvalValue
+{
+    enum Kind : uint8_t
+    {
+        UNDEFINED,
+        NUMBER,
+        BOOLEAN,
+        SYMBOL
+    };
+
+    Kind kind = UNDEFINED;
+    union
+    {
+        double number;
+        bool boolean;
+        uint32_t symbol;
+    };
+    KBNonFactorValue nonFactor;
+
+    KBEvalValue() : number(0.0) {}
+
+    static KBEvalValue undefined(const KBNonFactorValue &nonFactor = {});
+    static KBEvalValue fromNumber(double value, const KBNonFactorValue &nonFactor = {});
+    static KBEvalValue fromBoolean(bool value, const KBNonFactorValue &nonFactor = {});
+    static KBEvalValue fromSymbol(uint32_t symbol, const KBNonFactorValue &nonFactor = {});
+
+    bool isDefined() const { return kind != UNDEFINED; }
+    // Истинность значения: 1 - истина, 0 - ложь, -1 - не определено
+    int getTruth() const;
+    // Совпадение вида, значения и коэффициента уверенности
+    bool operator==(const KBEvalValue &other) const;
+    bool operator!=(const KBEvalValue &other) const { return !(*this == other); }
+};
+
+enum class KBOpCode : uint8_t
+{
+    PUSH_CONST, // arg: индекс константы
+    LOAD_REF,   // arg: индекс ссылки (слота) либо слот раскладки рабочей памяти
+    WITH,       // arg: индекс коэффициента уверенности узла
+    EQ,
+    GT,
+    GE,
+    LT,
+    LE,
+    NE,
+    AND,
+    OR,
+    NOT,
+    XOR,
+    NEG,
+    ADD,
+    SUB,
+    MUL,
+    DIV,
+    MOD,
+    POW
+};
+
+struct KBInstruction
+{
+    KBOpCode code;
+    uint32_t arg;
+};
+
+// Линейное представление дерева Evaluatable для стековой машины
+class KBProgram
+{
+private:
+    vector<KBInstruction> code;
+    vector<KBEvalValue> constants;
+    vector<KBNonFactorValue> nonFactors;
+    vector<string> references;
+    const KBSlotLayout *layout = nullptr;
+    size_t maxStack = 0;
+
+    uint32_t addReference(const string &path);
+    uint32_t addReference(const KBReference *ref);
+    void emit(const Evaluatable *node, size_t depth);
+
+public:
+    static KBProgram compile(const Evaluatable *root);
+    // Ссылки компилируются в слоты раскладки: программа выполняется прямо над рабочей памятью
+    // KBSlotLayout::bind(), каждая ссылка - одна индексированная загрузка. Неразрешимая ссылка -
+    // invalid_argument. Слоты ссылок, уже привязанных bindReferences() по той же версии схемы,
+    // берутся из ссылок без повторного разрешения. Раскладка должна пережить программу.
+    static KBProgram compile(const Evaluatable *root, const KBSlotLayout &layout);
+
+    const vector<KBInstruction> &getCode() const { return code; }
+    const vector<KBEvalValue> &getConstants() const { return constants; }
+    const vector<KBNonFactorValue> &getNonFactors() const { return nonFactors; }
+    // Пути ссылок программы; у программы с раскладкой - только для справки, слоты задает раскладка
+    const vector<string> &getReferences() const { return references; }
+    const KBSlotLayout *getLayout() const { return layout; }
+    // Размер массива слотов, ожидаемого run()
+    size_t getSlotCount() const;
+    size_t getMaxStack() const { return maxStack; }
+
+    // Символьные значения кодируются дескрипторами глобальной таблицы KBSymbol
+    static uint32_t internSymbol(const string &value) { return KBSymbol(value).getId(); }
+    static const string &getSymbolName(uint32_t symbol) { return KBSymbolTable::lookup(symbol); }
+    static KBEvalValue symbol(const string &value, const KBNonFactorValue &nonFactor = {}) { return KBEvalValue::fromSymbol(internSymbol(value), nonFactor); }
+
+    // Раскладывает факты по слотам программы (или раскладки); отсутствующие ссылки остаются неопределенными
+    vector<KBEvalValue> bind(const map<string, KBEvalValue> &facts) const;
+
+    static string referencePath(const KBReference *ref);
+    // Значение литерала; литерал без явной уверенности считается достоверным
+    static KBEvalValue constant(const KBValue *value);
+    static KBOpCode opCode(const KBOperation *op);
+};
+
+// Стековая машина, выполняющая KBProgram
+class KBVirtualMachine
+{
+private:
+    vector<KBEvalValue> stack;
+
+public:
+    KBEvalValue run(const KBProgram &program, const KBEvalValue *slots);
+    KBEvalValue run(const KBProgram &program, const vector<KBEvalValue> &slots) { return run(program, slots.data()); }
+};
+
+KBEvalValue evalUnary(KBOpCode code, const KBEvalValue &operand);
+KBEvalValue evalBinary(KBOpCode code, const KBEvalValue &left, const KBEvalValue &right);
+KBNonFactorValue applyNonFactor(const KBNonFactorValue &value, const KBNonFactorValue &with);
+
+#endif // KB_PROGRAM_H
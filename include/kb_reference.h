@@ -8,32 +8,54 @@
 #include <json/json.h>
 #include <string>
 #include <vector>
+#include <cstdint>
 
 using namespace std;
 
 class KBReference : public Evaluatable {
 private:
-    string id;
+    KBSymbol id;
     KBReference* ref;
+    // Слот рабочей памяти, найденный KBSlotLayout::bindReferences(); кэш, не часть значения ссылки.
+    // Действителен только для базы и версии схемы, по которым он найден.
+    mutable uint32_t slot = NO_SLOT;
+    mutable const KnowledgeBase* slotBase = nullptr;
+    mutable uint64_t slotVersion = 0;
 
 public:
-    KBReference(const string& id, KBReference* ref = nullptr, NonFactor* non_factor = nullptr);
+    static constexpr uint32_t NO_SLOT = UINT32_MAX;
+
+    KBReference(KBSymbol id, KBReference* ref = nullptr, NonFactor* non_factor = nullptr);
     ~KBReference();
 
-    string getId() const { return id; }
-    void setId(const string& id) { this->id = id; }
+    const string& getId() const { return id.str(); }
+    KBSymbol getIdSymbol() const { return id; }
+    void setId(KBSymbol id) { this->id = id; bindSlot(NO_SLOT, nullptr, 0); }
 
     const KBReference* getRef() const { return ref; }
-    void setRef(KBReference* ref) { this->ref = ref; }
-
-    map<string, string> getAttrs() const override;
+    void setRef(KBReference* ref) { this->ref = ref; bindSlot(NO_SLOT, nullptr, 0); }
+
+    // Слот, привязанный для базы kb с версией схемы version, либо NO_SLOT
+    uint32_t getSlot(const KnowledgeBase* kb, uint64_t version) const {
+        return kb == slotBase && version == slotVersion ? slot : NO_SLOT;
+    }
+    void bindSlot(uint32_t slot, const KnowledgeBase* kb, uint64_t version) const {
+        this->slot = slot;
+        slotBase = kb;
+        slotVersion = version;
+    }
+
+    void collectAttrs(KBAttrList& attrs) const override;
     vector<xmlNodePtr> getInnerXML() const override;
+    void writeInnerXML(KBXMLWriter& writer) const override;
     Json::Value toJSON() const override;
+    void writeJSON(KBJSONWriter& writer) const override;
 
     static KBReference* fromXML(xmlNodePtr node);
     static KBReference* fromJSON(const Json::Value& json);
 
-    string getInnerKRL() const override;
+    void writeInnerKRL(string& out) const override;
+    void collectDiagnostics(const KnowledgeBase& kb, vector<KBDiagnostic>& diagnostics) const override;
 };
 
 #endif // KB_REFERENCE_H
@@ -0,0 +1,117 @@
+#ifndef KB_RETE_H
+#define KB_RETE_H
+
+#include "knowledge_base.h"
+#include "kb_program.h"
+#include <cstdint>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Прямой логический вывод по сети в духе Rete. Условия правил компилируются в общую сеть:
+// альфа-узел - максимальное подвыражение, читающее один атрибут (Насос.давление > 10),
+// бета-узел - операция над результатами узлов разных атрибутов (and/or/xor, сравнение атрибутов).
+// Одинаковые подвыражения разных правил - один узел сети. Изменение факта пересчитывает альфа-узлы
+// его слота и распространяется к наследникам лишь при изменении результата, поэтому стоимость цикла
+// зависит от числа изменившихся фактов, а не от числа правил.
+//
+// Правило активируется при переходе условия в истину (ветка ТО) либо в ложь (ветка ИНАЧЕ);
+// активации выполняются в порядке правил базы, каждый переход дает не более одного срабатывания.
+class KBReteEngine
+{
+private:
+    enum NodeKind : uint8_t
+    {
+        CONSTANT,
+        ALPHA,
+        BETA
+    };
+
+    struct Node
+    {
+        KBEvalValue value;
+        KBNonFactorValue with;
+        uint32_t left;
+        uint32_t right;
+        // Альфа-узел: слот атрибута и программа подвыражения
+        uint32_t slot;
+        uint32_t program;
+        KBOpCode code;
+        NodeKind kind;
+        bool hasWith;
+        bool queued;
+        vector<uint32_t> successors;
+        // Правила, условием которых является узел
+        vector<uint32_t> rules;
+    };
+
+    enum RuleState : uint8_t
+    {
+        UNKNOWN,
+        MATCHED,
+        FAILED
+    };
+
+    struct Action
+    {
+        uint32_t slot;
+        uint32_t program;
+    };
+
+    const KnowledgeBase &kb;
+    const KBSlotLayout &layout;
+    uint64_t schemaVersion;
+    vector<KBEvalValue> memory;
+    vector<Node> nodes;
+    vector<KBProgram> programs;
+    vector<vector<uint32_t>> slotAlphas;
+    vector<uint32_t> conditions;
+    vector<RuleState> ruleStates;
+    vector<vector<Action>> thenActions;
+    vector<vector<Action>> elseActions;
+    // Активация: rule * 2 для ветки ТО, rule * 2 + 1 для ветки ИНАЧЕ; упорядочена по номеру правила
+    std::set<uint32_t> agenda;
+    vector<uint32_t> queue;
+    vector<uint32_t> fired;
+    KBVirtualMachine vm;
+    size_t evaluated = 0;
+
+    uint32_t build(const Evaluatable *node, map<string, uint32_t> &shared);
+    uint32_t addProgram(const Evaluatable *node);
+    vector<Action> compileActions(const vector<KBAssign *> &instructions);
+    bool evaluate(uint32_t node);
+    void enqueue(uint32_t node);
+    void propagate();
+    void updateRule(uint32_t rule);
+    void write(uint32_t slot, const KBEvalValue &value);
+    void checkCurrent() const;
+
+public:
+    explicit KBReteEngine(KnowledgeBase &kb);
+
+    const KBSlotLayout &getLayout() const { return layout; }
+    const vector<KBEvalValue> &getMemory() const { return memory; }
+    const KBEvalValue &get(const string &path) const;
+
+    size_t getNodeCount() const { return nodes.size(); }
+    size_t getAlphaCount() const;
+    size_t getBetaCount() const;
+    // Число вычислений узлов с момента создания
+    size_t getEvaluatedCount() const { return evaluated; }
+
+    // Утверждает факт и распространяет изменение по сети; false, если значение не изменилось
+    bool set(uint32_t slot, const KBEvalValue &value);
+    bool set(const string &path, const KBEvalValue &value);
+
+    // Правила с активацией, ожидающей выполнения
+    size_t getAgendaSize() const { return agenda.size(); }
+    // Выполняет активации, пока они есть (не более maxFirings); возвращает число срабатываний
+    size_t run(size_t maxFirings = SIZE_MAX);
+    // Номера сработавших правил в порядке срабатывания
+    const vector<uint32_t> &getFired() const { return fired; }
+};
+
+#endif // KB_RETE_H
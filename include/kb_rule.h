@@ -0,0 +1,77 @@
+#ifndef KB_RULE_H
+#define KB_RULE_H
+
+#include "kb_entity.h"
+#include "kb_value.h"
+#include "kb_reference.h"
+#include <libxml/tree.h>
+#include <json/json.h>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Действие правила: присваивание атрибуту значения выражения (ОБЪЕКТ.АТРИБУТ = выражение)
+class KBAssign : public KBEntity
+{
+private:
+    KBReference *ref;
+    Evaluatable *value;
+
+public:
+    // Принимает владение ссылкой и выражением
+    KBAssign(KBReference *ref, Evaluatable *value);
+    ~KBAssign();
+
+    KBAssign(const KBAssign &) = delete;
+    KBAssign &operator=(const KBAssign &) = delete;
+
+    const KBReference *getRef() const { return ref; }
+    const Evaluatable *getValue() const { return value; }
+
+    vector<xmlNodePtr> getInnerXML() const override;
+    void writeInnerXML(KBXMLWriter &writer) const override;
+    Json::Value toJSON() const override;
+    void writeJSON(KBJSONWriter &writer) const override;
+    void writeKRL(string &out) const override;
+    void collectDiagnostics(const KnowledgeBase &kb, vector<KBDiagnostic> &diagnostics) const override;
+
+    static KBAssign *fromXML(xmlNodePtr node);
+    static KBAssign *fromJSON(const Json::Value &json);
+};
+
+// Продукционное правило: ЕСЛИ условие ТО действия ИНАЧЕ действия
+class KBRule : public KBIdentity
+{
+private:
+    Evaluatable *condition;
+    vector<KBAssign *> instructions;
+    vector<KBAssign *> elseInstructions;
+
+public:
+    // Принимает владение условием и действиями
+    KBRule(KBSymbol id, Evaluatable *condition, const vector<KBAssign *> &instructions,
+           const vector<KBAssign *> &elseInstructions = {}, const char *desc = nullptr);
+    ~KBRule();
+
+    KBRule(const KBRule &) = delete;
+    KBRule &operator=(const KBRule &) = delete;
+
+    string getMeta() const { return "simple"; }
+    const Evaluatable *getCondition() const { return condition; }
+    const vector<KBAssign *> &getInstructions() const { return instructions; }
+    const vector<KBAssign *> &getElseInstructions() const { return elseInstructions; }
+
+    void collectAttrs(KBAttrList &attrs) const override;
+    vector<xmlNodePtr> getInnerXML() const override;
+    void writeInnerXML(KBXMLWriter &writer) const override;
+    Json::Value toJSON() const override;
+    void writeJSON(KBJSONWriter &writer) const override;
+    void writeKRL(string &out) const override;
+    void collectDiagnostics(const KnowledgeBase &kb, vector<KBDiagnostic> &diagnostics) const override;
+
+    static KBRule *fromXML(xmlNodePtr node);
+    static KBRule *fromJSON(const Json::Value &json);
+};
+
+#endif // KB_RULE_H
@@ -0,0 +1,69 @@
+#ifndef KB_SLOT_LAYOUT_H
+#define KB_SLOT_LAYOUT_H
+
+#include "kb_program.h"
+#include "kb_symbol.h"
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <map>
+
+using namespace std;
+
+class KnowledgeBase;
+class KBReference;
+class KBRule;
+
+// Раскладка рабочей памяти базы знаний: каждому атрибуту объекта соответствует один слот,
+// слоты объекта идут подряд (slot = objectBase[объект] + номер атрибута). Раскладка строится
+// по схеме базы один раз и устаревает при любом изменении схемы (см. KnowledgeBase::getSchemaVersion()).
+// Раскладка не владеет базой и не должна ее переживать.
+class KBSlotLayout
+{
+private:
+    const KnowledgeBase *kb = nullptr;
+    uint64_t schemaVersion = 0;
+    vector<uint32_t> objectBase;
+    vector<string> paths;
+
+    void checkCurrent() const;
+
+public:
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    KBSlotLayout() = default;
+    explicit KBSlotLayout(const KnowledgeBase &kb) { rebuild(kb); }
+
+    void rebuild(const KnowledgeBase &kb);
+
+    // Раскладка построена по текущей версии схемы базы
+    bool isCurrent() const;
+    uint64_t getSchemaVersion() const { return schemaVersion; }
+    size_t getSlotCount() const { return paths.size(); }
+    // Путь ОБЪЕКТ.АТРИБУТ слота
+    const string &getSlotPath(uint32_t slot) const { return paths.at(slot); }
+
+    // Слот атрибута либо NONE
+    uint32_t slot(KBSymbol object, KBSymbol property) const;
+    // Слот по пути ОБЪЕКТ.АТРИБУТ либо NONE
+    uint32_t slot(string_view path) const;
+    // Слот ссылки вида ОБЪЕКТ.АТРИБУТ либо NONE. Слот, привязанный bindReferences() раскладки
+    // той же базы и версии схемы, берется из ссылки; привязка к другой версии схемы не используется.
+    uint32_t resolve(const KBReference *ref) const;
+
+    // Слот ссылки по resolve(); неразрешимая ссылка - invalid_argument
+    uint32_t require(const KBReference *ref) const;
+    // Добавляет в slots (без повторов) слоты всех ссылок выражения
+    void collectSlots(const Evaluatable *root, vector<uint32_t> &slots) const;
+
+    // Запоминает слоты во всех ссылках выражения или правила;
+    // возвращает количество ссылок, которые не удалось разрешить
+    size_t bindReferences(const Evaluatable *root) const;
+    size_t bindReferences(const KBRule *rule) const;
+
+    // Рабочая память: по значению на каждый слот, отсутствующие факты остаются неопределенными
+    vector<KBEvalValue> bind(const map<string, KBEvalValue> &facts) const;
+};
+
+#endif // KB_SLOT_LAYOUT_H
@@ -0,0 +1,204 @@
+#ifndef KB_SNAPSHOT_H
+#define KB_SNAPSHOT_H
+
+#include "kb_type.h"
+#include "kb_value.h"
+#include "kb_operation.h"
+#include "kb_reference.h"
+#include "membership_function.h"
+#include "non_factor.h"
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+// Двоичный снимок базы знаний. Все данные лежат в плоских массивах (секциях), ссылки между
+// записями - индексы, поэтому файл не зависит от адреса загрузки и читается через mmap без разбора.
+// Порядок байтов и выравнивание - родные для платформы; несовместимый файл отвергается при открытии.
+
+static constexpr uint32_t KB_SNAPSHOT_VERSION = 1;
+static constexpr uint32_t KB_SNAPSHOT_NONE = UINT32_MAX;
+
+enum class KBSnapshotSection : uint32_t
+{
+    STRINGS,     // строки UTF-8, завершенные нулем
+    SYMBOLS,     // uint32_t - смещение строки; индекс 0 - пустая строка
+    TYPES,       // KBSnapshotType
+    VALUES,      // uint32_t - символы значений символьных типов
+    MFS,         // KBSnapshotMF
+    POINTS,      // KBSnapshotPoint
+    NON_FACTORS, // KBSnapshotNonFactor
+    NODES,       // KBSnapshotNode
+    EXPRESSIONS, // uint32_t - корневые узлы выражений
+    COUNT
+};
+
+struct KBSnapshotSectionInfo
+{
+    uint64_t offset;
+    uint64_t count;
+};
+
+struct KBSnapshotHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint64_t fileSize;
+    KBSnapshotSectionInfo sections[static_cast<size_t>(KBSnapshotSection::COUNT)];
+};
+
+enum class KBSnapshotTypeKind : uint8_t
+{
+    ABSTRACT,
+    NUMERIC,
+    SYMBOLIC,
+    FUZZY
+};
+
+struct KBSnapshotType
+{
+    uint32_t id;
+    uint32_t desc; // KB_SNAPSHOT_NONE - без описания
+    KBSnapshotTypeKind kind;
+    uint8_t reserved[3];
+    // Диапазон в VALUES (символьный тип) или в MFS (нечеткий тип)
+    uint32_t first;
+    uint32_t count;
+    uint32_t reserved2;
+    double from;
+    double to;
+};
+
+struct KBSnapshotMF
+{
+    uint32_t name;
+    uint32_t firstPoint;
+    uint32_t pointCount;
+    uint32_t reserved;
+    double min;
+    double max;
+};
+
+struct KBSnapshotPoint
+{
+    double x;
+    double y;
+};
+
+struct KBSnapshotNonFactor
+{
+    double belief;
+    double probability;
+    double accuracy;
+};
+
+enum class KBSnapshotNodeKind : uint8_t
+{
+    NUMBER,
+    SYMBOL,
+    BOOLEAN,
+    REFERENCE,
+    OPERATION
+};
+
+// Узел выражения. SYMBOL: left - символ; BOOLEAN: left - 0/1; REFERENCE: left - символ,
+// right - следующее звено пути; OPERATION: op, left и right - узлы операндов.
+struct KBSnapshotNode
+{
+    KBSnapshotNodeKind kind;
+    KBOperator op;
+    uint8_t convertNonFactor;
+    uint8_t reserved;
+    uint32_t nonFactor; // KB_SNAPSHOT_NONE - коэффициент по умолчанию
+    uint32_t left;
+    uint32_t right;
+    double number;
+};
+
+static_assert(sizeof(KBSnapshotType) == 40, "Snapshot layout changed");
+static_assert(sizeof(KBSnapshotMF) == 32, "Snapshot layout changed");
+static_assert(sizeof(KBSnapshotNode) == 24, "Snapshot layout changed");
+
+// Построение снимка из сущностей
+class KBSnapshotWriter
+{
+private:
+    string strings;
+    vector<uint32_t> symbols;
+    unordered_map<string, uint32_t> symbolIndex;
+    vector<KBSnapshotType> types;
+    vector<uint32_t> values;
+    vector<KBSnapshotMF> mfs;
+    vector<KBSnapshotPoint> points;
+    vector<KBSnapshotNonFactor> nonFactors;
+    vector<KBSnapshotNode> nodes;
+    vector<uint32_t> expressions;
+
+    uint32_t symbol(const string &value);
+    uint32_t addNode(const Evaluatable *node);
+
+public:
+    KBSnapshotWriter();
+
+    void addType(const KBType *type);
+    void addExpression(const Evaluatable *expression);
+
+    string serialize() const;
+    void writeToFile(const string &path) const;
+};
+
+// Снимок, открытый только для чтения. Массивы доступны напрямую из отображенного файла,
+// сущности создаются по требованию методами materialize*.
+class KBSnapshot
+{
+private:
+    string buffer;
+    void *mapped = nullptr;
+    size_t mappedSize = 0;
+    const char *data = nullptr;
+    size_t size = 0;
+    const KBSnapshotHeader *header = nullptr;
+    // Символы снимка в глобальной таблице; заполняется в open()
+    vector<KBSymbol> symbolCache;
+
+    void open(const char *data, size_t size);
+    template <typename T>
+    const T *section(KBSnapshotSection id) const
+    {
+        return reinterpret_cast<const T *>(data + header->sections[static_cast<size_t>(id)].offset);
+    }
+    const KBSnapshotNode &node(uint32_t index) const;
+    Evaluatable *materializeNode(uint32_t index) const;
+
+    KBSnapshot() = default;
+
+public:
+    explicit KBSnapshot(const string &data);
+    ~KBSnapshot();
+
+    KBSnapshot(const KBSnapshot &) = delete;
+    KBSnapshot &operator=(const KBSnapshot &) = delete;
+
+    static KBSnapshot *fromFile(const string &path);
+
+    size_t getCount(KBSnapshotSection id) const { return header->sections[static_cast<size_t>(id)].count; }
+    string_view getString(uint32_t symbol) const;
+    KBSymbol getSymbol(uint32_t symbol) const;
+
+    const KBSnapshotType *getTypes() const { return section<KBSnapshotType>(KBSnapshotSection::TYPES); }
+    const KBSnapshotMF *getMembershipFunctions() const { return section<KBSnapshotMF>(KBSnapshotSection::MFS); }
+    const KBSnapshotPoint *getPoints() const { return section<KBSnapshotPoint>(KBSnapshotSection::POINTS); }
+    const KBSnapshotNode *getNodes() const { return section<KBSnapshotNode>(KBSnapshotSection::NODES); }
+    size_t getTypeCount() const { return getCount(KBSnapshotSection::TYPES); }
+    size_t getExpressionCount() const { return getCount(KBSnapshotSection::EXPRESSIONS); }
+
+    KBType *materializeType(size_t index) const;
+    vector<KBType *> materializeTypes() const;
+    Evaluatable *materializeExpression(size_t index) const;
+};
+
+#endif // KB_SNAPSHOT_H
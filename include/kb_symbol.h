@@ -0,0 +1,64 @@
+#ifndef KB_SYMBOL_H
+#define KB_SYMBOL_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <functional>
+#include <ostream>
+
+using namespace std;
+
+// Интернированная строка: 32-битный дескриптор в глобальной таблице символов.
+// Сравнение и хеширование выполняются по дескриптору за O(1).
+class KBSymbol
+{
+private:
+    uint32_t id;
+
+    explicit KBSymbol(uint32_t id, bool) : id(id) {}
+
+public:
+    // Пустая строка всегда имеет дескриптор 0
+    KBSymbol() : id(0) {}
+    KBSymbol(string_view value);
+    KBSymbol(const string &value) : KBSymbol(string_view(value)) {}
+    KBSymbol(const char *value) : KBSymbol(value != nullptr ? string_view(value) : string_view()) {}
+
+    static KBSymbol fromId(uint32_t id);
+
+    uint32_t getId() const { return id; }
+    const string &str() const;
+    const char *c_str() const { return str().c_str(); }
+    bool empty() const { return id == 0; }
+
+    bool operator==(const KBSymbol &other) const { return id == other.id; }
+    bool operator!=(const KBSymbol &other) const { return id != other.id; }
+    bool operator<(const KBSymbol &other) const { return id < other.id; }
+};
+
+inline ostream &operator<<(ostream &os, const KBSymbol &symbol)
+{
+    return os << symbol.str();
+}
+
+// Глобальная таблица символов. Добавление синхронизировано, чтение строки по дескриптору - без блокировок.
+class KBSymbolTable
+{
+public:
+    static uint32_t intern(string_view value);
+    static const string &lookup(uint32_t id);
+    static bool contains(uint32_t id);
+    static size_t size();
+};
+
+namespace std
+{
+    template <>
+    struct hash<KBSymbol>
+    {
+        size_t operator()(const KBSymbol &symbol) const noexcept { return symbol.getId(); }
+    };
+}
+
+#endif // KB_SYMBOL_H
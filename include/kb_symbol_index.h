@@ -0,0 +1,126 @@
+#ifndef KB_SYMBOL_INDEX_H
+#define KB_SYMBOL_INDEX_H
+
+#include "kb_symbol.h"
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+// Хеш-индекс KBSymbol -> uint32_t с открытой адресацией и линейным пробированием.
+// Ключ и значение лежат рядом в одном массиве; пустая ячейка - символ 0 (пустая строка),
+// поэтому пустая строка ключом быть не может. Заполненность не превышает 1/2.
+class KBSymbolIndex
+{
+private:
+    struct Slot
+    {
+        uint32_t key;
+        uint32_t value;
+    };
+
+    vector<Slot> slots;
+    size_t count = 0;
+    unsigned shift = 32;
+
+    // Мультипликативное хеширование: дескрипторы символов идут подряд, поэтому младшие
+    // биты перемешиваются умножением на 2^32 / phi
+    size_t position(uint32_t key) const { return (uint32_t)(key * 2654435769u) >> shift; }
+
+    void rehash(size_t capacity)
+    {
+        vector<Slot> old;
+        old.swap(slots);
+        slots.assign(capacity, Slot{0, 0});
+        shift = 32;
+        for (size_t c = capacity; c > 1; c >>= 1)
+        {
+            --shift;
+        }
+        for (const Slot &slot : old)
+        {
+            if (slot.key != 0)
+            {
+                size_t i = position(slot.key);
+                while (slots[i].key != 0)
+                {
+                    i = (i + 1) & (slots.size() - 1);
+                }
+                slots[i] = slot;
+            }
+        }
+    }
+
+public:
+    static constexpr uint32_t NOT_FOUND = UINT32_MAX;
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    void clear()
+    {
+        slots.clear();
+        count = 0;
+        shift = 32;
+    }
+
+    void reserve(size_t size)
+    {
+        size_t capacity = 16;
+        while (capacity < size * 2)
+        {
+            capacity <<= 1;
+        }
+        if (capacity > slots.size())
+        {
+            rehash(capacity);
+        }
+    }
+
+    // Добавляет ключ; false, если ключ уже есть (значение не меняется)
+    bool insert(KBSymbol key, uint32_t value)
+    {
+        if (key.empty())
+        {
+            return false;
+        }
+        if ((count + 1) * 2 > slots.size())
+        {
+            rehash(slots.empty() ? 16 : slots.size() * 2);
+        }
+        size_t i = position(key.getId());
+        while (slots[i].key != 0)
+        {
+            if (slots[i].key == key.getId())
+            {
+                return false;
+            }
+            i = (i + 1) & (slots.size() - 1);
+        }
+        slots[i] = Slot{key.getId(), value};
+        ++count;
+        return true;
+    }
+
+    uint32_t find(KBSymbol key) const
+    {
+        if (slots.empty())
+        {
+            return NOT_FOUND;
+        }
+        size_t i = position(key.getId());
+        while (slots[i].key != 0)
+        {
+            if (slots[i].key == key.getId())
+            {
+                return slots[i].value;
+            }
+            i = (i + 1) & (slots.size() - 1);
+        }
+        return NOT_FOUND;
+    }
+
+    bool contains(KBSymbol key) const { return find(key) != NOT_FOUND; }
+};
+
+#endif // KB_SYMBOL_INDEX_H
@@ -14,18 +14,22 @@ using namespace std;
 class KBType : public KBIdentity
 {
 public:
-    KBType(const string id, const char *desc = nullptr);
+    KBType(KBSymbol id, const char *desc = nullptr);
     virtual string getMeta() const { return "abstract"; }
     virtual string getKRLType() const { return "АБСТРАКТНЫЙ"; }
-    virtual string getInnerKRL() const { return ""; }
-    virtual map<string, string> getAttrs() const override;
+    string getInnerKRL() const;
+    virtual void writeInnerKRL(string &) const { }
+    virtual void collectAttrs(KBAttrList &attrs) const override;
     virtual vector<xmlNodePtr> getInnerXML() const override { return {}; }
     virtual Json::Value toJSON() const override { return KBEntity::toJSON(); };
-    virtual string KRL() const override;
+    virtual void writeKRL(string &out) const override;
     virtual string getXMLOwnerPath() const override;
+    // Допустимо ли значение с таким текстовым представлением для типа
+    virtual bool validateValue(const string &) const { return true; }
 
     static KBType *fromXML(xmlNodePtr node);
     static KBType *fromJSON(const Json::Value &json);
+    static KBType *fromKRL(const string &krl);
 };
 
 class KBNumericType : public KBType
@@ -35,17 +39,20 @@ private:
     double to;
 
 public:
-    KBNumericType(const string id, double from, double to, const char *desc = nullptr);
+    KBNumericType(KBSymbol id, double from, double to, const char *desc = nullptr);
     string getMeta() const override { return "number"; }
     string getKRLType() const override { return "ЧИСЛО"; }
-    string getInnerKRL() const override;
+    void writeInnerKRL(string &out) const override;
     double getFrom() const { return from; };
     double getTo() const { return to; };
-    map<string, string> getAttrs() const override;
+    void collectAttrs(KBAttrList &attrs) const override;
     vector<xmlNodePtr> getInnerXML() const override;
+    void writeInnerXML(KBXMLWriter &writer) const override;
     Json::Value toJSON() const override;
+    void writeJSON(KBJSONWriter &writer) const override;
 
-    bool validateValue(const string &value) const;
+    bool validateValue(const string &value) const override;
+    void collectDiagnostics(const KnowledgeBase &kb, vector<KBDiagnostic> &diagnostics) const override;
 
     static KBNumericType *fromXML(xmlNodePtr node);
     static KBNumericType *fromJSON(const Json::Value &json);
@@ -54,27 +61,32 @@ public:
 class KBSymbolicType : public KBType
 {
 private:
-    vector<string> values;
+    vector<KBSymbol> values;
 
 public:
-    KBSymbolicType(const string id, const vector<string> &values, const char *desc = nullptr);
+    KBSymbolicType(KBSymbol id, const vector<string> &values, const char *desc = nullptr);
     string getMeta() const override { return "string"; }
     string getKRLType() const override { return "СИМВОЛ"; }
-    string getInnerKRL() const override;
+    void writeInnerKRL(string &out) const override;
     vector<string> getValues() const
     {
         vector<string> vs = {};
-        for (string s : values)
+        for (KBSymbol s : values)
         {
-            vs.push_back(s);
+            vs.push_back(s.str());
         }
         return vs;
     };
-    map<string, string> getAttrs() const override;
+    const vector<KBSymbol> &getValueSymbols() const { return values; };
+    bool hasValue(KBSymbol value) const;
+    void collectAttrs(KBAttrList &attrs) const override;
     vector<xmlNodePtr> getInnerXML() const override;
+    void writeInnerXML(KBXMLWriter &writer) const override;
     Json::Value toJSON() const override;
+    void writeJSON(KBJSONWriter &writer) const override;
 
-    bool validateValue(const string &value) const;
+    bool validateValue(const string &value) const override;
+    void collectDiagnostics(const KnowledgeBase &kb, vector<KBDiagnostic> &diagnostics) const override;
 
     static KBSymbolicType *fromXML(xmlNodePtr node);
     static KBSymbolicType *fromJSON(const Json::Value &json);
@@ -86,23 +98,30 @@ private:
     vector<MembershipFunction *> membership_functions;
 
 public:
-    KBFuzzyType(const string id, const vector<MembershipFunction*> &membership_functions, const char *desc = nullptr);
+    KBFuzzyType(KBSymbol id, const vector<MembershipFunction*> &membership_functions, const char *desc = nullptr);
     string getMeta() const override { return "fuzzy"; }
     string getKRLType() const override { return "НЕЧЕТКИЙ"; }
-    string getInnerKRL() const;
+    void writeInnerKRL(string &out) const override;
     vector<MembershipFunction *> getMembershipFunctions() const
     {
         vector<MembershipFunction *> mfs = {};
         for (MembershipFunction *mf : membership_functions)
         {
-            MembershipFunction *new_mf = MembershipFunction::fromJSON(mf->toJSON());
-            mfs.push_back(new_mf);
+            mfs.push_back(new MembershipFunction(mf->name, mf->min, mf->max, mf->points));
         }
         return mfs;
     };
+    // Функции принадлежности без копирования; владельцем остается тип
+    const vector<MembershipFunction *> &getMembershipFunctionList() const { return membership_functions; };
     vector<xmlNodePtr> getInnerXML() const;
+    void writeInnerXML(KBXMLWriter &writer) const override;
     Json::Value toJSON() const;
+    void writeJSON(KBJSONWriter &writer) const override;
     ~KBFuzzyType() override;
+    void collectDiagnostics(const KnowledgeBase &kb, vector<KBDiagnostic> &diagnostics) const override;
+
+    static KBFuzzyType *fromXML(xmlNodePtr node);
+    static KBFuzzyType *fromJSON(const Json::Value &json);
 };
 
 #endif // KB_TYPE_H
\ No newline at end of file
@@ -0,0 +1,26 @@
+#ifndef KB_VALIDATOR_H
+#define KB_VALIDATOR_H
+
+#include "knowledge_base.h"
+#include <vector>
+
+using namespace std;
+
+// Параллельная проверка всей базы знаний. Типы, объекты и правила распределяются между
+// потоками (см. kbParallelFor); каждый поток пишет ошибки в свой буфер, буферы сливаются
+// после завершения в порядке сущностей базы, поэтому результат не зависит от числа потоков.
+// Проверенные без ошибок сущности отмечаются флагом validated.
+class KBValidator
+{
+private:
+    size_t threadCount;
+    size_t grain;
+
+public:
+    // threadCount = 0 - по числу ядер; grain - число сущностей, забираемых потоком за раз
+    explicit KBValidator(size_t threadCount = 0, size_t grain = 64);
+
+    vector<KBDiagnostic> validate(KnowledgeBase &kb) const;
+};
+
+#endif // KB_VALIDATOR_H
@@ -8,34 +8,43 @@
 #include <string>
 #include <vector>
 #include <stdexcept>
-#include <regex>
 #include "utils.h"
 
 using namespace std;
 
 class Evaluatable : public KBEntity {
 protected:
+    // nullptr - коэффициент по умолчанию, общий для всех узлов (NonFactor::getDefault())
     NonFactor* nonFactor;
     bool convertNonFactor;
 
+    bool hasNonFactorOutput() const { return nonFactor != nullptr || convertNonFactor; }
+
 public:
     Evaluatable(NonFactor* nonFactor = nullptr);
 
     bool getConvertNonFactor() const { return convertNonFactor; };
     void setConvertNonFactor(bool convertNonFactor) { this->convertNonFactor = convertNonFactor; };
     
-    NonFactor* getNonFactor() const { return nonFactor; };
-    void setNonFactor(NonFactor* nonFactor) { this->nonFactor = nonFactor->copy(); };
+    const NonFactor* getNonFactor() const { return nonFactor != nullptr ? nonFactor : NonFactor::getDefault(); };
+    KBNonFactorValue getNonFactorValue() const { return nonFactor != nullptr ? nonFactor->getValue() : KBNonFactorValue(); };
+    bool hasOwnNonFactor() const { return nonFactor != nullptr; };
+    // Копирует коэффициент; коэффициент по умолчанию не хранится
+    void setNonFactor(const NonFactor* nonFactor);
     virtual ~Evaluatable();
 
-    virtual map<string, string> getAttrs() const override;
+    virtual void collectAttrs(KBAttrList& attrs) const override;
     virtual xmlNodePtr toXML() const override;
+    virtual void writeXML(KBXMLWriter& writer) const override;
 
     static Evaluatable* fromXML(xmlNodePtr node);
     static Evaluatable* fromJSON(const Json::Value& json);
+    static Evaluatable* fromKRL(const string& krl);
 
-    virtual string getInnerKRL() const = 0;
-    virtual string KRL() const override;
+    string getInnerKRL() const;
+    virtual void writeInnerKRL(string& out) const = 0;
+    virtual void writeKRL(string& out) const override;
+    virtual void collectDiagnostics(const KnowledgeBase& kb, vector<KBDiagnostic>& diagnostics) const override;
 };
 
 class KBValue : public Evaluatable {
@@ -43,10 +52,17 @@ public:
     KBValue(NonFactor* nonFactor = nullptr);
 
     static KBValue* fromXML(xmlNodePtr node);
+    // Определяет тип значения по его текстовому представлению (True/False, число, символ)
+    static KBValue* fromString(const string& content, NonFactor* nonFactor = nullptr);
     static KBValue* fromJSON(const Json::Value& json);
 
     virtual KBValue* evaluate() = 0;
     virtual vector<xmlNodePtr> getInnerXML() const override = 0;
+    Json::Value toJSON() const override;
+    void writeJSON(KBJSONWriter& writer) const override;
+    // Атрибуты значения и ключ "content": строка, число или логическое значение
+    virtual Json::Value getJSONContent() const = 0;
+    virtual void writeJSONContent(KBJSONWriter& writer) const = 0;
     virtual string getContentAsString() const = 0;
     virtual void setContent(const string& value) = 0;
     virtual void setContent(double value) = 0;
@@ -58,17 +74,21 @@ public:
 
 class KBSymbolicValue : public KBValue {
 private:
-    string content;
+    KBSymbol content;
 
 public:
-    KBSymbolicValue(const string& content, NonFactor* nonFactor = nullptr);
+    KBSymbolicValue(KBSymbol content, NonFactor* nonFactor = nullptr);
 
-    string getInnerKRL() const override;
+    void writeInnerKRL(string& out) const override;
     vector<xmlNodePtr> getInnerXML() const override;
+    void writeInnerXML(KBXMLWriter& writer) const override;
+    Json::Value getJSONContent() const override;
+    void writeJSONContent(KBJSONWriter& writer) const override;
     KBValue* evaluate() override;
 
-    string getContentAsString() const override { return content; }
-    void setContent(const string& value) override { content = value; }
+    string getContentAsString() const override { return content.str(); }
+    KBSymbol getSymbol() const { return content; }
+    void setContent(const string& value) override { content = KBSymbol(value); }
     void setContent(double value) override { throw invalid_argument("Invalid type for KBSymbolicValue"); }
     void setContent(bool value) override { throw invalid_argument("Invalid type for KBSymbolicValue"); }
 };
@@ -80,15 +100,18 @@ private:
 public:
     KBNumericValue(double content, NonFactor* nonFactor = nullptr);
 
-    string getInnerKRL() const override;
+    void writeInnerKRL(string& out) const override;
     vector<xmlNodePtr> getInnerXML() const override;
+    void writeInnerXML(KBXMLWriter& writer) const override;
+    Json::Value getJSONContent() const override;
+    void writeJSONContent(KBJSONWriter& writer) const override;
     KBValue* evaluate() override;
 
     double getContent() const { 
         return content; 
     }
     string getContentAsString() const override { return doubleToString(content); }
-    void setContent(const string& value) override { content = stod(value); }
+    void setContent(const string& value) override { content = parseDouble(value); }
     void setContent(double value) override { content = value; }
     void setContent(bool value) override { throw invalid_argument("Invalid type for KBNumericValue"); }
 };
@@ -100,8 +123,11 @@ private:
 public:
     KBBooleanValue(bool content, NonFactor* nonFactor = nullptr);
 
-    string getInnerKRL() const override;
+    void writeInnerKRL(string& out) const override;
     vector<xmlNodePtr> getInnerXML() const override;
+    void writeInnerXML(KBXMLWriter& writer) const override;
+    Json::Value getJSONContent() const override;
+    void writeJSONContent(KBJSONWriter& writer) const override;
     KBValue* evaluate() override;
 
     bool getContent() const { return content; }
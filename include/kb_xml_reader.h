@@ -0,0 +1,76 @@
+#ifndef KB_XML_READER_H
+#define KB_XML_READER_H
+
+#include "kb_type.h"
+#include "kb_value.h"
+#include "kb_operation.h"
+#include "kb_reference.h"
+#include "non_factor.h"
+#include "membership_function.h"
+#include <libxml/xmlreader.h>
+#include <string>
+#include <functional>
+
+using namespace std;
+
+// Потоковое чтение XML на основе xmlTextReader: сущности строятся непосредственно
+// по событиям парсера, дерево документа (DOM) не создается, поэтому расход памяти
+// не зависит от размера файла.
+class KBXMLReader
+{
+private:
+    xmlTextReaderPtr reader = nullptr;
+    string buffer;
+    void *mapped = nullptr;
+    size_t mappedSize = 0;
+
+    void open(const char *data, size_t size, const char *url);
+    bool read();
+    int nodeType() const;
+    int depth() const;
+    bool isEmptyElement() const;
+    KBSymbol attribute(const char *name) const;
+    bool attribute(const char *name, string &value) const;
+    double numericAttribute(const char *name, double fallback) const;
+
+    // Обходит дочерние элементы текущего элемента. Обработчик вызывается на открывающем теге
+    // дочернего элемента и обязан прочитать его целиком; текст самого элемента накапливается в text.
+    void readChildren(const function<void(const string &name)> &onElement, string *text = nullptr);
+    void skipElement();
+    string readText();
+
+    KBType *readTypeBody(KBSymbol id, const string &meta, const string *desc);
+
+    KBXMLReader() = default;
+
+public:
+    explicit KBXMLReader(const string &xml);
+    ~KBXMLReader();
+
+    KBXMLReader(const KBXMLReader &) = delete;
+    KBXMLReader &operator=(const KBXMLReader &) = delete;
+
+    // Открывает файл через mmap; содержимое не копируется в память процесса
+    static KBXMLReader *fromFile(const string &path);
+
+    // Переходит к следующему открывающему тегу документа. false - конец документа
+    bool nextElement();
+    string getName() const;
+    int getDepth() const { return depth(); }
+
+    // Вызывает handler для каждого элемента с заданным именем; handler должен прочитать элемент
+    void forEachElement(const string &name, const function<void(KBXMLReader &)> &handler);
+
+    // Чтение сущностей. Текущим должен быть открывающий тег сущности;
+    // после возврата читатель стоит на ее закрывающем теге.
+    KBType *readType();
+    Evaluatable *readEvaluatable();
+    KBReference *readReference();
+    KBOperation *readOperation();
+    KBValue *readValue();
+    NonFactor *readNonFactor();
+    MembershipFunction *readMembershipFunction();
+    MFPoint *readPoint();
+};
+
+#endif // KB_XML_READER_H
@@ -0,0 +1,78 @@
+#ifndef KB_XML_WRITER_H
+#define KB_XML_WRITER_H
+
+#include <string>
+#include <string_view>
+#include <map>
+#include <vector>
+#include <utility>
+
+using namespace std;
+
+class KBEntity;
+
+// Небольшой список атрибутов сущности без выделения памяти под узлы.
+// Повторная установка атрибута заменяет значение, как и в map<string, string>.
+class KBAttrList
+{
+private:
+    static constexpr size_t CAPACITY = 8;
+    pair<const char *, string> items[CAPACITY];
+    size_t count = 0;
+
+public:
+    void set(const char *name, string value);
+    const string *get(const char *name) const;
+    size_t size() const { return count; }
+    const pair<const char *, string> *begin() const { return items; }
+    const pair<const char *, string> *end() const { return items + count; }
+
+    // Упорядочивает атрибуты по имени (как при обходе map)
+    void sort();
+    map<string, string> toMap() const;
+};
+
+// Потоковый сериализатор XML: пишет сущности в растущий буфер или в файловый дескриптор
+// за один проход по дереву, не создавая узлов xmlNode. Результат совпадает с выводом
+// libxml2 для документа в кодировке UTF-8.
+class KBXMLWriter
+{
+private:
+    string buffer;
+    int fd = -1;
+    size_t flushThreshold = 0;
+    vector<const char *> open;
+    bool startTagPending = false;
+
+    void closeStartTag();
+    void maybeFlush();
+    void escape(string_view value, bool attribute);
+
+public:
+    KBXMLWriter() = default;
+    // Запись в файловый дескриптор; буфер сбрасывается при превышении bufferSize байт
+    explicit KBXMLWriter(int fd, size_t bufferSize = 64 * 1024);
+    ~KBXMLWriter();
+
+    KBXMLWriter(const KBXMLWriter &) = delete;
+    KBXMLWriter &operator=(const KBXMLWriter &) = delete;
+
+    // Имя элемента должно оставаться действительным до вызова endElement
+    void startElement(const char *name);
+    void attribute(const char *name, string_view value);
+    void attributes(KBAttrList &attrs);
+    void text(string_view value);
+    void endElement();
+    // Элемент с текстовым содержимым
+    void textElement(const char *name, string_view value);
+
+    void declaration();
+    void write(const KBEntity &entity);
+    // XML-документ: объявление, корневая сущность и перевод строки
+    void document(const KBEntity &entity);
+
+    void flush();
+    const string &str() const { return buffer; }
+};
+
+#endif // KB_XML_WRITER_H
@@ -0,0 +1,101 @@
+#ifndef KNOWLEDGE_BASE_H
+#define KNOWLEDGE_BASE_H
+
+#include "kb_entity.h"
+#include "kb_arena.h"
+#include "kb_symbol_index.h"
+#include "kb_type.h"
+#include "kb_object.h"
+#include "kb_rule.h"
+#include "kb_slot_layout.h"
+#include "kb_dependency_index.h"
+#include <libxml/tree.h>
+#include <json/json.h>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// База знаний: владеет типами, объектами и правилами. Сущности каждого вида хранятся
+// в отдельном массиве в порядке добавления, поиск по идентификатору - через хеш-индексы
+// с открытой адресацией за O(1). fromXML/fromJSON размещают сущности в арене базы,
+// поэтому сущности одного раздела документа лежат в памяти подряд.
+class KnowledgeBase : public KBEntity
+{
+private:
+    KBArena arena;
+    vector<KBType *> types;
+    vector<KBObject *> objects;
+    vector<KBRule *> rules;
+    KBSymbolIndex typeIndex;
+    KBSymbolIndex objectIndex;
+    KBSymbolIndex ruleIndex;
+    uint64_t schemaVersion = 0;
+    KBSlotLayout layout;
+    size_t boundRules = 0;
+    KBDependencyIndex dependencies;
+
+    void deleteOwned(KBEntity *entity);
+
+public:
+    KnowledgeBase();
+    ~KnowledgeBase();
+
+    KnowledgeBase(const KnowledgeBase &) = delete;
+    KnowledgeBase &operator=(const KnowledgeBase &) = delete;
+
+    // Принимают владение сущностью; при повторном идентификаторе сущность удаляется
+    // и бросается invalid_argument
+    void addType(KBType *type);
+    void addObject(KBObject *object);
+    void addRule(KBRule *rule);
+
+    const vector<KBType *> &getTypes() const { return types; }
+    const vector<KBObject *> &getObjects() const { return objects; }
+    const vector<KBRule *> &getRules() const { return rules; }
+    size_t size() const { return types.size() + objects.size() + rules.size(); }
+
+    // Позиция сущности в соответствующем массиве либо KBSymbolIndex::NOT_FOUND
+    uint32_t getTypeIndex(KBSymbol id) const { return typeIndex.find(id); }
+    uint32_t getObjectIndex(KBSymbol id) const { return objectIndex.find(id); }
+    uint32_t getRuleIndex(KBSymbol id) const { return ruleIndex.find(id); }
+
+    KBType *getType(KBSymbol id) const;
+    KBObject *getObject(KBSymbol id) const;
+    KBRule *getRule(KBSymbol id) const;
+    // Атрибут объекта (ОБЪЕКТ.АТРИБУТ) либо nullptr
+    KBProperty *getProperty(KBSymbol object, KBSymbol property) const;
+    // Атрибут, на который указывает ссылка вида ОБЪЕКТ.АТРИБУТ, либо nullptr
+    KBProperty *getProperty(const KBReference *ref) const;
+    // Тип атрибута, на который указывает ссылка, либо nullptr
+    KBType *getReferenceType(const KBReference *ref) const;
+
+    KBArena &getArena() { return arena; }
+
+    // Версия схемы увеличивается при добавлении типа, объекта или атрибута объекта
+    uint64_t getSchemaVersion() const { return schemaVersion; }
+    void schemaChanged() { ++schemaVersion; }
+
+    // Раскладка слотов рабочей памяти с привязанными к ней ссылками всех правил.
+    // Раскладка и привязка всех правил перестраиваются только при изменении схемы,
+    // иначе привязываются лишь правила, добавленные после предыдущего вызова.
+    const KBSlotLayout &bindReferences();
+
+    // Обратный индекс атрибутов, пополняется в addRule()
+    const KBDependencyIndex &getDependencies() const { return dependencies; }
+    // Правила, условия которых нужно перепроверить после изменения атрибутов (пути ОБЪЕКТ.АТРИБУТ)
+    vector<KBRule *> getAffectedRules(const vector<KBSymbol> &paths) const;
+
+    vector<xmlNodePtr> getInnerXML() const override;
+    void writeInnerXML(KBXMLWriter &writer) const override;
+    Json::Value toJSON() const override;
+    void writeJSON(KBJSONWriter &writer) const override;
+    void writeKRL(string &out) const override;
+    // Последовательная проверка всех сущностей; параллельная - KBValidator
+    void collectDiagnostics(const KnowledgeBase &kb, vector<KBDiagnostic> &diagnostics) const override;
+
+    static KnowledgeBase *fromXML(xmlNodePtr node);
+    static KnowledgeBase *fromJSON(const Json::Value &json);
+};
+
+#endif // KNOWLEDGE_BASE_H
@@ -17,9 +17,10 @@ public:
 
     MFPoint(double x, double y);
 
-    map<string, string> getAttrs() const override;
-    string KRL() const override;
+    void collectAttrs(KBAttrList &attrs) const override;
+    void writeKRL(string& out) const override;
     Json::Value toJSON() const override;
+    void writeJSON(KBJSONWriter& writer) const override;
 
     static MFPoint* fromXML(const xmlNodePtr xml);
     static MFPoint* fromJSON(const Json::Value& json);
@@ -27,6 +28,22 @@ public:
 
 // Класс MembershipFunction
 class MembershipFunction : public KBEntity {
+private:
+    // Плоская копия points для evaluate(): абсциссы по возрастанию, ординаты и наклоны отрезков
+    // (наклон последней точки - 0). Точки с одинаковым x дают ступеньку, непрерывную справа.
+    vector<double> curveX;
+    vector<double> curveY;
+    vector<double> slopes;
+    // Таблица μ в lutResolution + 1 узлах равномерной сетки на [min, max]; пустая - режим выключен
+    vector<float> lut;
+    size_t lutResolution = 0;
+    double lutMaxError = 0.0;
+    double lutScale = 0.0;
+    double lutError = 0.0;
+
+    double evaluateTable(double x) const;
+    bool buildLookupTable();
+
 public:
     string name;
     double min;
@@ -35,14 +52,37 @@ public:
 
     MembershipFunction(const string& name, double min, double max, const vector<MFPoint*>& points);
 
-    map<string, string> getAttrs() const override;
+    // Перестраивает плоскую копию кривой; вызывается после изменения points
+    void updateCurve();
+    // Степень принадлежности μ(x): линейная интерполяция между точками, левее первой и правее
+    // последней точки - ордината крайней точки, без точек - 0. Не выделяет память.
+    // В режиме таблицы значения внутри [min, max] берутся из таблицы.
+    double evaluate(double x) const { return lut.empty() ? evaluateExact(x) : evaluateTable(x); }
+    double evaluateExact(double x) const;
+
+    // Режим таблицы: μ на равномерной сетке из resolution отрезков и интерполяция между узлами.
+    // Если отклонение от точной кривой больше maxError (а также при пустом диапазоне или без точек),
+    // режим не включается и evaluate() остается точным; возвращает, включен ли режим.
+    // Таблица перестраивается в updateCurve(). Пакетная фазификация (KBFuzzifier) ее не использует.
+    bool useLookupTable(size_t resolution = 4096, double maxError = 1e-3);
+    void dropLookupTable();
+    bool hasLookupTable() const { return !lut.empty(); }
+    // Наибольшее отклонение таблицы от точной кривой
+    double getLookupError() const { return lutError; }
+    const vector<double>& getCurveX() const { return curveX; }
+    const vector<double>& getCurveY() const { return curveY; }
+
+    void collectAttrs(KBAttrList &attrs) const override;
     vector<xmlNodePtr> getInnerXML() const override;
+    void writeInnerXML(KBXMLWriter &writer) const override;
     Json::Value toJSON() const override;
+    void collectDiagnostics(const KnowledgeBase& kb, vector<KBDiagnostic>& diagnostics) const override;
+    void writeJSON(KBJSONWriter& writer) const override;
 
     static MembershipFunction* fromXML(const xmlNodePtr xml);
     static MembershipFunction* fromJSON(const Json::Value& json);
 
-    string KRL() const override;
+    void writeKRL(string& out) const override;
 };
 
 #endif // MEMBERSHIP_FUNCTION_H
\ No newline at end of file
@@ -11,6 +11,16 @@ using namespace std;
 
 double num(double v);
 
+// Значение коэффициента уверенности без накладных расходов KBEntity
+struct KBNonFactorValue
+{
+    double belief = 50.0;
+    double probability = 100.0;
+    double accuracy = 0.0;
+
+    bool isDefault() const { return belief == 50.0 && probability == 100.0 && accuracy == 0.0; }
+};
+
 class NonFactor : public KBEntity {
 private:
     double belief;
@@ -25,17 +35,24 @@ public:
     double getBelief() const { return belief; }
     double getProbability() const { return probability; }
     double getAccuracy() const { return accuracy; }
+    KBNonFactorValue getValue() const { return {belief, probability, accuracy}; }
+
+    // Общий неизменяемый экземпляр коэффициента по умолчанию (50/100/0); владельца у него нет
+    static const NonFactor* getDefault();
 
-    map<string, string> getAttrs() const override;
+    void collectAttrs(KBAttrList& attrs) const override;
     xmlNodePtr toXML() const override;
+    void writeXML(KBXMLWriter& writer) const override;
     Json::Value toJSON() const;
+    void writeJSON(KBJSONWriter& writer) const override;
 
     static NonFactor* fromXML(xmlNodePtr node);
     static NonFactor* fromJSON(const Json::Value& json);
 
     bool isDefault() const;
+    void collectDiagnostics(const KnowledgeBase& kb, vector<KBDiagnostic>& diagnostics) const override;
     bool isInitialized() const { return this->initialized; };
-    string KRL() const override;
+    void writeKRL(string& out) const override;
     string getXMLOwnerPath() const override;
 };
 
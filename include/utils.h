@@ -5,14 +5,73 @@
 #include <sstream>
 #include <iomanip>
 #include <limits>
+#include <string>
+#include <string_view>
+#include <charconv>
+#include <cstdlib>
+#include <stdexcept>
 #include <libxml/parser.h>
 #include <libxml/tree.h>
 
 
+// Числовой кодек: std::to_chars/std::from_chars не зависят от локали и не выделяют память.
+
+// Дописывает число в буфер в кратчайшем виде, который читается обратно без потери точности
+inline void appendDouble(std::string& out, double value) {
+    char buffer[32];
+    std::to_chars_result result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    out.append(buffer, result.ptr - buffer);
+}
+
 inline std::string doubleToString(double value) {
-    std::ostringstream oss;
-    oss << std::setprecision(std::numeric_limits<double>::max_digits10) << value;
-    return oss.str();
+    std::string result;
+    appendDouble(result, value);
+    return result;
+}
+
+// Разбирает число целиком (допускаются знак +/-, экспонента, inf и nan и пробелы по краям)
+inline bool tryParseDouble(std::string_view text, double& value) {
+    size_t begin = text.find_first_not_of(" \t\r\n");
+    if (begin == std::string_view::npos) {
+        return false;
+    }
+    size_t end = text.find_last_not_of(" \t\r\n") + 1;
+    const char* first = text.data() + begin;
+    const char* last = text.data() + end;
+    // from_chars не принимает ведущий '+'
+    if (*first == '+' && last - first > 1 && first[1] != '-') {
+        ++first;
+    }
+    std::from_chars_result result = std::from_chars(first, last, value);
+    if (result.ec == std::errc::result_out_of_range && result.ptr == last) {
+        // libstdc++ считает денормализованные числа выходом за диапазон; strtod их принимает
+        std::string copy(first, last);
+        char* parsedEnd = nullptr;
+        value = std::strtod(copy.c_str(), &parsedEnd);
+        return parsedEnd == copy.c_str() + copy.size();
+    }
+    return result.ec == std::errc() && result.ptr == last;
+}
+
+inline double parseDouble(std::string_view text) {
+    double value = 0.0;
+    if (!tryParseDouble(text, value)) {
+        throw std::invalid_argument("Invalid number: " + std::string(text));
+    }
+    return value;
+}
+
+// Проверяет, что текст - десятичная запись числа (без inf/nan и пробельных символов по краям), и разбирает ее
+inline bool parseDecimal(std::string_view text, double& value) {
+    size_t i = (!text.empty() && (text[0] == '+' || text[0] == '-')) ? 1 : 0;
+    if (i >= text.size() || !((text[i] >= '0' && text[i] <= '9') || text[i] == '.')) {
+        return false;
+    }
+    char last = text.back();
+    if (!((last >= '0' && last <= '9') || last == '.')) {
+        return false;
+    }
+    return tryParseDouble(text, value);
 }
 
 inline xmlNodePtr parseXmlString(const std::string& xmlString) {
@@ -54,4 +113,15 @@ inline xmlNodePtr findNodeByName(xmlNodePtr root, const char* name) {
     return nullptr;
 }
 
+// Значение атрибута элемента; false, если атрибута нет
+inline bool xmlProp(xmlNodePtr node, const char* name, std::string& value) {
+    xmlChar* attr = xmlGetProp(node, BAD_CAST name);
+    if (!attr) {
+        return false;
+    }
+    value = (const char*)attr;
+    xmlFree(attr);
+    return true;
+}
+
 #endif // UTILS_H
\ No newline at end of file
@@ -0,0 +1,175 @@
+#include "kb_arena.h"
+#include "kb_entity.h"
+#include <cstdlib>
+#include <new>
+#include <algorithm>
+
+using namespace std;
+
+static thread_local KBArena *currentArena = nullptr;
+// Арена, выполняющая release() в текущем потоке
+static thread_local KBArena *releasingArena = nullptr;
+
+// Перед каждой сущностью хранится заголовок: арена (nullptr - память из кучи) и признак того,
+// что сущность еще не разрушена
+struct KBEntityHeader
+{
+    KBArena *arena;
+    bool alive;
+};
+
+static constexpr size_t HEADER_SIZE = alignof(max_align_t);
+static_assert(sizeof(KBEntityHeader) <= HEADER_SIZE, "Entity header must fit before the object");
+
+static KBEntityHeader *headerOf(const void *entity)
+{
+    return reinterpret_cast<KBEntityHeader *>(static_cast<char *>(const_cast<void *>(entity)) - HEADER_SIZE);
+}
+
+KBArena::KBArena(size_t blockSize) : blockSize(blockSize) {}
+
+KBArena::~KBArena()
+{
+    release();
+}
+
+KBArena::Block &KBArena::addBlock(size_t minSize)
+{
+    size_t size = std::max(blockSize, minSize);
+    char *data = static_cast<char *>(aligned_alloc(alignof(max_align_t), (size + alignof(max_align_t) - 1) / alignof(max_align_t) * alignof(max_align_t)));
+    if (!data)
+    {
+        throw bad_alloc();
+    }
+    blocks.push_back({data, size, 0});
+    return blocks.back();
+}
+
+void *KBArena::allocate(size_t size, size_t alignment)
+{
+    if (!blocks.empty())
+    {
+        Block &block = blocks.back();
+        size_t offset = (block.used + alignment - 1) / alignment * alignment;
+        if (offset + size <= block.size)
+        {
+            block.used = offset + size;
+            bytesUsed += size;
+            return block.data + offset;
+        }
+    }
+    Block &block = addBlock(size);
+    block.used = size;
+    bytesUsed += size;
+    return block.data;
+}
+
+void KBArena::release()
+{
+    KBArena *previous = releasingArena;
+    releasingArena = this;
+    for (void *entity : entities)
+    {
+        KBEntityHeader *header = headerOf(entity);
+        if (header->alive)
+        {
+            header->alive = false;
+            // Сущности наследуют KBEntity одиночным наследованием, поэтому адрес KBEntity
+            // совпадает с адресом выделенной памяти
+            static_cast<KBEntity *>(entity)->~KBEntity();
+        }
+    }
+    releasingArena = previous;
+    entities.clear();
+    liveCount = 0;
+
+    for (Block &block : blocks)
+    {
+        free(block.data);
+    }
+    blocks.clear();
+    bytesUsed = 0;
+}
+
+bool KBArena::owns(const void *ptr) const
+{
+    const char *p = static_cast<const char *>(ptr);
+    for (const Block &block : blocks)
+    {
+        if (p >= block.data && p < block.data + block.size)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+KBArena *KBArena::current()
+{
+    return currentArena;
+}
+
+KBArena *KBArena::of(const void *entity)
+{
+    return headerOf(entity)->arena;
+}
+
+KBArenaScope::KBArenaScope(KBArena &arena) : previous(currentArena)
+{
+    currentArena = &arena;
+}
+
+KBArenaScope::~KBArenaScope()
+{
+    currentArena = previous;
+}
+
+void *kbEntityAllocate(size_t size)
+{
+    KBArena *arena = currentArena;
+    char *memory;
+    if (arena)
+    {
+        memory = static_cast<char *>(arena->allocate(size + HEADER_SIZE));
+    }
+    else
+    {
+        memory = static_cast<char *>(malloc(size + HEADER_SIZE));
+        if (!memory)
+        {
+            throw bad_alloc();
+        }
+    }
+    KBEntityHeader *header = reinterpret_cast<KBEntityHeader *>(memory);
+    header->arena = arena;
+    header->alive = true;
+    if (arena)
+    {
+        arena->entities.push_back(memory + HEADER_SIZE);
+        ++arena->liveCount;
+    }
+    return memory + HEADER_SIZE;
+}
+
+void kbEntityDeallocate(void *ptr)
+{
+    if (!ptr)
+    {
+        return;
+    }
+    KBEntityHeader *header = headerOf(ptr);
+    if (header->arena == nullptr)
+    {
+        free(header);
+    }
+    else
+    {
+        header->alive = false;
+        --header->arena->liveCount;
+    }
+}
+
+bool kbEntityReleasing(const void *entity)
+{
+    return releasingArena != nullptr && headerOf(entity)->arena == releasingArena;
+}
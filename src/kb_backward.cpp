@@ -0,0 +1,300 @@
+#include "kb_backward.h"
+#include <stdexcept>
+#include <algorithm>
+
+using namespace std;
+
+static const KBNonFactorValue CERTAIN = {100.0, 100.0, 0.0};
+
+// KBSolverSession implementation
+
+KBSolverSession::KBSolverSession(size_t slotCount, size_t ruleCount)
+    : values(slotCount), states(slotCount, OPEN), conditions(ruleCount), conditionStates(ruleCount, OPEN),
+      depths(slotCount), conditionDepths(ruleCount)
+{
+}
+
+void KBSolverSession::setFact(uint32_t slot, const KBEvalValue &value)
+{
+    values.at(slot) = value;
+    states[slot] = FACT;
+    // Выведенные ранее значения могли зависеть от прежнего значения факта
+    clearDerived();
+}
+
+void KBSolverSession::clearDerived()
+{
+    if (!derived)
+    {
+        return;
+    }
+    derived = false;
+    for (size_t i = 0; i < states.size(); ++i)
+    {
+        if (states[i] != FACT)
+        {
+            values[i] = KBEvalValue();
+            states[i] = OPEN;
+        }
+    }
+    fill(conditionStates.begin(), conditionStates.end(), OPEN);
+    pendingGoals.clear();
+    pendingConditions.clear();
+}
+
+// KBBackwardSolver implementation
+
+KBBackwardSolver::KBBackwardSolver(KnowledgeBase &kb)
+    : kb(kb), layout(kb.bindReferences()), schemaVersion(kb.getSchemaVersion())
+{
+    producers.resize(layout.getSlotCount());
+    const vector<KBRule *> &all = kb.getRules();
+    for (uint32_t i = 0; i < all.size(); ++i)
+    {
+        RuleEntry entry;
+        entry.condition = all[i]->getCondition() ? addProgram(all[i]->getCondition(), entry.premises) : NONE;
+        rules.push_back(entry);
+        addConclusions(i, all[i]->getInstructions(), false);
+        addConclusions(i, all[i]->getElseInstructions(), true);
+    }
+}
+
+uint32_t KBBackwardSolver::addProgram(const Evaluatable *node, vector<uint32_t> &premises)
+{
+    layout.collectSlots(node, premises);
+    programs.push_back(KBProgram::compile(node, layout));
+    return programs.size() - 1;
+}
+
+void KBBackwardSolver::addConclusions(uint32_t rule, const vector<KBAssign *> &instructions, bool elseBranch)
+{
+    for (const KBAssign *assign : instructions)
+    {
+        Conclusion conclusion;
+        conclusion.rule = rule;
+        conclusion.elseBranch = elseBranch;
+        conclusion.value = addProgram(assign->getValue(), conclusion.premises);
+        producers[layout.require(assign->getRef())].push_back(conclusions.size());
+        conclusions.push_back(move(conclusion));
+    }
+}
+
+KBSolverSession KBBackwardSolver::createSession() const
+{
+    return KBSolverSession(layout.getSlotCount(), rules.size());
+}
+
+void KBBackwardSolver::checkSession(const KBSolverSession &session) const
+{
+    if (kb.getSchemaVersion() != schemaVersion || kb.getRules().size() != rules.size())
+    {
+        throw logic_error("Knowledge base changed after the solver was created");
+    }
+    if (session.values.size() != layout.getSlotCount() || session.conditions.size() != rules.size())
+    {
+        throw invalid_argument("Session was created by another solver");
+    }
+}
+
+vector<uint32_t> KBBackwardSolver::getProducers(uint32_t slot) const
+{
+    vector<uint32_t> result;
+    for (uint32_t conclusion : producers.at(slot))
+    {
+        if (result.empty() || result.back() != conclusions[conclusion].rule)
+        {
+            result.push_back(conclusions[conclusion].rule);
+        }
+    }
+    return result;
+}
+
+void KBBackwardSolver::closeComponent(KBSolverSession &session, size_t goalMark, size_t conditionMark, bool solved)
+{
+    for (size_t i = goalMark; i < session.pendingGoals.size(); ++i)
+    {
+        uint32_t slot = session.pendingGoals[i];
+        session.states[slot] = solved ? KBSolverSession::SOLVED : KBSolverSession::OPEN;
+    }
+    for (size_t i = conditionMark; i < session.pendingConditions.size(); ++i)
+    {
+        uint32_t rule = session.pendingConditions[i];
+        session.conditionStates[rule] = solved ? KBSolverSession::SOLVED : KBSolverSession::OPEN;
+    }
+    session.pendingGoals.resize(goalMark);
+    session.pendingConditions.resize(conditionMark);
+}
+
+KBEvalValue KBBackwardSolver::solveCondition(KBSolverSession &session, uint32_t rule, uint32_t &low)
+{
+    switch (session.conditionStates[rule])
+    {
+    case KBSolverSession::SOLVED:
+        ++session.memoHits;
+        return session.conditions[rule];
+    case KBSolverSession::INCOMPLETE:
+        ++session.memoHits;
+        low = std::min(low, session.conditionDepths[rule]);
+        return session.conditions[rule];
+    case KBSolverSession::ACTIVE:
+        // Условие зависит от собственного вывода: текущий ответ
+        ++session.cycles;
+        low = std::min(low, session.conditionDepths[rule]);
+        return session.conditions[rule];
+    default:
+        break;
+    }
+
+    uint32_t depth = session.depth++;
+    session.conditionStates[rule] = KBSolverSession::ACTIVE;
+    session.conditionDepths[rule] = depth;
+    session.conditions[rule] = KBEvalValue();
+    size_t goalMark = session.pendingGoals.size();
+    size_t conditionMark = session.pendingConditions.size();
+    const RuleEntry &entry = rules[rule];
+    uint32_t reached;
+    KBEvalValue result;
+    for (size_t pass = 1;; ++pass)
+    {
+        reached = NONE;
+        for (uint32_t premise : entry.premises)
+        {
+            solveGoal(session, premise, reached);
+        }
+        result = entry.condition != NONE ? vm.run(programs[entry.condition], session.values.data())
+                                         : KBEvalValue::fromBoolean(true, CERTAIN);
+        if (reached != depth || result == session.conditions[rule] || pass == MAX_FIXPOINT_PASSES)
+        {
+            break;
+        }
+        // Лидер компоненты: новый проход с обновленным ответом
+        session.conditions[rule] = result;
+        closeComponent(session, goalMark, conditionMark, false);
+    }
+    --session.depth;
+    session.derived = true;
+    session.conditions[rule] = result;
+    if (reached < depth)
+    {
+        session.conditionStates[rule] = KBSolverSession::INCOMPLETE;
+        session.conditionDepths[rule] = reached;
+        session.pendingConditions.push_back(rule);
+        low = std::min(low, reached);
+        return result;
+    }
+    closeComponent(session, goalMark, conditionMark, true);
+    session.conditionStates[rule] = KBSolverSession::SOLVED;
+    return result;
+}
+
+KBEvalValue KBBackwardSolver::proveGoal(KBSolverSession &session, uint32_t slot, uint32_t &reached)
+{
+    KBEvalValue best;
+    for (uint32_t index : producers[slot])
+    {
+        const Conclusion &conclusion = conclusions[index];
+        ++rulesTried;
+        KBEvalValue condition = solveCondition(session, conclusion.rule, reached);
+        int truth = condition.getTruth();
+        if (truth < 0 || (truth == 1) == conclusion.elseBranch)
+        {
+            continue;
+        }
+        for (uint32_t premise : conclusion.premises)
+        {
+            solveGoal(session, premise, reached);
+        }
+        KBEvalValue value = vm.run(programs[conclusion.value], session.values.data());
+        if (!value.isDefined())
+        {
+            continue;
+        }
+        // Вывод не может быть увереннее посылки; для ветки ИНАЧЕ уверенность в ложности условия та же
+        value.nonFactor = applyNonFactor(value.nonFactor, condition.nonFactor);
+        if (!best.isDefined() || value.nonFactor.belief > best.nonFactor.belief)
+        {
+            best = value;
+        }
+    }
+    return best;
+}
+
+KBEvalValue KBBackwardSolver::solveGoal(KBSolverSession &session, uint32_t slot, uint32_t &low)
+{
+    switch (session.states[slot])
+    {
+    case KBSolverSession::SOLVED:
+    case KBSolverSession::FACT:
+        ++session.memoHits;
+        return session.values[slot];
+    case KBSolverSession::INCOMPLETE:
+        ++session.memoHits;
+        low = std::min(low, session.depths[slot]);
+        return session.values[slot];
+    case KBSolverSession::ACTIVE:
+        // Цикл: текущий ответ цели, в первом проходе - неопределенный
+        ++session.cycles;
+        low = std::min(low, session.depths[slot]);
+        return session.values[slot];
+    default:
+        break;
+    }
+
+    uint32_t depth = session.depth++;
+    session.states[slot] = KBSolverSession::ACTIVE;
+    session.depths[slot] = depth;
+    session.values[slot] = KBEvalValue();
+    size_t goalMark = session.pendingGoals.size();
+    size_t conditionMark = session.pendingConditions.size();
+    uint32_t reached;
+    KBEvalValue best;
+    for (size_t pass = 1;; ++pass)
+    {
+        reached = NONE;
+        best = proveGoal(session, slot, reached);
+        if (reached != depth || best == session.values[slot] || pass == MAX_FIXPOINT_PASSES)
+        {
+            break;
+        }
+        // Лидер компоненты: ответы компоненты выведены из устаревшего ответа цели
+        session.values[slot] = best;
+        closeComponent(session, goalMark, conditionMark, false);
+    }
+    --session.depth;
+    session.derived = true;
+    session.values[slot] = best;
+    if (reached < depth)
+    {
+        session.states[slot] = KBSolverSession::INCOMPLETE;
+        session.depths[slot] = reached;
+        session.pendingGoals.push_back(slot);
+        low = std::min(low, reached);
+        return best;
+    }
+    closeComponent(session, goalMark, conditionMark, true);
+    session.states[slot] = KBSolverSession::SOLVED;
+    return best;
+}
+
+const KBEvalValue &KBBackwardSolver::solve(KBSolverSession &session, uint32_t slot)
+{
+    checkSession(session);
+    if (slot >= session.values.size())
+    {
+        throw out_of_range("Slot " + to_string(slot) + " is out of range");
+    }
+    // Цель запроса - внешняя, поэтому ее доказательство всегда завершено
+    uint32_t low = NONE;
+    solveGoal(session, slot, low);
+    return session.values[slot];
+}
+
+const KBEvalValue &KBBackwardSolver::solve(KBSolverSession &session, const string &path)
+{
+    uint32_t slot = layout.slot(path);
+    if (slot == KBSlotLayout::NONE)
+    {
+        throw invalid_argument("Unknown attribute " + path);
+    }
+    return solve(session, slot);
+}
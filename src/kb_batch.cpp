@@ -0,0 +1,316 @@
+#include "kb_batch.h"
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <stdexcept>
+#include <cstring>
+
+using namespace std;
+
+// Ядра операций. Результат записывается на место левого операнда.
+// Циклы не содержат ветвлений и зависимостей между итерациями, поэтому векторизуются компилятором.
+
+static const double UNDEFINED = numeric_limits<double>::quiet_NaN();
+
+#define KB_BINARY_KERNEL(name, expr)                                               \
+    static void name(double *__restrict a, const double *__restrict b, size_t n) \
+    {                                                                              \
+        for (size_t i = 0; i < n; ++i)                                             \
+        {                                                                          \
+            const double x = a[i], y = b[i];                                       \
+            a[i] = (expr);                                                         \
+        }                                                                          \
+    }
+
+#define KB_IS_NAN(v) ((v) != (v))
+
+KB_BINARY_KERNEL(kernelAdd, x + y)
+KB_BINARY_KERNEL(kernelSub, x - y)
+KB_BINARY_KERNEL(kernelMul, x * y)
+KB_BINARY_KERNEL(kernelDiv, y != 0.0 ? x / y : UNDEFINED)
+KB_BINARY_KERNEL(kernelEq, KB_IS_NAN(x) || KB_IS_NAN(y) ? UNDEFINED : (double)(x == y))
+KB_BINARY_KERNEL(kernelNe, KB_IS_NAN(x) || KB_IS_NAN(y) ? UNDEFINED : (double)(x != y))
+KB_BINARY_KERNEL(kernelGt, KB_IS_NAN(x) || KB_IS_NAN(y) ? UNDEFINED : (double)(x > y))
+KB_BINARY_KERNEL(kernelGe, KB_IS_NAN(x) || KB_IS_NAN(y) ? UNDEFINED : (double)(x >= y))
+KB_BINARY_KERNEL(kernelLt, KB_IS_NAN(x) || KB_IS_NAN(y) ? UNDEFINED : (double)(x < y))
+KB_BINARY_KERNEL(kernelLe, KB_IS_NAN(x) || KB_IS_NAN(y) ? UNDEFINED : (double)(x <= y))
+KB_BINARY_KERNEL(kernelAnd, x == 0.0 || y == 0.0 ? 0.0 : (KB_IS_NAN(x) || KB_IS_NAN(y) ? UNDEFINED : 1.0))
+KB_BINARY_KERNEL(kernelOr, (!KB_IS_NAN(x) && x != 0.0) || (!KB_IS_NAN(y) && y != 0.0) ? 1.0 : (KB_IS_NAN(x) || KB_IS_NAN(y) ? UNDEFINED : 0.0))
+KB_BINARY_KERNEL(kernelXor, KB_IS_NAN(x) || KB_IS_NAN(y) ? UNDEFINED : (double)((x != 0.0) != (y != 0.0)))
+KB_BINARY_KERNEL(kernelMin, x < y ? x : y)
+KB_BINARY_KERNEL(kernelMax, x > y ? x : y)
+
+static void kernelMod(double *__restrict a, const double *__restrict b, size_t n)
+{
+    for (size_t i = 0; i < n; ++i)
+    {
+        a[i] = b[i] != 0.0 ? fmod(a[i], b[i]) : UNDEFINED;
+    }
+}
+
+static void kernelPow(double *__restrict a, const double *__restrict b, size_t n)
+{
+    for (size_t i = 0; i < n; ++i)
+    {
+        // pow(1, NaN) и pow(NaN, 0) равны 1, а неопределенный операнд дает неопределенный результат
+        a[i] = KB_IS_NAN(a[i]) || KB_IS_NAN(b[i]) ? UNDEFINED : pow(a[i], b[i]);
+    }
+}
+
+static void kernelNeg(double *__restrict a, size_t n)
+{
+    for (size_t i = 0; i < n; ++i)
+    {
+        a[i] = -a[i];
+    }
+}
+
+static void kernelNot(double *__restrict a, size_t n)
+{
+    for (size_t i = 0; i < n; ++i)
+    {
+        const double x = a[i];
+        a[i] = KB_IS_NAN(x) ? UNDEFINED : (double)(x == 0.0);
+    }
+}
+
+// Отрицание меняет местами и дополняет до 100 уверенность и вероятность
+static void kernelNotNonFactor(double *__restrict belief, double *__restrict probability, size_t n)
+{
+    for (size_t i = 0; i < n; ++i)
+    {
+        const double b = belief[i], p = probability[i];
+        belief[i] = 100.0 - p;
+        probability[i] = 100.0 - b;
+    }
+}
+
+// Операнд, для которого операция не определена (вид не подходит), - неопределенное значение
+static void kernelUndefined(double *__restrict a, size_t n)
+{
+    fill(a, a + n, UNDEFINED);
+}
+
+// Равенство значений разных видов: ложь, если оба определены
+static void kernelMixedEq(double *__restrict a, const double *__restrict b, double result, size_t n)
+{
+    for (size_t i = 0; i < n; ++i)
+    {
+        const double x = a[i], y = b[i];
+        a[i] = KB_IS_NAN(x) || KB_IS_NAN(y) ? UNDEFINED : result;
+    }
+}
+
+static void kernelCapScalar(double *__restrict a, double cap, size_t n)
+{
+    for (size_t i = 0; i < n; ++i)
+    {
+        a[i] = a[i] < cap ? a[i] : cap;
+    }
+}
+
+static void fillColumn(double *__restrict dst, const double *src, double fallback, size_t n)
+{
+    if (src)
+    {
+        memcpy(dst, src, n * sizeof(double));
+    }
+    else
+    {
+        fill(dst, dst + n, fallback);
+    }
+}
+
+// KBBatchEvaluator implementation
+
+KBBatchEvaluator::KBBatchEvaluator(const KBProgram &program)
+    : program(program),
+      values(program.getMaxStack() * BLOCK_SIZE),
+      belief(program.getMaxStack() * BLOCK_SIZE),
+      probability(program.getMaxStack() * BLOCK_SIZE),
+      kinds(program.getMaxStack())
+{
+    for (const KBEvalValue &constant : program.getConstants())
+    {
+        switch (constant.kind)
+        {
+        case KBEvalValue::NUMBER:
+            constants.push_back(constant.number);
+            break;
+        case KBEvalValue::BOOLEAN:
+            constants.push_back(constant.boolean ? 1.0 : 0.0);
+            break;
+        case KBEvalValue::SYMBOL:
+            constants.push_back((double)constant.symbol);
+            break;
+        default:
+            constants.push_back(UNDEFINED);
+            break;
+        }
+    }
+}
+
+void KBBatchEvaluator::runBlock(const vector<KBColumn> &columns, size_t offset, size_t count)
+{
+    size_t top = 0;
+    for (const KBInstruction &instruction : program.getCode())
+    {
+        double *v = values.data() + top * BLOCK_SIZE;
+        double *b = belief.data() + top * BLOCK_SIZE;
+        double *p = probability.data() + top * BLOCK_SIZE;
+        switch (instruction.code)
+        {
+        case KBOpCode::PUSH_CONST:
+        {
+            const KBEvalValue &constant = program.getConstants()[instruction.arg];
+            fill(v, v + count, constants[instruction.arg]);
+            fill(b, b + count, constant.nonFactor.belief);
+            fill(p, p + count, constant.nonFactor.probability);
+            kinds[top] = constant.kind;
+            ++top;
+            continue;
+        }
+        case KBOpCode::LOAD_REF:
+        {
+            const KBColumn &column = columns[instruction.arg];
+            fillColumn(v, column.values ? column.values + offset : nullptr, UNDEFINED, count);
+            fillColumn(b, column.belief ? column.belief + offset : nullptr, column.defaultBelief, count);
+            fillColumn(p, column.probability ? column.probability + offset : nullptr, column.defaultProbability, count);
+            kinds[top] = column.values ? column.kind : KBEvalValue::UNDEFINED;
+            ++top;
+            continue;
+        }
+        default:
+            break;
+        }
+
+        // Операнды: верхний элемент стека (унарные операции и WITH) либо два верхних
+        double *a = values.data() + (top - 1) * BLOCK_SIZE;
+        double *ab = belief.data() + (top - 1) * BLOCK_SIZE;
+        double *ap = probability.data() + (top - 1) * BLOCK_SIZE;
+        if (instruction.code == KBOpCode::WITH)
+        {
+            const KBNonFactorValue &nf = program.getNonFactors()[instruction.arg];
+            kernelCapScalar(ab, nf.belief, count);
+            kernelCapScalar(ap, nf.probability, count);
+            continue;
+        }
+        KBEvalValue::Kind &aKind = kinds[top - 1];
+        if (instruction.code == KBOpCode::NOT)
+        {
+            if (aKind == KBEvalValue::SYMBOL)
+            {
+                kernelUndefined(a, count);
+            }
+            kernelNot(a, count);
+            kernelNotNonFactor(ab, ap, count);
+            aKind = KBEvalValue::BOOLEAN;
+            continue;
+        }
+        if (instruction.code == KBOpCode::NEG)
+        {
+            if (aKind != KBEvalValue::NUMBER)
+            {
+                kernelUndefined(a, count);
+            }
+            kernelNeg(a, count);
+            aKind = KBEvalValue::NUMBER;
+            continue;
+        }
+
+        double *x = values.data() + (top - 2) * BLOCK_SIZE;
+        double *xb = belief.data() + (top - 2) * BLOCK_SIZE;
+        double *xp = probability.data() + (top - 2) * BLOCK_SIZE;
+        KBEvalValue::Kind &xKind = kinds[top - 2];
+        bool logical = instruction.code == KBOpCode::AND || instruction.code == KBOpCode::OR || instruction.code == KBOpCode::XOR;
+        bool equality = instruction.code == KBOpCode::EQ || instruction.code == KBOpCode::NE;
+        if (logical)
+        {
+            // Символ не имеет истинности
+            if (xKind == KBEvalValue::SYMBOL)
+            {
+                kernelUndefined(x, count);
+            }
+            if (aKind == KBEvalValue::SYMBOL)
+            {
+                kernelUndefined(a, count);
+            }
+        }
+        if (equality && xKind != aKind)
+        {
+            kernelMixedEq(x, a, instruction.code == KBOpCode::EQ ? 0.0 : 1.0, count);
+        }
+        else if (!logical && !equality && (xKind != KBEvalValue::NUMBER || aKind != KBEvalValue::NUMBER))
+        {
+            kernelUndefined(x, count);
+        }
+        else
+        {
+            switch (instruction.code)
+            {
+            case KBOpCode::EQ: kernelEq(x, a, count); break;
+            case KBOpCode::NE: kernelNe(x, a, count); break;
+            case KBOpCode::GT: kernelGt(x, a, count); break;
+            case KBOpCode::GE: kernelGe(x, a, count); break;
+            case KBOpCode::LT: kernelLt(x, a, count); break;
+            case KBOpCode::LE: kernelLe(x, a, count); break;
+            case KBOpCode::AND: kernelAnd(x, a, count); break;
+            case KBOpCode::OR: kernelOr(x, a, count); break;
+            case KBOpCode::XOR: kernelXor(x, a, count); break;
+            case KBOpCode::ADD: kernelAdd(x, a, count); break;
+            case KBOpCode::SUB: kernelSub(x, a, count); break;
+            case KBOpCode::MUL: kernelMul(x, a, count); break;
+            case KBOpCode::DIV: kernelDiv(x, a, count); break;
+            case KBOpCode::MOD: kernelMod(x, a, count); break;
+            case KBOpCode::POW: kernelPow(x, a, count); break;
+            default:
+                throw invalid_argument("Unsupported instruction in batch mode");
+            }
+        }
+        switch (instruction.code)
+        {
+        case KBOpCode::ADD:
+        case KBOpCode::SUB:
+        case KBOpCode::MUL:
+        case KBOpCode::DIV:
+        case KBOpCode::MOD:
+        case KBOpCode::POW:
+            xKind = KBEvalValue::NUMBER;
+            break;
+        default:
+            xKind = KBEvalValue::BOOLEAN;
+            break;
+        }
+        if (instruction.code == KBOpCode::OR)
+        {
+            kernelMax(xb, ab, count);
+            kernelMax(xp, ap, count);
+        }
+        else
+        {
+            kernelMin(xb, ab, count);
+            kernelMin(xp, ap, count);
+        }
+        --top;
+    }
+}
+
+void KBBatchEvaluator::run(const vector<KBColumn> &columns, size_t rows, double *result, double *resultBelief, double *resultProbability)
+{
+    if (columns.size() < program.getSlotCount())
+    {
+        throw invalid_argument("Not enough columns for program references");
+    }
+    for (size_t offset = 0; offset < rows; offset += BLOCK_SIZE)
+    {
+        size_t count = std::min(BLOCK_SIZE, rows - offset);
+        runBlock(columns, offset, count);
+        resultKind = kinds[0];
+        memcpy(result + offset, values.data(), count * sizeof(double));
+        memcpy(resultBelief + offset, belief.data(), count * sizeof(double));
+        if (resultProbability)
+        {
+            memcpy(resultProbability + offset, probability.data(), count * sizeof(double));
+        }
+    }
+}
@@ -0,0 +1,309 @@
+#include "kb_defuzzify.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+using namespace std;
+
+// Пределы терма на отрезке (a, b), внутри которого нет точек кривой: справа в a и слева в b
+static void termLimits(const MembershipFunction &mf, double a, double b, double &ya, double &yb)
+{
+    const vector<double> &xs = mf.getCurveX();
+    const vector<double> &ys = mf.getCurveY();
+    if (xs.empty())
+    {
+        ya = yb = 0.0;
+        return;
+    }
+    // Первая точка правее a; при ступеньке в a предыдущая точка - верхняя
+    size_t i = upper_bound(xs.begin(), xs.end(), a) - xs.begin();
+    if (i == 0 || i == xs.size())
+    {
+        ya = yb = ys[i == 0 ? 0 : i - 1];
+        return;
+    }
+    double slope = (ys[i] - ys[i - 1]) / (xs[i] - xs[i - 1]);
+    ya = ys[i - 1] + slope * (a - xs[i - 1]);
+    yb = ys[i - 1] + slope * (b - xs[i - 1]);
+}
+
+KBDefuzzifier::KBDefuzzifier(const KBFuzzyType &type, Implication implication)
+    : KBDefuzzifier(type.getMembershipFunctionList(), implication)
+{
+}
+
+KBDefuzzifier::KBDefuzzifier(const vector<MembershipFunction *> &functions, Implication implication)
+    : implication(implication)
+{
+    if (functions.empty())
+    {
+        return;
+    }
+    double lo = functions.front()->min;
+    double hi = functions.front()->max;
+    for (const MembershipFunction *mf : functions)
+    {
+        names.push_back(mf->name);
+        lo = std::min(lo, mf->min);
+        hi = std::max(hi, mf->max);
+    }
+    if (!(lo < hi))
+    {
+        return;
+    }
+    bounds = {lo, hi};
+    for (const MembershipFunction *mf : functions)
+    {
+        for (double x : mf->getCurveX())
+        {
+            if (x > lo && x < hi)
+            {
+                bounds.push_back(x);
+            }
+        }
+    }
+    sort(bounds.begin(), bounds.end());
+    bounds.erase(unique(bounds.begin(), bounds.end()), bounds.end());
+
+    size_t termCount = functions.size();
+    left.resize((bounds.size() - 1) * termCount);
+    right.resize(left.size());
+    for (size_t i = 0; i + 1 < bounds.size(); ++i)
+    {
+        for (size_t t = 0; t < termCount; ++t)
+        {
+            termLimits(*functions[t], bounds[i], bounds[i + 1], left[i * termCount + t], right[i * termCount + t]);
+        }
+    }
+}
+
+// Верхняя огибающая линейных функций на [x0, x1]: вершины - концы отрезка и точки пересечения пар
+void KBDefuzzifier::addEnvelope(double x0, double x1, const vector<double> &y0, const vector<double> &y1, vector<Segment> &out) const
+{
+    double width = x1 - x0;
+    if (!(width > 0.0))
+    {
+        return;
+    }
+    vector<double> cuts = {0.0, 1.0};
+    for (size_t i = 0; i < y0.size(); ++i)
+    {
+        for (size_t j = i + 1; j < y0.size(); ++j)
+        {
+            double d0 = y0[i] - y0[j];
+            double d1 = y1[i] - y1[j];
+            if ((d0 < 0.0 && d1 > 0.0) || (d0 > 0.0 && d1 < 0.0))
+            {
+                cuts.push_back(d0 / (d0 - d1));
+            }
+        }
+    }
+    sort(cuts.begin(), cuts.end());
+
+    auto envelope = [&](double u)
+    {
+        double y = 0.0;
+        for (size_t k = 0; k < y0.size(); ++k)
+        {
+            y = std::max(y, y0[k] + (y1[k] - y0[k]) * u);
+        }
+        return y;
+    };
+    double from = 0.0;
+    double yFrom = envelope(0.0);
+    for (size_t c = 1; c < cuts.size(); ++c)
+    {
+        if (cuts[c] <= from)
+        {
+            continue;
+        }
+        double yTo = envelope(cuts[c]);
+        out.push_back({x0 + width * from, c + 1 == cuts.size() ? x1 : x0 + width * cuts[c], yFrom, yTo});
+        from = cuts[c];
+        yFrom = yTo;
+    }
+}
+
+void KBDefuzzifier::aggregate(const double *activations, vector<Segment> &out) const
+{
+    out.clear();
+    size_t termCount = names.size();
+    vector<double> alpha;
+    vector<size_t> active;
+    for (size_t t = 0; t < termCount; ++t)
+    {
+        // NaN и неположительная активация терм отключают
+        if (activations[t] > 0.0)
+        {
+            alpha.push_back(std::min(activations[t], 1.0));
+            active.push_back(t);
+        }
+    }
+
+    vector<double> y0(active.size());
+    vector<double> y1(active.size());
+    vector<double> cuts;
+    for (size_t i = 0; i + 1 < bounds.size(); ++i)
+    {
+        const double *l = left.data() + i * termCount;
+        const double *r = right.data() + i * termCount;
+        double a = bounds[i];
+        double b = bounds[i + 1];
+        // При ограничении терм остается линейным только до пересечения с уровнем активации
+        cuts = {0.0, 1.0};
+        if (implication == CLIP)
+        {
+            for (size_t k = 0; k < active.size(); ++k)
+            {
+                double d0 = l[active[k]] - alpha[k];
+                double d1 = r[active[k]] - alpha[k];
+                if ((d0 < 0.0 && d1 > 0.0) || (d0 > 0.0 && d1 < 0.0))
+                {
+                    cuts.push_back(d0 / (d0 - d1));
+                }
+            }
+            sort(cuts.begin(), cuts.end());
+        }
+        for (size_t c = 0; c + 1 < cuts.size(); ++c)
+        {
+            for (size_t k = 0; k < active.size(); ++k)
+            {
+                double from = l[active[k]];
+                double slope = r[active[k]] - from;
+                double v0 = from + slope * cuts[c];
+                double v1 = from + slope * cuts[c + 1];
+                y0[k] = implication == CLIP ? std::min(v0, alpha[k]) : v0 * alpha[k];
+                y1[k] = implication == CLIP ? std::min(v1, alpha[k]) : v1 * alpha[k];
+            }
+            double x1 = c + 2 == cuts.size() ? b : a + (b - a) * cuts[c + 1];
+            addEnvelope(a + (b - a) * cuts[c], x1, y0, y1, out);
+        }
+    }
+}
+
+vector<KBDefuzzifier::Segment> KBDefuzzifier::aggregate(const vector<double> &activations) const
+{
+    if (activations.size() != names.size())
+    {
+        throw invalid_argument("Activation count does not match the number of terms");
+    }
+    vector<Segment> segments;
+    aggregate(activations.data(), segments);
+    return segments;
+}
+
+double KBDefuzzifier::defuzzify(const double *activations, Method method) const
+{
+    vector<Segment> segments;
+    aggregate(activations, segments);
+    switch (method)
+    {
+    case CENTROID:
+        return centroid(segments);
+    case BISECTOR:
+        return bisector(segments);
+    case MEAN_OF_MAX:
+        return meanOfMax(segments);
+    }
+    throw invalid_argument("Unknown defuzzification method");
+}
+
+double KBDefuzzifier::defuzzify(const vector<double> &activations, Method method) const
+{
+    if (activations.size() != names.size())
+    {
+        throw invalid_argument("Activation count does not match the number of terms");
+    }
+    return defuzzify(activations.data(), method);
+}
+
+// ∫ y dx = h (y0 + y1) / 2, ∫ x y dx = h (x0 (2 y0 + y1) + x1 (y0 + 2 y1)) / 6
+double KBDefuzzifier::centroid(const vector<Segment> &segments)
+{
+    double area = 0.0;
+    double moment = 0.0;
+    for (const Segment &s : segments)
+    {
+        double h = s.x1 - s.x0;
+        area += h * (s.y0 + s.y1) * 0.5;
+        moment += h * (s.x0 * (2.0 * s.y0 + s.y1) + s.x1 * (s.y0 + 2.0 * s.y1)) / 6.0;
+    }
+    return area > 0.0 ? moment / area : numeric_limits<double>::quiet_NaN();
+}
+
+// Точка, делящая площадь пополам. Площадь от x0 до x0 + t: y0 t + k t² / 2 = r, где k - наклон;
+// корень берется в виде 2r / (y0 + √(y0² + 2kr)), устойчивом и при k = 0.
+double KBDefuzzifier::bisector(const vector<Segment> &segments)
+{
+    double area = 0.0;
+    for (const Segment &s : segments)
+    {
+        area += (s.x1 - s.x0) * (s.y0 + s.y1) * 0.5;
+    }
+    if (!(area > 0.0))
+    {
+        return numeric_limits<double>::quiet_NaN();
+    }
+    double rest = area * 0.5;
+    for (const Segment &s : segments)
+    {
+        double h = s.x1 - s.x0;
+        double part = h * (s.y0 + s.y1) * 0.5;
+        if (part <= 0.0 || part < rest)
+        {
+            rest -= part;
+            continue;
+        }
+        double k = (s.y1 - s.y0) / h;
+        double t = 2.0 * rest / (s.y0 + sqrt(std::max(0.0, s.y0 * s.y0 + 2.0 * k * rest)));
+        return s.x0 + std::min(t, h);
+    }
+    return segments.back().x1;
+}
+
+double KBDefuzzifier::meanOfMax(const vector<Segment> &segments)
+{
+    double height = 0.0;
+    for (const Segment &s : segments)
+    {
+        height = std::max(height, std::max(s.y0, s.y1));
+    }
+    if (!(height > 0.0))
+    {
+        return numeric_limits<double>::quiet_NaN();
+    }
+    // Вершины огибающей получены интерполяцией, поэтому уровень сравнивается с допуском
+    double level = height * (1.0 - 1e-12);
+    double length = 0.0;
+    double moment = 0.0;
+    double pointSum = 0.0;
+    double lastPoint = 0.0;
+    size_t pointCount = 0;
+    for (const Segment &s : segments)
+    {
+        bool top0 = s.y0 >= level;
+        bool top1 = s.y1 >= level;
+        if (top0 && top1)
+        {
+            length += s.x1 - s.x0;
+            moment += (s.x1 - s.x0) * (s.x0 + s.x1) * 0.5;
+        }
+        else if (top0 || top1)
+        {
+            // Вершина между двумя отрезками учитывается один раз
+            double x = top0 ? s.x0 : s.x1;
+            if (pointCount == 0 || x != lastPoint)
+            {
+                pointSum += x;
+                lastPoint = x;
+                ++pointCount;
+            }
+        }
+    }
+    if (length > 0.0)
+    {
+        return moment / length;
+    }
+    return pointSum / pointCount;
+}
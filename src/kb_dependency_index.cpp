@@ -0,0 +1,85 @@
+#include "kb_dependency_index.h"
+#include "kb_program.h"
+#include "kb_operation.h"
+#include "kb_reference.h"
+#include "kb_rule.h"
+#include <algorithm>
+
+using namespace std;
+
+void KBDependencyIndex::addExpression(const Evaluatable *node, uint32_t rule, bool condition)
+{
+    if (!node)
+    {
+        return;
+    }
+    if (const KBOperation *op = dynamic_cast<const KBOperation *>(node))
+    {
+        addExpression(op->getLeft(), rule, condition);
+        addExpression(op->getRight(), rule, condition);
+        return;
+    }
+    const KBReference *ref = dynamic_cast<const KBReference *>(node);
+    if (!ref)
+    {
+        return;
+    }
+    const Evaluatable *expression = ref;
+    if (const KBOperation *parent = dynamic_cast<const KBOperation *>(ref->owner))
+    {
+        expression = parent;
+    }
+
+    KBSymbol path(KBProgram::referencePath(ref));
+    uint32_t list = pathIndex.find(path);
+    if (list == KBSymbolIndex::NOT_FOUND)
+    {
+        list = dependents.size();
+        pathIndex.insert(path, list);
+        dependents.emplace_back();
+    }
+    dependents[list].push_back({ref, expression, rule, condition});
+}
+
+void KBDependencyIndex::addRule(const KBRule *rule, uint32_t ruleIndex)
+{
+    addExpression(rule->getCondition(), ruleIndex, true);
+    for (const vector<KBAssign *> *instructions : {&rule->getInstructions(), &rule->getElseInstructions()})
+    {
+        for (const KBAssign *assign : *instructions)
+        {
+            addExpression(assign->getValue(), ruleIndex, false);
+        }
+    }
+}
+
+void KBDependencyIndex::clear()
+{
+    pathIndex.clear();
+    dependents.clear();
+}
+
+const vector<KBDependency> &KBDependencyIndex::getDependents(KBSymbol path) const
+{
+    static const vector<KBDependency> NONE;
+    uint32_t list = pathIndex.find(path);
+    return list != KBSymbolIndex::NOT_FOUND ? dependents[list] : NONE;
+}
+
+vector<uint32_t> KBDependencyIndex::getAffectedRules(const vector<KBSymbol> &paths) const
+{
+    vector<uint32_t> rules;
+    for (KBSymbol path : paths)
+    {
+        for (const KBDependency &dependency : getDependents(path))
+        {
+            if (dependency.condition)
+            {
+                rules.push_back(dependency.rule);
+            }
+        }
+    }
+    sort(rules.begin(), rules.end());
+    rules.erase(unique(rules.begin(), rules.end()), rules.end());
+    return rules;
+}
@@ -8,22 +8,32 @@
 
 using namespace std;
 
-KBEntity::KBEntity(const string tag) : tag(tag) {};
+KBEntity::KBEntity(KBSymbol tag) : tag(tag) {};
 
 
-map<string, string> KBEntity::getAttrs() const
+string KBEntity::KRL() const
 {
-    map<string, string> result;
+    string result;
+    this->writeKRL(result);
     return result;
 }
 
+map<string, string> KBEntity::getAttrs() const
+{
+    KBAttrList attrs;
+    this->collectAttrs(attrs);
+    return attrs.toMap();
+}
+
 xmlNodePtr KBEntity::toXML() const
 {
-    map<string, string> attrs = this->getAttrs();
+    KBAttrList attrs;
+    this->collectAttrs(attrs);
+    attrs.sort();
     xmlNodePtr result = xmlNewNode(nullptr, BAD_CAST this->tag.c_str());
-    for (map<string, string>::iterator it = attrs.begin(); it != attrs.end(); ++it)
+    for (const auto &attr : attrs)
     {
-        xmlNewProp(result, BAD_CAST it->first.c_str(), BAD_CAST it->second.c_str());
+        xmlNewProp(result, BAD_CAST attr.first, BAD_CAST attr.second.c_str());
     }
     vector<xmlNodePtr> innerXML = this->getInnerXML();
     for (vector<xmlNodePtr>::iterator it = innerXML.begin(); it != innerXML.end(); ++it)
@@ -39,6 +49,16 @@ vector<xmlNodePtr> KBEntity::getInnerXML() const
     return vector<xmlNodePtr>();
 }
 
+void KBEntity::writeXML(KBXMLWriter &writer) const
+{
+    KBAttrList attrs;
+    this->collectAttrs(attrs);
+    writer.startElement(this->tag.c_str());
+    writer.attributes(attrs);
+    this->writeInnerXML(writer);
+    writer.endElement();
+}
+
 Json::Value KBEntity::toJSON() const
 {
     Json::Value result;
@@ -54,7 +74,37 @@ Json::Value KBEntity::toJSON() const
 }
 
 
-KBIdentity::KBIdentity(const string id, const string tag, const char* desc) : KBEntity(tag), id(id) {
+void KBEntity::writeJSON(KBJSONWriter &writer) const
+{
+    KBAttrList attrs;
+    this->collectAttrs(attrs);
+    attrs.set("tag", this->tag.str());
+    attrs.sort();
+    writer.startObject();
+    for (const auto &attr : attrs)
+    {
+        writer.member(attr.first, attr.second);
+    }
+    writer.endObject();
+}
+
+
+bool KBEntity::validate(const KnowledgeBase &kb, vector<KBDiagnostic> &diagnostics)
+{
+    size_t before = diagnostics.size();
+    this->collectDiagnostics(kb, diagnostics);
+    validated = diagnostics.size() == before;
+    return validated;
+}
+
+bool KBEntity::validate(const KnowledgeBase &kb)
+{
+    vector<KBDiagnostic> diagnostics;
+    return validate(kb, diagnostics);
+}
+
+
+KBIdentity::KBIdentity(KBSymbol id, KBSymbol tag, const char* desc) : KBEntity(tag), id(id) {
     if (desc != nullptr)
     {
         this->desc = new char[strlen(desc) + 1];
@@ -78,11 +128,10 @@ void KBIdentity::setDesc(const char* desc) {
     }
 }
 
-map<string, string> KBIdentity::getAttrs() const {
-    map<string, string> result = KBEntity::getAttrs();
-    result["id"] = this->id;
+void KBIdentity::collectAttrs(KBAttrList &attrs) const {
+    KBEntity::collectAttrs(attrs);
+    attrs.set("id", this->id.str());
     if (this->desc!= nullptr) {
-        result["desc"] = this->desc;
+        attrs.set("desc", this->desc);
     }
-    return result;
 }
\ No newline at end of file
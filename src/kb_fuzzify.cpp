@@ -0,0 +1,113 @@
+#include "kb_fuzzify.h"
+#include <algorithm>
+
+using namespace std;
+
+// Ядра фазификации. Результат накапливается в строке терма;
+// о векторизации циклов см. комментарий к ядрам в kb_batch.cpp.
+
+static void kernelFill(double *__restrict out, double value, size_t n)
+{
+    for (size_t i = 0; i < n; ++i)
+    {
+        out[i] = value;
+    }
+}
+
+static void kernelRamp(double *__restrict out, const double *__restrict x, double from, double to, double slope, size_t n)
+{
+    for (size_t i = 0; i < n; ++i)
+    {
+        double v = x[i];
+        v = v < from ? from : v;
+        v = v > to ? to : v;
+        out[i] += slope * (v - from);
+    }
+}
+
+static void kernelStep(double *__restrict out, const double *__restrict x, double at, double jump, size_t n)
+{
+    for (size_t i = 0; i < n; ++i)
+    {
+        out[i] += x[i] >= at ? jump : 0.0;
+    }
+}
+
+// Неопределенное значение не попадает ни в один отрезок; результат для него - NaN
+static void kernelUndefined(double *__restrict out, const double *__restrict x, size_t n)
+{
+    for (size_t i = 0; i < n; ++i)
+    {
+        out[i] = x[i] != x[i] ? x[i] : out[i];
+    }
+}
+
+KBFuzzifier::KBFuzzifier(const KBFuzzyType &type) : KBFuzzifier(type.getMembershipFunctionList()) {}
+
+KBFuzzifier::KBFuzzifier(const vector<MembershipFunction *> &functions)
+{
+    for (const MembershipFunction *mf : functions)
+    {
+        // Раскладывается точная кривая, даже если у терма включен режим таблицы
+        const vector<double> &xs = mf->getCurveX();
+        const vector<double> &ys = mf->getCurveY();
+        Term term;
+        term.name = mf->name;
+        term.base = ys.empty() ? 0.0 : ys.front();
+        term.empty = ys.empty();
+        term.firstRamp = ramps.size();
+        term.firstStep = steps.size();
+        for (size_t i = 0; i + 1 < xs.size(); ++i)
+        {
+            double width = xs[i + 1] - xs[i];
+            if (width > 0.0)
+            {
+                if (ys[i + 1] != ys[i])
+                {
+                    ramps.push_back({xs[i], xs[i + 1], (ys[i + 1] - ys[i]) / width});
+                }
+            }
+            else if (ys[i + 1] != ys[i])
+            {
+                steps.push_back({xs[i], ys[i + 1] - ys[i]});
+            }
+        }
+        term.rampCount = ramps.size() - term.firstRamp;
+        term.stepCount = steps.size() - term.firstStep;
+        terms.push_back(move(term));
+    }
+}
+
+void KBFuzzifier::fuzzify(const double *x, size_t count, double *degrees) const
+{
+    for (size_t offset = 0; offset < count; offset += BLOCK_SIZE)
+    {
+        size_t n = std::min(BLOCK_SIZE, count - offset);
+        const double *block = x + offset;
+        for (size_t t = 0; t < terms.size(); ++t)
+        {
+            const Term &term = terms[t];
+            double *row = degrees + t * count + offset;
+            kernelFill(row, term.base, n);
+            for (size_t r = term.firstRamp; r < term.firstRamp + term.rampCount; ++r)
+            {
+                kernelRamp(row, block, ramps[r].from, ramps[r].to, ramps[r].slope, n);
+            }
+            for (size_t s = term.firstStep; s < term.firstStep + term.stepCount; ++s)
+            {
+                kernelStep(row, block, steps[s].at, steps[s].jump, n);
+            }
+            if (!term.empty)
+            {
+                kernelUndefined(row, block, n);
+            }
+        }
+    }
+}
+
+vector<double> KBFuzzifier::fuzzify(const vector<double> &x) const
+{
+    vector<double> degrees(terms.size() * x.size());
+    fuzzify(x.data(), x.size(), degrees.data());
+    return degrees;
+}
@@ -0,0 +1,417 @@
+#include "kb_fuzzy_inference.h"
+#include "kb_operation.h"
+#include "kb_reference.h"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+using namespace std;
+
+// Ядра активации правил. Результат записывается на место левого операнда;
+// циклы устроены так же, как ядра kb_batch.cpp, и векторизуются по тем же причинам.
+
+static const double UNDEFINED = numeric_limits<double>::quiet_NaN();
+
+// Неопределенный вход не принадлежит терму
+static void kernelLoad(double *__restrict a, const double *__restrict degree, size_t n)
+{
+    for (size_t i = 0; i < n; ++i)
+    {
+        a[i] = degree[i] != degree[i] ? 0.0 : degree[i];
+    }
+}
+
+static void kernelMin(double *__restrict a, const double *__restrict b, size_t n)
+{
+    for (size_t i = 0; i < n; ++i)
+    {
+        a[i] = a[i] < b[i] ? a[i] : b[i];
+    }
+}
+
+static void kernelMax(double *__restrict a, const double *__restrict b, size_t n)
+{
+    for (size_t i = 0; i < n; ++i)
+    {
+        a[i] = a[i] > b[i] ? a[i] : b[i];
+    }
+}
+
+static void kernelProduct(double *__restrict a, const double *__restrict b, size_t n)
+{
+    for (size_t i = 0; i < n; ++i)
+    {
+        a[i] *= b[i];
+    }
+}
+
+static void kernelProbor(double *__restrict a, const double *__restrict b, size_t n)
+{
+    for (size_t i = 0; i < n; ++i)
+    {
+        a[i] = a[i] + b[i] - a[i] * b[i];
+    }
+}
+
+static void kernelNot(double *__restrict a, size_t n)
+{
+    for (size_t i = 0; i < n; ++i)
+    {
+        a[i] = 1.0 - a[i];
+    }
+}
+
+// Взвешенная сумма выводов Сугено; вывод правила с нулевой активацией не учитывается
+static void kernelWeigh(double *__restrict sum, double *__restrict weight, const double *__restrict w, const double *__restrict z, size_t n)
+{
+    for (size_t i = 0; i < n; ++i)
+    {
+        sum[i] += w[i] > 0.0 ? w[i] * z[i] : 0.0;
+        weight[i] += w[i];
+    }
+}
+
+static uint32_t findTerm(const KBFuzzyType *type, const string &name)
+{
+    const vector<MembershipFunction *> &terms = type->getMembershipFunctionList();
+    for (uint32_t t = 0; t < terms.size(); ++t)
+    {
+        if (terms[t]->name == name)
+        {
+            return t;
+        }
+    }
+    throw invalid_argument("Unknown term " + name + " of fuzzy type " + type->getId());
+}
+
+KBFuzzyInference::KBFuzzyInference(KnowledgeBase &kb) : KBFuzzyInference(kb, Options()) {}
+
+KBFuzzyInference::KBFuzzyInference(KnowledgeBase &kb, const Options &options)
+    : kb(kb), layout(kb.bindReferences()), schemaVersion(kb.getSchemaVersion()), ruleCount(kb.getRules().size()),
+      options(options)
+{
+    for (const KBRule *rule : kb.getRules())
+    {
+        addRule(rule);
+    }
+    // Вычислители ссылаются на программы, поэтому создаются после заполнения programs
+    evaluators.reserve(programs.size());
+    for (const KBProgram &program : programs)
+    {
+        evaluators.emplace_back(program);
+    }
+    degrees.resize(termRows * KBFuzzifier::BLOCK_SIZE);
+    stack.resize(maxDepth * KBFuzzifier::BLOCK_SIZE);
+}
+
+uint32_t KBFuzzyInference::addInput(uint32_t slot)
+{
+    for (uint32_t i = 0; i < inputs.size(); ++i)
+    {
+        if (inputs[i].slot == slot)
+        {
+            return i;
+        }
+    }
+    inputs.push_back({slot, nullptr, 0});
+    return inputs.size() - 1;
+}
+
+uint32_t KBFuzzyInference::addFuzzyInput(uint32_t slot, const KBFuzzyType *type)
+{
+    uint32_t index = addInput(slot);
+    Input &input = inputs[index];
+    if (!input.fuzzifier)
+    {
+        input.fuzzifier.reset(new KBFuzzifier(*type));
+        input.firstRow = termRows;
+        termRows += input.fuzzifier->getTermCount();
+    }
+    return index;
+}
+
+uint32_t KBFuzzyInference::addOutput(uint32_t slot, const KBFuzzyType *type)
+{
+    for (uint32_t o = 0; o < outputs.size(); ++o)
+    {
+        if (outputs[o].slot == slot)
+        {
+            return o;
+        }
+    }
+    outputs.push_back({slot, type ? unique_ptr<KBDefuzzifier>(new KBDefuzzifier(*type, options.implication)) : nullptr});
+    return outputs.size() - 1;
+}
+
+bool KBFuzzyInference::compileCondition(const Evaluatable *node, vector<Instruction> &out,
+                                        vector<pair<const KBReference *, uint32_t>> &atoms) const
+{
+    const KBOperation *op = dynamic_cast<const KBOperation *>(node);
+    if (!op)
+    {
+        return false;
+    }
+    switch (op->getOperator())
+    {
+    case KBOperator::AND:
+    case KBOperator::OR:
+        if (!compileCondition(op->getLeft(), out, atoms) || !compileCondition(op->getRight(), out, atoms))
+        {
+            return false;
+        }
+        out.push_back({op->getOperator() == KBOperator::AND ? AND : OR, 0});
+        return true;
+    case KBOperator::NOT:
+        if (!compileCondition(op->getLeft(), out, atoms))
+        {
+            return false;
+        }
+        out.push_back({NOT, 0});
+        return true;
+    case KBOperator::EQ:
+        break;
+    default:
+        return false;
+    }
+
+    // ОБЪЕКТ.АТРИБУТ == "терм" либо "терм" == ОБЪЕКТ.АТРИБУТ
+    const KBReference *ref = dynamic_cast<const KBReference *>(op->getLeft());
+    const KBSymbolicValue *term = dynamic_cast<const KBSymbolicValue *>(op->getRight());
+    if (!ref || !term)
+    {
+        ref = dynamic_cast<const KBReference *>(op->getRight());
+        term = dynamic_cast<const KBSymbolicValue *>(op->getLeft());
+    }
+    if (!ref || !term)
+    {
+        return false;
+    }
+    const KBFuzzyType *type = dynamic_cast<const KBFuzzyType *>(kb.getReferenceType(ref));
+    if (!type)
+    {
+        return false;
+    }
+    out.push_back({TERM, (uint32_t)atoms.size()});
+    atoms.push_back({ref, findTerm(type, term->getContentAsString())});
+    return true;
+}
+
+bool KBFuzzyInference::addRule(const KBRule *rule)
+{
+    vector<Instruction> condition;
+    vector<pair<const KBReference *, uint32_t>> atoms;
+    if (!rule->getCondition() || !compileCondition(rule->getCondition(), condition, atoms))
+    {
+        return false;
+    }
+
+    uint32_t index = rules.size();
+    size_t depth = 0;
+    for (Instruction &instruction : condition)
+    {
+        if (instruction.code == TERM)
+        {
+            const pair<const KBReference *, uint32_t> &atom = atoms[instruction.arg];
+            const KBFuzzyType *type = static_cast<const KBFuzzyType *>(kb.getReferenceType(atom.first));
+            uint32_t input = addFuzzyInput(layout.require(atom.first), type);
+            instruction.arg = inputs[input].firstRow + atom.second;
+            maxDepth = std::max(maxDepth, ++depth);
+        }
+        else if (instruction.code != NOT)
+        {
+            --depth;
+        }
+    }
+    rules.push_back({rule, code.size(), condition.size()});
+    code.insert(code.end(), condition.begin(), condition.end());
+
+    for (const KBAssign *assign : rule->getInstructions())
+    {
+        uint32_t slot = layout.require(assign->getRef());
+        KBType *type = kb.getReferenceType(assign->getRef());
+        if (const KBFuzzyType *fuzzy = dynamic_cast<const KBFuzzyType *>(type))
+        {
+            const KBSymbolicValue *term = dynamic_cast<const KBSymbolicValue *>(assign->getValue());
+            if (!term)
+            {
+                throw invalid_argument("Fuzzy attribute " + layout.getSlotPath(slot) + " must be assigned a term");
+            }
+            consequents.push_back({index, addOutput(slot, fuzzy), findTerm(fuzzy, term->getContentAsString())});
+        }
+        else if (dynamic_cast<const KBNumericType *>(type))
+        {
+            vector<uint32_t> slots;
+            layout.collectSlots(assign->getValue(), slots);
+            for (uint32_t input : slots)
+            {
+                addInput(input);
+            }
+            programs.push_back(KBProgram::compile(assign->getValue(), layout));
+            consequents.push_back({index, addOutput(slot, nullptr), (uint32_t)programs.size() - 1});
+        }
+        else
+        {
+            throw invalid_argument("Fuzzy rule " + rule->getId() + " assigns non-numeric attribute " + layout.getSlotPath(slot));
+        }
+    }
+    return true;
+}
+
+void KBFuzzyInference::checkCurrent() const
+{
+    if (kb.getSchemaVersion() != schemaVersion || kb.getRules().size() != ruleCount)
+    {
+        throw logic_error("Knowledge base changed after the fuzzy inference was created");
+    }
+}
+
+uint32_t KBFuzzyInference::getInputIndex(const string &path) const
+{
+    uint32_t slot = layout.slot(path);
+    for (uint32_t i = 0; i < inputs.size(); ++i)
+    {
+        if (inputs[i].slot == slot)
+        {
+            return i;
+        }
+    }
+    return NONE;
+}
+
+uint32_t KBFuzzyInference::getOutputIndex(const string &path) const
+{
+    uint32_t slot = layout.slot(path);
+    for (uint32_t o = 0; o < outputs.size(); ++o)
+    {
+        if (outputs[o].slot == slot)
+        {
+            return o;
+        }
+    }
+    return NONE;
+}
+
+void KBFuzzyInference::activateBlock(const double *inputValues, size_t rows, size_t offset, size_t count, double *activations)
+{
+    const size_t width = KBFuzzifier::BLOCK_SIZE;
+    for (size_t i = 0; i < inputs.size(); ++i)
+    {
+        if (inputs[i].fuzzifier)
+        {
+            inputs[i].fuzzifier->fuzzify(inputValues + i * rows + offset, count, degrees.data() + inputs[i].firstRow * count);
+        }
+    }
+    for (size_t r = 0; r < rules.size(); ++r)
+    {
+        size_t top = 0;
+        const Instruction *begin = code.data() + rules[r].firstInstruction;
+        for (const Instruction *instruction = begin; instruction != begin + rules[r].instructionCount; ++instruction)
+        {
+            switch (instruction->code)
+            {
+            case TERM:
+                kernelLoad(stack.data() + top++ * width, degrees.data() + instruction->arg * count, count);
+                break;
+            case AND:
+            {
+                double *a = stack.data() + (--top - 1) * width;
+                options.norm == MIN_MAX ? kernelMin(a, a + width, count) : kernelProduct(a, a + width, count);
+                break;
+            }
+            case OR:
+            {
+                double *a = stack.data() + (--top - 1) * width;
+                options.norm == MIN_MAX ? kernelMax(a, a + width, count) : kernelProbor(a, a + width, count);
+                break;
+            }
+            case NOT:
+                kernelNot(stack.data() + (top - 1) * width, count);
+                break;
+            }
+        }
+        memcpy(activations + r * rows + offset, stack.data(), count * sizeof(double));
+    }
+}
+
+void KBFuzzyInference::activate(const double *inputValues, size_t rows, double *activations)
+{
+    checkCurrent();
+    for (size_t offset = 0; offset < rows; offset += KBFuzzifier::BLOCK_SIZE)
+    {
+        activateBlock(inputValues, rows, offset, std::min(KBFuzzifier::BLOCK_SIZE, rows - offset), activations);
+    }
+}
+
+void KBFuzzyInference::run(const double *inputValues, size_t rows, double *outputValues)
+{
+    vector<double> activations(rules.size() * rows);
+    activate(inputValues, rows, activations.data());
+
+    // Выражения Сугено - пакетно над столбцами входов; остальные слоты не определены
+    vector<double> values(programs.size() * rows);
+    if (!programs.empty())
+    {
+        vector<KBColumn> columns(layout.getSlotCount());
+        for (size_t i = 0; i < inputs.size(); ++i)
+        {
+            columns[inputs[i].slot].values = inputValues + i * rows;
+        }
+        vector<double> belief(rows);
+        for (size_t p = 0; p < programs.size(); ++p)
+        {
+            evaluators[p].run(columns, rows, values.data() + p * rows, belief.data());
+        }
+    }
+
+    vector<double> sum(rows);
+    vector<double> weight(rows);
+    vector<double> alpha;
+    for (size_t o = 0; o < outputs.size(); ++o)
+    {
+        double *out = outputValues + o * rows;
+        const KBDefuzzifier *defuzzifier = outputs[o].defuzzifier.get();
+        if (!defuzzifier)
+        {
+            fill(sum.begin(), sum.end(), 0.0);
+            fill(weight.begin(), weight.end(), 0.0);
+            for (const Consequent &consequent : consequents)
+            {
+                if (consequent.output == o)
+                {
+                    kernelWeigh(sum.data(), weight.data(), activations.data() + consequent.rule * rows, values.data() + consequent.term * rows, rows);
+                }
+            }
+            for (size_t i = 0; i < rows; ++i)
+            {
+                out[i] = weight[i] > 0.0 ? sum[i] / weight[i] : UNDEFINED;
+            }
+            continue;
+        }
+        // Мамдани: активация терма - максимум активаций правил, выводящих этот терм
+        alpha.resize(defuzzifier->getTermCount());
+        for (size_t i = 0; i < rows; ++i)
+        {
+            fill(alpha.begin(), alpha.end(), 0.0);
+            for (const Consequent &consequent : consequents)
+            {
+                if (consequent.output == o)
+                {
+                    alpha[consequent.term] = std::max(alpha[consequent.term], activations[consequent.rule * rows + i]);
+                }
+            }
+            out[i] = defuzzifier->defuzzify(alpha.data(), options.method);
+        }
+    }
+}
+
+vector<double> KBFuzzyInference::infer(const vector<double> &inputValues)
+{
+    if (inputValues.size() != inputs.size())
+    {
+        throw invalid_argument("Input count does not match the fuzzy inference inputs");
+    }
+    vector<double> result(outputs.size());
+    run(inputValues.data(), 1, result.data());
+    return result;
+}
@@ -0,0 +1,178 @@
+#include "kb_incremental.h"
+#include "kb_operation.h"
+#include "kb_reference.h"
+#include <stdexcept>
+
+using namespace std;
+
+KBIncrementalEvaluator::KBIncrementalEvaluator(KnowledgeBase &kb)
+    : kb(kb), layout(kb.bindReferences()), schemaVersion(kb.getSchemaVersion())
+{
+    memory.resize(layout.getSlotCount());
+    slotReferences.resize(layout.getSlotCount());
+    conditions.reserve(kb.getRules().size());
+    for (const KBRule *rule : kb.getRules())
+    {
+        conditions.push_back(rule->getCondition() ? build(rule->getCondition(), NONE) : NONE);
+    }
+}
+
+uint32_t KBIncrementalEvaluator::build(const Evaluatable *node, uint32_t parent)
+{
+    uint32_t index = nodes.size();
+    nodes.emplace_back();
+    Node entry;
+    entry.parent = parent;
+    entry.left = NONE;
+    entry.right = NONE;
+    entry.slot = NONE;
+    entry.code = KBOpCode::PUSH_CONST;
+    entry.with = node->getNonFactorValue();
+    entry.hasWith = !entry.with.isDefault();
+    entry.dirty = true;
+
+    if (const KBValue *value = dynamic_cast<const KBValue *>(node))
+    {
+        entry.kind = CONSTANT;
+        entry.value = KBProgram::constant(value);
+        entry.hasWith = false;
+        entry.dirty = false;
+    }
+    else if (const KBReference *ref = dynamic_cast<const KBReference *>(node))
+    {
+        entry.kind = REFERENCE;
+        entry.code = KBOpCode::LOAD_REF;
+        entry.slot = layout.resolve(ref);
+        if (entry.slot != NONE)
+        {
+            slotReferences[entry.slot].push_back(index);
+        }
+    }
+    else if (const KBOperation *op = dynamic_cast<const KBOperation *>(node))
+    {
+        entry.kind = OPERATION;
+        entry.code = KBProgram::opCode(op);
+        entry.left = build(op->getLeft(), index);
+        if (op->isBinary())
+        {
+            entry.right = build(op->getRight(), index);
+        }
+    }
+    else
+    {
+        throw invalid_argument("Unsupported evaluatable: " + node->getTag());
+    }
+    nodes[index] = entry;
+    return index;
+}
+
+void KBIncrementalEvaluator::checkCurrent() const
+{
+    if (kb.getSchemaVersion() != schemaVersion || kb.getRules().size() != conditions.size())
+    {
+        throw logic_error("Knowledge base changed after the incremental evaluator was created");
+    }
+}
+
+void KBIncrementalEvaluator::markDirty(uint32_t node)
+{
+    // Предки устаревшего узла уже устаревшие, поэтому подъем можно остановить на первом из них
+    while (node != NONE && !nodes[node].dirty)
+    {
+        nodes[node].dirty = true;
+        node = nodes[node].parent;
+    }
+}
+
+const KBEvalValue &KBIncrementalEvaluator::compute(uint32_t node)
+{
+    Node &entry = nodes[node];
+    if (!entry.dirty)
+    {
+        return entry.value;
+    }
+    switch (entry.kind)
+    {
+    case REFERENCE:
+        entry.value = entry.slot != NONE ? memory[entry.slot] : KBEvalValue();
+        break;
+    case OPERATION:
+        if (entry.right == NONE)
+        {
+            entry.value = evalUnary(entry.code, compute(entry.left));
+        }
+        else
+        {
+            const KBEvalValue &left = compute(entry.left);
+            entry.value = evalBinary(entry.code, left, compute(entry.right));
+        }
+        break;
+    default:
+        break;
+    }
+    if (entry.hasWith)
+    {
+        entry.value.nonFactor = applyNonFactor(entry.value.nonFactor, entry.with);
+    }
+    entry.dirty = false;
+    ++recomputed;
+    return entry.value;
+}
+
+bool KBIncrementalEvaluator::set(uint32_t slot, const KBEvalValue &value)
+{
+    checkCurrent();
+    if (slot >= memory.size())
+    {
+        throw out_of_range("Slot " + to_string(slot) + " is out of range");
+    }
+    if (memory[slot] == value)
+    {
+        return false;
+    }
+    memory[slot] = value;
+    for (uint32_t node : slotReferences[slot])
+    {
+        markDirty(node);
+    }
+    return true;
+}
+
+bool KBIncrementalEvaluator::set(KBSymbol object, KBSymbol property, const KBEvalValue &value)
+{
+    checkCurrent();
+    uint32_t slot = layout.slot(object, property);
+    if (slot == KBSlotLayout::NONE)
+    {
+        throw invalid_argument("Unknown attribute " + object.str() + "." + property.str());
+    }
+    return set(slot, value);
+}
+
+bool KBIncrementalEvaluator::set(const string &path, const KBEvalValue &value)
+{
+    checkCurrent();
+    uint32_t slot = layout.slot(path);
+    if (slot == KBSlotLayout::NONE)
+    {
+        throw invalid_argument("Unknown attribute " + path);
+    }
+    return set(slot, value);
+}
+
+KBEvalValue KBIncrementalEvaluator::evaluateCondition(uint32_t rule)
+{
+    checkCurrent();
+    uint32_t root = conditions.at(rule);
+    return root != NONE ? compute(root) : KBEvalValue::fromBoolean(true, {100.0, 100.0, 0.0});
+}
+
+KBEvalValue KBIncrementalEvaluator::evaluateCondition(const KBRule *rule)
+{
+    uint32_t index = kb.getRuleIndex(rule->getIdSymbol());
+    if (index == KBSymbolIndex::NOT_FOUND || kb.getRules()[index] != rule)
+    {
+        throw invalid_argument("Rule " + rule->getId() + " does not belong to the knowledge base");
+    }
+    return evaluateCondition(index);
+}
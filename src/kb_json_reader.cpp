@@ -0,0 +1,680 @@
+#include "kb_json_reader.h"
+#include "utils.h"
+#include <memory>
+#include <stdexcept>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+
+KBJSONReader::KBJSONReader(const string &json) : buffer(json)
+{
+    open(buffer.data(), buffer.size());
+}
+
+KBJSONReader *KBJSONReader::fromFile(const string &path)
+{
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        throw runtime_error("Couldn't open json file " + path);
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0)
+    {
+        close(fd);
+        throw runtime_error("Couldn't read json file " + path);
+    }
+    void *data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+    {
+        throw runtime_error("Couldn't map json file " + path);
+    }
+    madvise(data, st.st_size, MADV_SEQUENTIAL);
+
+    KBJSONReader *result = new KBJSONReader();
+    result->mapped = data;
+    result->mappedSize = st.st_size;
+    result->open(static_cast<const char *>(data), st.st_size);
+    return result;
+}
+
+KBJSONReader::~KBJSONReader()
+{
+    if (mapped)
+    {
+        munmap(mapped, mappedSize);
+    }
+}
+
+void KBJSONReader::open(const char *data, size_t size)
+{
+    begin = data;
+    pos = data;
+    end = data + size;
+}
+
+void KBJSONReader::error(const string &message) const
+{
+    throw runtime_error("JSON error at offset " + to_string(pos - begin) + ": " + message);
+}
+
+// Пропускает пробелы и возвращает следующий символ, не потребляя его; '\0' - конец текста
+char KBJSONReader::peek()
+{
+    while (pos < end && (*pos == ' ' || *pos == '\t' || *pos == '\n' || *pos == '\r'))
+    {
+        ++pos;
+    }
+    return pos < end ? *pos : '\0';
+}
+
+void KBJSONReader::expect(char c)
+{
+    if (peek() != c)
+    {
+        error(string("expected '") + c + "'");
+    }
+    ++pos;
+}
+
+void KBJSONReader::expectWord(const char *word)
+{
+    for (const char *c = word; *c; ++c, ++pos)
+    {
+        if (pos >= end || *pos != *c)
+        {
+            error(string("expected ") + word);
+        }
+    }
+}
+
+bool KBJSONReader::atEnd()
+{
+    return peek() == '\0';
+}
+
+void KBJSONReader::expectEnd()
+{
+    if (!atEnd())
+    {
+        error("unexpected data after value");
+    }
+}
+
+static int hexDigit(char c)
+{
+    if (c >= '0' && c <= '9')
+    {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f')
+    {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F')
+    {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+static void appendUTF8(string &out, uint32_t code)
+{
+    if (code < 0x80)
+    {
+        out += static_cast<char>(code);
+    }
+    else if (code < 0x800)
+    {
+        out += static_cast<char>(0xC0 | (code >> 6));
+        out += static_cast<char>(0x80 | (code & 0x3F));
+    }
+    else if (code < 0x10000)
+    {
+        out += static_cast<char>(0xE0 | (code >> 12));
+        out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (code & 0x3F));
+    }
+    else
+    {
+        out += static_cast<char>(0xF0 | (code >> 18));
+        out += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (code & 0x3F));
+    }
+}
+
+// Строка без escape-последовательностей возвращается как срез исходного текста,
+// иначе раскодируется в scratch. Результат действителен до следующего чтения строки.
+string_view KBJSONReader::readStringView()
+{
+    expect('"');
+    const char *start = pos;
+    while (pos < end && *pos != '"' && *pos != '\\')
+    {
+        ++pos;
+    }
+    if (pos >= end)
+    {
+        error("unterminated string");
+    }
+    if (*pos == '"')
+    {
+        return string_view(start, pos++ - start);
+    }
+
+    scratch.assign(start, pos);
+    auto readHex = [this]()
+    {
+        if (end - pos < 4)
+        {
+            error("invalid unicode escape");
+        }
+        uint32_t code = 0;
+        for (int i = 0; i < 4; ++i)
+        {
+            int digit = hexDigit(*pos++);
+            if (digit < 0)
+            {
+                error("invalid unicode escape");
+            }
+            code = (code << 4) | digit;
+        }
+        return code;
+    };
+    while (true)
+    {
+        if (pos >= end)
+        {
+            error("unterminated string");
+        }
+        char c = *pos++;
+        if (c == '"')
+        {
+            return scratch;
+        }
+        if (c != '\\')
+        {
+            scratch += c;
+            continue;
+        }
+        if (pos >= end)
+        {
+            error("unterminated string");
+        }
+        switch (*pos++)
+        {
+        case '"':
+            scratch += '"';
+            break;
+        case '\\':
+            scratch += '\\';
+            break;
+        case '/':
+            scratch += '/';
+            break;
+        case 'b':
+            scratch += '\b';
+            break;
+        case 'f':
+            scratch += '\f';
+            break;
+        case 'n':
+            scratch += '\n';
+            break;
+        case 'r':
+            scratch += '\r';
+            break;
+        case 't':
+            scratch += '\t';
+            break;
+        case 'u':
+        {
+            uint32_t code = readHex();
+            if (code >= 0xD800 && code <= 0xDBFF)
+            {
+                if (end - pos < 2 || pos[0] != '\\' || pos[1] != 'u')
+                {
+                    error("unpaired surrogate");
+                }
+                pos += 2;
+                uint32_t low = readHex();
+                if (low < 0xDC00 || low > 0xDFFF)
+                {
+                    error("unpaired surrogate");
+                }
+                code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+            }
+            else if (code >= 0xDC00 && code <= 0xDFFF)
+            {
+                error("unpaired surrogate");
+            }
+            appendUTF8(scratch, code);
+            break;
+        }
+        default:
+            --pos;
+            error("invalid escape");
+        }
+    }
+}
+
+string KBJSONReader::readString()
+{
+    return string(readStringView());
+}
+
+double KBJSONReader::readNumber()
+{
+    peek();
+    const char *start = pos;
+    while (pos < end && ((*pos >= '0' && *pos <= '9') || *pos == '-' || *pos == '+' || *pos == '.' || *pos == 'e' || *pos == 'E'))
+    {
+        ++pos;
+    }
+    double value = 0.0;
+    if (start == pos || !tryParseDouble(string_view(start, pos - start), value))
+    {
+        pos = start;
+        error("expected number");
+    }
+    return value;
+}
+
+bool KBJSONReader::readBool()
+{
+    if (peek() == 't')
+    {
+        expectWord("true");
+        return true;
+    }
+    expectWord("false");
+    return false;
+}
+
+bool KBJSONReader::readNull()
+{
+    if (peek() != 'n')
+    {
+        return false;
+    }
+    expectWord("null");
+    return true;
+}
+
+void KBJSONReader::skipValue()
+{
+    switch (peek())
+    {
+    case '{':
+        readObject([this](string_view)
+                   { skipValue(); });
+        break;
+    case '[':
+        readArray([this]()
+                  { skipValue(); });
+        break;
+    case '"':
+        readStringView();
+        break;
+    case 't':
+    case 'f':
+        readBool();
+        break;
+    case 'n':
+        readNull();
+        break;
+    default:
+        readNumber();
+    }
+}
+
+void KBJSONReader::readObject(const function<void(string_view key)> &onMember)
+{
+    expect('{');
+    if (peek() == '}')
+    {
+        ++pos;
+        return;
+    }
+    while (true)
+    {
+        string_view key = readStringView();
+        expect(':');
+        onMember(key);
+        char c = peek();
+        ++pos;
+        if (c == '}')
+        {
+            return;
+        }
+        if (c != ',')
+        {
+            --pos;
+            error("expected ',' or '}'");
+        }
+    }
+}
+
+void KBJSONReader::readArray(const function<void()> &onElement)
+{
+    expect('[');
+    if (peek() == ']')
+    {
+        ++pos;
+        return;
+    }
+    while (true)
+    {
+        onElement();
+        char c = peek();
+        ++pos;
+        if (c == ']')
+        {
+            return;
+        }
+        if (c != ',')
+        {
+            --pos;
+            error("expected ',' or ']'");
+        }
+    }
+}
+
+void KBJSONReader::forEachElement(const function<void(KBJSONReader &)> &handler)
+{
+    readArray([&]()
+              { handler(*this); });
+}
+
+KBType *KBJSONReader::readType()
+{
+    string id, meta, desc;
+    bool hasDesc = false;
+    double from = 0.0, to = 0.0;
+    vector<string> values;
+    vector<unique_ptr<MembershipFunction>> mfs;
+    readObject([&](string_view key)
+               {
+        if (key == "id")
+        {
+            id = readString();
+        }
+        else if (key == "meta")
+        {
+            meta = readString();
+        }
+        else if (key == "desc")
+        {
+            hasDesc = !readNull();
+            if (hasDesc)
+            {
+                desc = readString();
+            }
+        }
+        else if (key == "from")
+        {
+            from = readNumber();
+        }
+        else if (key == "to")
+        {
+            to = readNumber();
+        }
+        else if (key == "values")
+        {
+            readArray([&]()
+                      { values.push_back(readString()); });
+        }
+        else if (key == "membership_functions")
+        {
+            readArray([&]()
+                      { mfs.emplace_back(readMembershipFunction()); });
+        }
+        else
+        {
+            skipValue();
+        } });
+
+    const char *descStr = hasDesc ? desc.c_str() : nullptr;
+    if (meta == "numeric" || meta == "number")
+    {
+        return new KBNumericType(KBSymbol(id), from, to, descStr);
+    }
+    if (meta == "string" || meta == "symbolic")
+    {
+        return new KBSymbolicType(KBSymbol(id), values, descStr);
+    }
+    if (meta == "fuzzy")
+    {
+        vector<MembershipFunction *> list;
+        for (const auto &mf : mfs)
+        {
+            list.push_back(mf.get());
+        }
+        return new KBFuzzyType(KBSymbol(id), list, descStr);
+    }
+    if (meta.empty() || meta == "abstract")
+    {
+        return new KBType(KBSymbol(id), descStr);
+    }
+    throw runtime_error("Unknown type meta: " + meta);
+}
+
+// Выражение определяется по набору полей: "sign" - операция, "content" - значение, "id" - ссылка
+Evaluatable *KBJSONReader::readEvaluatable()
+{
+    enum class Content
+    {
+        NONE,
+        STRING,
+        NUMBER,
+        BOOLEAN
+    };
+    unique_ptr<Evaluatable> left, right;
+    unique_ptr<KBReference> ref;
+    unique_ptr<NonFactor> nonFactor;
+    string id, sign, text;
+    bool hasId = false;
+    Content content = Content::NONE;
+    double number = 0.0;
+    bool flag = false;
+    readObject([&](string_view key)
+               {
+        if (key == "left")
+        {
+            left.reset(readEvaluatable());
+        }
+        else if (key == "right")
+        {
+            right.reset(readEvaluatable());
+        }
+        else if (key == "ref")
+        {
+            ref.reset(readReference());
+        }
+        else if (key == "non_factor")
+        {
+            nonFactor.reset(readNonFactor());
+        }
+        else if (key == "id")
+        {
+            id = readString();
+            hasId = true;
+        }
+        else if (key == "sign")
+        {
+            sign = readString();
+        }
+        else if (key == "content")
+        {
+            char c = peek();
+            if (c == '"')
+            {
+                content = Content::STRING;
+                text = readString();
+            }
+            else if (c == 't' || c == 'f')
+            {
+                content = Content::BOOLEAN;
+                flag = readBool();
+            }
+            else
+            {
+                content = Content::NUMBER;
+                number = readNumber();
+            }
+        }
+        else
+        {
+            skipValue();
+        } });
+
+    if (!sign.empty())
+    {
+        KBOperator op;
+        if (!left || !parseOperatorSign(sign, right != nullptr, op))
+        {
+            throw invalid_argument("Unknown operation: " + sign);
+        }
+        Evaluatable *rightOperand = right.release();
+        return new KBOperation(sign, left.release(), rightOperand, nonFactor.get());
+    }
+    switch (content)
+    {
+    case Content::STRING:
+        return new KBSymbolicValue(KBSymbol(text), nonFactor.get());
+    case Content::NUMBER:
+        return new KBNumericValue(number, nonFactor.get());
+    case Content::BOOLEAN:
+        return new KBBooleanValue(flag, nonFactor.get());
+    case Content::NONE:
+        break;
+    }
+    if (hasId)
+    {
+        return new KBReference(KBSymbol(id), ref.release(), nonFactor.get());
+    }
+    throw runtime_error("JSON object is not an expression");
+}
+
+template <typename T>
+static T *expectKind(Evaluatable *evaluatable, const char *kind)
+{
+    T *result = dynamic_cast<T *>(evaluatable);
+    if (!result)
+    {
+        delete evaluatable;
+        throw runtime_error(string("Expected ") + kind + " in JSON");
+    }
+    return result;
+}
+
+KBReference *KBJSONReader::readReference()
+{
+    return expectKind<KBReference>(readEvaluatable(), "reference");
+}
+
+KBOperation *KBJSONReader::readOperation()
+{
+    return expectKind<KBOperation>(readEvaluatable(), "operation");
+}
+
+KBValue *KBJSONReader::readValue()
+{
+    return expectKind<KBValue>(readEvaluatable(), "value");
+}
+
+NonFactor *KBJSONReader::readNonFactor()
+{
+    double belief = 50.0, probability = 100.0, accuracy = 0.0;
+    if (readNull())
+    {
+        return new NonFactor();
+    }
+    // Атрибут non_factor значений записывается строкой с JSON коэффициента
+    if (peek() == '"')
+    {
+        KBJSONReader inner(readString());
+        return inner.readNonFactor();
+    }
+    readObject([&](string_view key)
+               {
+        if (key == "belief")
+        {
+            belief = readNumber();
+        }
+        else if (key == "probability")
+        {
+            probability = readNumber();
+        }
+        else if (key == "accuracy")
+        {
+            accuracy = readNumber();
+        }
+        else
+        {
+            skipValue();
+        } });
+    return new NonFactor(belief, probability, accuracy);
+}
+
+MembershipFunction *KBJSONReader::readMembershipFunction()
+{
+    string name;
+    double min = 0.0, max = 0.0;
+    vector<unique_ptr<MFPoint>> points;
+    readObject([&](string_view key)
+               {
+        if (key == "name")
+        {
+            name = readString();
+        }
+        else if (key == "min")
+        {
+            min = readNumber();
+        }
+        else if (key == "max")
+        {
+            max = readNumber();
+        }
+        else if (key == "points")
+        {
+            readArray([&]()
+                      { points.emplace_back(readPoint()); });
+        }
+        else
+        {
+            skipValue();
+        } });
+    vector<MFPoint *> list;
+    for (const auto &point : points)
+    {
+        list.push_back(point.get());
+    }
+    return new MembershipFunction(name, min, max, list);
+}
+
+MFPoint *KBJSONReader::readPoint()
+{
+    double x = 0.0, y = 0.0;
+    readObject([&](string_view key)
+               {
+        if (key == "x")
+        {
+            x = readNumber();
+        }
+        else if (key == "y")
+        {
+            y = readNumber();
+        }
+        else
+        {
+            skipValue();
+        } });
+    return new MFPoint(x, y);
+}
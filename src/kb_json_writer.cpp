@@ -0,0 +1,219 @@
+#include "kb_json_writer.h"
+#include "kb_entity.h"
+#include "utils.h"
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <unistd.h>
+
+using namespace std;
+
+KBJSONWriter::KBJSONWriter(int fd, size_t bufferSize) : fd(fd), flushThreshold(bufferSize)
+{
+    buffer.reserve(bufferSize + bufferSize / 4);
+}
+
+KBJSONWriter::~KBJSONWriter()
+{
+    if (fd >= 0)
+    {
+        try
+        {
+            flush();
+        }
+        catch (...)
+        {
+        }
+    }
+}
+
+void KBJSONWriter::flush()
+{
+    if (fd < 0)
+    {
+        return;
+    }
+    const char *data = buffer.data();
+    size_t left = buffer.size();
+    while (left > 0)
+    {
+        ssize_t written = ::write(fd, data, left);
+        if (written < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            throw runtime_error(string("Couldn't write json: ") + strerror(errno));
+        }
+        data += written;
+        left -= written;
+    }
+    buffer.clear();
+}
+
+void KBJSONWriter::maybeFlush()
+{
+    if (fd >= 0 && buffer.size() >= flushThreshold)
+    {
+        flush();
+    }
+}
+
+void KBJSONWriter::beforeValue()
+{
+    if (afterKey)
+    {
+        afterKey = false;
+        return;
+    }
+    if (!nonEmpty.empty())
+    {
+        if (nonEmpty.back())
+        {
+            buffer += ',';
+        }
+        nonEmpty.back() = true;
+    }
+}
+
+void KBJSONWriter::escape(string_view value)
+{
+    static const char HEX[] = "0123456789abcdef";
+    buffer += '"';
+    size_t plain = 0;
+    for (size_t i = 0; i < value.size(); ++i)
+    {
+        unsigned char c = value[i];
+        if (c >= 0x20 && c != '"' && c != '\\')
+        {
+            continue;
+        }
+        buffer.append(value.data() + plain, i - plain);
+        plain = i + 1;
+        switch (c)
+        {
+        case '"':
+            buffer += "\\\"";
+            break;
+        case '\\':
+            buffer += "\\\\";
+            break;
+        case '\b':
+            buffer += "\\b";
+            break;
+        case '\f':
+            buffer += "\\f";
+            break;
+        case '\n':
+            buffer += "\\n";
+            break;
+        case '\r':
+            buffer += "\\r";
+            break;
+        case '\t':
+            buffer += "\\t";
+            break;
+        default:
+            buffer += "\\u00";
+            buffer += HEX[c >> 4];
+            buffer += HEX[c & 0xf];
+        }
+    }
+    buffer.append(value.data() + plain, value.size() - plain);
+    buffer += '"';
+}
+
+void KBJSONWriter::startObject()
+{
+    beforeValue();
+    buffer += '{';
+    nonEmpty.push_back(false);
+}
+
+void KBJSONWriter::endObject()
+{
+    if (nonEmpty.empty() || afterKey)
+    {
+        throw logic_error("Unbalanced JSON object");
+    }
+    nonEmpty.pop_back();
+    buffer += '}';
+}
+
+void KBJSONWriter::startArray()
+{
+    beforeValue();
+    buffer += '[';
+    nonEmpty.push_back(false);
+}
+
+void KBJSONWriter::endArray()
+{
+    if (nonEmpty.empty() || afterKey)
+    {
+        throw logic_error("Unbalanced JSON array");
+    }
+    nonEmpty.pop_back();
+    buffer += ']';
+}
+
+void KBJSONWriter::key(string_view name)
+{
+    if (nonEmpty.empty() || afterKey)
+    {
+        throw logic_error("JSON key outside of object");
+    }
+    beforeValue();
+    escape(name);
+    buffer += ':';
+    afterKey = true;
+}
+
+void KBJSONWriter::value(string_view value)
+{
+    beforeValue();
+    escape(value);
+}
+
+// Как jsoncpp: у целых значений остается ".0", чтобы при чтении число осталось вещественным;
+// бесконечности и NaN не представимы в JSON
+void KBJSONWriter::value(double value)
+{
+    beforeValue();
+    if (std::isnan(value))
+    {
+        buffer += "null";
+        return;
+    }
+    if (std::isinf(value))
+    {
+        buffer += value < 0 ? "-1e+9999" : "1e+9999";
+        return;
+    }
+    size_t start = buffer.size();
+    appendDouble(buffer, value);
+    if (buffer.find_first_of(".e", start) == string::npos)
+    {
+        buffer += ".0";
+    }
+}
+
+void KBJSONWriter::value(bool value)
+{
+    beforeValue();
+    buffer += value ? "true" : "false";
+}
+
+void KBJSONWriter::null()
+{
+    beforeValue();
+    buffer += "null";
+}
+
+void KBJSONWriter::write(const KBEntity &entity)
+{
+    entity.writeJSON(*this);
+    maybeFlush();
+}
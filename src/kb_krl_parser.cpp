@@ -0,0 +1,556 @@
+#include "kb_krl_parser.h"
+#include "utils.h"
+#include <cstring>
+#include <memory>
+
+using namespace std;
+
+// Приоритеты бинарных операций (больше - связывает сильнее), индекс - KBOperator
+static constexpr int PRECEDENCE[] = {
+    3, 3, 3, 3, 3, 3, // eq gt ge lt le ne
+    2, 1, 0, 1,       // and or not xor
+    0, 4, 4, 5, 5, 5, // neg add sub mul div mod
+    6,                // pow
+};
+
+static_assert(sizeof(PRECEDENCE) / sizeof(PRECEDENCE[0]) == KB_OPERATORS_COUNT, "PRECEDENCE must cover all operators");
+
+static bool isIdentStart(unsigned char c)
+{
+    // Байты >= 0x80 - части многобайтовых символов UTF-8 (кириллица)
+    return c >= 0x80 || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+}
+
+static bool isIdentPart(unsigned char c)
+{
+    return isIdentStart(c) || (c >= '0' && c <= '9');
+}
+
+static bool isDigit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+KBKRLParser::KBKRLParser(string_view text) : text(text)
+{
+    advance();
+}
+
+void KBKRLParser::fail(const string &message) const
+{
+    fail(message, current);
+}
+
+void KBKRLParser::fail(const string &message, const Token &token) const
+{
+    throw KRLSyntaxError(message, token.line, token.column);
+}
+
+KBKRLParser::Token KBKRLParser::lex()
+{
+    while (pos < text.size())
+    {
+        char c = text[pos];
+        if (c == '\n')
+        {
+            ++line;
+            lineStart = pos + 1;
+        }
+        else if (c != ' ' && c != '\t' && c != '\r')
+        {
+            break;
+        }
+        ++pos;
+    }
+
+    Token token;
+    token.offset = pos;
+    token.line = line;
+    token.column = pos - lineStart + 1;
+    if (pos >= text.size())
+    {
+        return token;
+    }
+
+    size_t start = pos;
+    char c = text[pos];
+    if (isIdentStart(c))
+    {
+        while (pos < text.size() && isIdentPart(text[pos]))
+        {
+            ++pos;
+        }
+        token.kind = TokenKind::IDENT;
+    }
+    else if (isDigit(c) || (c == '.' && pos + 1 < text.size() && isDigit(text[pos + 1])))
+    {
+        while (pos < text.size() && isDigit(text[pos]))
+        {
+            ++pos;
+        }
+        if (pos < text.size() && text[pos] == '.')
+        {
+            ++pos;
+            while (pos < text.size() && isDigit(text[pos]))
+            {
+                ++pos;
+            }
+        }
+        if (pos < text.size() && (text[pos] == 'e' || text[pos] == 'E'))
+        {
+            size_t exponent = pos + 1;
+            if (exponent < text.size() && (text[exponent] == '+' || text[exponent] == '-'))
+            {
+                ++exponent;
+            }
+            if (exponent < text.size() && isDigit(text[exponent]))
+            {
+                pos = exponent;
+                while (pos < text.size() && isDigit(text[pos]))
+                {
+                    ++pos;
+                }
+            }
+        }
+        token.kind = TokenKind::NUMBER;
+    }
+    else if (c == '"')
+    {
+        size_t end = text.find_first_of("\"\n", pos + 1);
+        if (end == string_view::npos || text[end] != '"')
+        {
+            fail("Unterminated string", token);
+        }
+        token.kind = TokenKind::STRING;
+        token.text = text.substr(pos + 1, end - pos - 1);
+        pos = end + 1;
+        return token;
+    }
+    else
+    {
+        static const char *const TWO_CHAR_SIGNS[] = {"==", "!=", "<>", ">=", "<=", "&&", "||", "**"};
+        token.kind = TokenKind::SIGN;
+        for (const char *sign : TWO_CHAR_SIGNS)
+        {
+            if (text.compare(pos, 2, sign) == 0)
+            {
+                pos += 2;
+                token.text = text.substr(start, 2);
+                return token;
+            }
+        }
+        ++pos;
+        switch (c)
+        {
+        case '(':
+            token.kind = TokenKind::LPAREN;
+            break;
+        case ')':
+            token.kind = TokenKind::RPAREN;
+            break;
+        case '[':
+            token.kind = TokenKind::LBRACKET;
+            break;
+        case ']':
+            token.kind = TokenKind::RBRACKET;
+            break;
+        case '{':
+            token.kind = TokenKind::LBRACE;
+            break;
+        case '}':
+            token.kind = TokenKind::RBRACE;
+            break;
+        case ';':
+            token.kind = TokenKind::SEMICOLON;
+            break;
+        case '.':
+            token.kind = TokenKind::DOT;
+            break;
+        default:
+            if (!strchr("=<>!~&|+-*/%^", c))
+            {
+                fail(string("Unexpected character '") + c + "'", token);
+            }
+        }
+    }
+    token.text = text.substr(start, pos - start);
+    return token;
+}
+
+KBKRLParser::Token KBKRLParser::peekNext()
+{
+    size_t savedPos = pos, savedLine = line, savedLineStart = lineStart;
+    Token next = lex();
+    pos = savedPos;
+    line = savedLine;
+    lineStart = savedLineStart;
+    return next;
+}
+
+bool KBKRLParser::isKeyword(string_view keyword) const
+{
+    return current.kind == TokenKind::IDENT && current.text == keyword;
+}
+
+void KBKRLParser::expect(TokenKind kind, const char *what)
+{
+    if (current.kind != kind)
+    {
+        fail(string("Expected ") + what);
+    }
+    advance();
+}
+
+void KBKRLParser::expectKeyword(string_view keyword)
+{
+    if (!isKeyword(keyword))
+    {
+        fail("Expected " + string(keyword));
+    }
+    advance();
+}
+
+// Текст от текущей лексемы (не включая ее) до конца строки
+string KBKRLParser::restOfLine()
+{
+    size_t end = text.find('\n', pos);
+    if (end == string_view::npos)
+    {
+        end = text.size();
+    }
+    string_view value = text.substr(pos, end - pos);
+    size_t first = value.find_first_not_of(" \t\r");
+    size_t last = value.find_last_not_of(" \t\r");
+    pos = end;
+    advance();
+    return first == string_view::npos ? string() : string(value.substr(first, last - first + 1));
+}
+
+double KBKRLParser::parseNumber()
+{
+    bool negative = false;
+    if (current.kind == TokenKind::SIGN && (current.text == "-" || current.text == "+"))
+    {
+        negative = current.text == "-";
+        advance();
+    }
+    // inf и nan допускаются, так как их выводит форматирование чисел
+    bool special = current.kind == TokenKind::IDENT && (current.text == "inf" || current.text == "nan");
+    if (current.kind != TokenKind::NUMBER && !special)
+    {
+        fail("Expected number");
+    }
+    double value = 0.0;
+    if (!tryParseDouble(current.text, value))
+    {
+        fail("Invalid number " + string(current.text));
+    }
+    advance();
+    return negative ? -value : value;
+}
+
+void KBKRLParser::expectEnd() const
+{
+    if (!atEnd())
+    {
+        fail("Unexpected " + string(current.text));
+    }
+}
+
+// Типы
+
+KBType *KBKRLParser::parseType()
+{
+    expectKeyword("ТИП");
+    if (current.kind != TokenKind::IDENT && current.kind != TokenKind::NUMBER)
+    {
+        fail("Expected type name");
+    }
+    Token idToken = current;
+    string id(current.text);
+    advance();
+
+    if (current.kind != TokenKind::IDENT)
+    {
+        fail("Expected type kind");
+    }
+    string_view kind = current.text;
+    advance();
+
+    unique_ptr<KBType> type;
+    if (kind == "ЧИСЛО")
+    {
+        double from = 0.0, to = 0.0;
+        if (isKeyword("ОТ"))
+        {
+            advance();
+            from = parseNumber();
+        }
+        if (isKeyword("ДО"))
+        {
+            advance();
+            to = parseNumber();
+        }
+        type.reset(new KBNumericType(id, from, to));
+    }
+    else if (kind == "СИМВОЛ")
+    {
+        vector<string> values;
+        while (current.kind == TokenKind::STRING)
+        {
+            values.emplace_back(current.text);
+            advance();
+        }
+        type.reset(new KBSymbolicType(id, values));
+    }
+    else if (kind == "НЕЧЕТКИЙ")
+    {
+        vector<MembershipFunction *> mfs;
+        try
+        {
+            size_t count = current.kind == TokenKind::NUMBER ? (size_t)parseNumber() : 0;
+            for (size_t i = 0; i < count || current.kind == TokenKind::STRING; ++i)
+            {
+                mfs.push_back(parseMembershipFunction());
+            }
+        }
+        catch (...)
+        {
+            for (MembershipFunction *mf : mfs)
+            {
+                delete mf;
+            }
+            throw;
+        }
+        type.reset(new KBFuzzyType(id, mfs));
+        for (MembershipFunction *mf : mfs)
+        {
+            delete mf;
+        }
+    }
+    else if (kind == "АБСТРАКТНЫЙ")
+    {
+        type.reset(new KBType(id));
+    }
+    else
+    {
+        fail("Unknown type kind " + string(kind), idToken);
+    }
+
+    if (isKeyword("КОММЕНТАРИЙ"))
+    {
+        // Комментарий, совпадающий с именем, KRL() выводит для типа без описания
+        string comment = restOfLine();
+        if (comment != id)
+        {
+            type->setDesc(comment.c_str());
+        }
+    }
+    return type.release();
+}
+
+vector<KBType *> KBKRLParser::parseTypes()
+{
+    vector<KBType *> types;
+    try
+    {
+        while (!atEnd())
+        {
+            types.push_back(parseType());
+        }
+    }
+    catch (...)
+    {
+        for (KBType *type : types)
+        {
+            delete type;
+        }
+        throw;
+    }
+    return types;
+}
+
+// "имя" min max n ={x|y; x|y}
+MembershipFunction *KBKRLParser::parseMembershipFunction()
+{
+    if (current.kind != TokenKind::STRING)
+    {
+        fail("Expected membership function name");
+    }
+    string name(current.text);
+    advance();
+    double min = parseNumber();
+    double max = parseNumber();
+    parseNumber();
+    if (current.kind != TokenKind::SIGN || current.text != "=")
+    {
+        fail("Expected =");
+    }
+    advance();
+    expect(TokenKind::LBRACE, "{");
+
+    vector<MFPoint> points;
+    while (current.kind != TokenKind::RBRACE)
+    {
+        if (!points.empty())
+        {
+            expect(TokenKind::SEMICOLON, ";");
+        }
+        double x = parseNumber();
+        if (current.kind != TokenKind::SIGN || current.text != "|")
+        {
+            fail("Expected |");
+        }
+        advance();
+        double y = parseNumber();
+        points.emplace_back(x, y);
+    }
+    advance();
+
+    vector<MFPoint *> pointers;
+    pointers.reserve(points.size());
+    for (MFPoint &point : points)
+    {
+        pointers.push_back(&point);
+    }
+    return new MembershipFunction(name, min, max, pointers);
+}
+
+// Выражения
+
+NonFactor *KBKRLParser::parseNonFactor()
+{
+    expectKeyword("УВЕРЕННОСТЬ");
+    expect(TokenKind::LBRACKET, "[");
+    double belief = parseNumber();
+    expect(TokenKind::SEMICOLON, ";");
+    double probability = parseNumber();
+    expect(TokenKind::RBRACKET, "]");
+    double accuracy = 0.0;
+    if (isKeyword("ТОЧНОСТЬ"))
+    {
+        advance();
+        accuracy = parseNumber();
+    }
+    return new NonFactor(belief, probability, accuracy);
+}
+
+Evaluatable *KBKRLParser::parseExpression()
+{
+    unique_ptr<Evaluatable> result(parseBinary(1));
+    if (isKeyword("УВЕРЕННОСТЬ"))
+    {
+        unique_ptr<NonFactor> nonFactor(parseNonFactor());
+        result->setNonFactor(nonFactor.get());
+        result->setConvertNonFactor(true);
+    }
+    return result.release();
+}
+
+bool KBKRLParser::parseBinaryOperator(KBOperator &op)
+{
+    if (current.kind != TokenKind::SIGN && current.kind != TokenKind::IDENT)
+    {
+        return false;
+    }
+    return parseOperatorSign(string(current.text), true, op);
+}
+
+Evaluatable *KBKRLParser::parseBinary(int minPrecedence)
+{
+    unique_ptr<Evaluatable> left(parseUnary());
+    KBOperator op;
+    while (parseBinaryOperator(op) && PRECEDENCE[static_cast<size_t>(op)] >= minPrecedence)
+    {
+        int precedence = PRECEDENCE[static_cast<size_t>(op)];
+        advance();
+        // Возведение в степень правоассоциативно
+        unique_ptr<Evaluatable> right(parseBinary(op == KBOperator::POW ? precedence : precedence + 1));
+        Evaluatable *l = left.release();
+        left.reset(new KBOperation(operatorInfo(op).signs[0], l, right.release()));
+    }
+    return left.release();
+}
+
+Evaluatable *KBKRLParser::parseUnary()
+{
+    KBOperator op;
+    if ((current.kind == TokenKind::SIGN || current.kind == TokenKind::IDENT) &&
+        parseOperatorSign(string(current.text), false, op))
+    {
+        Token next = peekNext();
+        // -5 без пробела - отрицательное число, а не операция neg
+        bool numeric = next.kind == TokenKind::NUMBER || (next.kind == TokenKind::IDENT && (next.text == "inf" || next.text == "nan"));
+        bool negativeNumber = op == KBOperator::NEG && numeric && next.offset == current.offset + 1;
+        // Словесная операция (not, neg) требует скобок, иначе это ссылка с таким именем
+        bool word = current.kind == TokenKind::IDENT;
+        if (!negativeNumber && (!word || next.kind == TokenKind::LPAREN))
+        {
+            advance();
+            unique_ptr<Evaluatable> operand(parseUnary());
+            return new KBOperation(operatorInfo(op).signs[0], operand.release());
+        }
+    }
+    return parsePrimary();
+}
+
+Evaluatable *KBKRLParser::parsePrimary()
+{
+    switch (current.kind)
+    {
+    case TokenKind::LPAREN:
+    {
+        advance();
+        unique_ptr<Evaluatable> inner(parseExpression());
+        expect(TokenKind::RPAREN, ")");
+        return inner.release();
+    }
+    case TokenKind::NUMBER:
+    case TokenKind::SIGN:
+        if (current.kind == TokenKind::NUMBER || current.text == "-")
+        {
+            return new KBNumericValue(parseNumber());
+        }
+        break;
+    case TokenKind::STRING:
+    {
+        KBSymbolicValue *value = new KBSymbolicValue(current.text);
+        advance();
+        return value;
+    }
+    case TokenKind::IDENT:
+        if (current.text == "true" || current.text == "True" || current.text == "false" || current.text == "False")
+        {
+            bool value = current.text[0] == 't' || current.text[0] == 'T';
+            advance();
+            return new KBBooleanValue(value);
+        }
+        return parseReference();
+    default:
+        break;
+    }
+    fail("Expected operand");
+}
+
+KBReference *KBKRLParser::parseReference()
+{
+    vector<string_view> path;
+    path.push_back(current.text);
+    advance();
+    while (current.kind == TokenKind::DOT)
+    {
+        advance();
+        if (current.kind != TokenKind::IDENT)
+        {
+            fail("Expected attribute name");
+        }
+        path.push_back(current.text);
+        advance();
+    }
+    KBReference *ref = nullptr;
+    for (auto it = path.rbegin(); it != path.rend(); ++it)
+    {
+        ref = new KBReference(*it, ref);
+    }
+    return ref;
+}
@@ -0,0 +1,250 @@
+#include "kb_object.h"
+#include "knowledge_base.h"
+#include "utils.h"
+#include <stdexcept>
+
+using namespace std;
+
+static KBSymbol propertyTag()
+{
+    static const KBSymbol PROPERTY_TAG("property");
+    return PROPERTY_TAG;
+}
+
+static KBSymbol objectTag()
+{
+    static const KBSymbol OBJECT_TAG("class");
+    return OBJECT_TAG;
+}
+
+KBProperty::KBProperty(KBSymbol id, KBSymbol type, const char *desc)
+    : KBIdentity(id, propertyTag(), desc), type(type) {}
+
+void KBProperty::collectAttrs(KBAttrList &attrs) const
+{
+    KBIdentity::collectAttrs(attrs);
+    attrs.set("type", type.str());
+}
+
+void KBProperty::writeKRL(string &out) const
+{
+    out += "АТРИБУТ ";
+    out += getId();
+    out += "\nТИП ";
+    out += type.str();
+    out += "\nКОММЕНТАРИЙ ";
+    out += getDesc() != nullptr ? getDesc() : getId().c_str();
+    out += '\n';
+}
+
+void KBProperty::collectDiagnostics(const KnowledgeBase &kb, vector<KBDiagnostic> &diagnostics) const
+{
+    if (!kb.getType(type))
+    {
+        diagnostics.push_back({this, "Unknown type " + type.str() + " of attribute " + getId()});
+    }
+}
+
+KBProperty *KBProperty::fromXML(xmlNodePtr node)
+{
+    string id, type, desc;
+    xmlProp(node, "id", id);
+    xmlProp(node, "type", type);
+    bool hasDesc = xmlProp(node, "desc", desc);
+    return new KBProperty(id, type, hasDesc ? desc.c_str() : nullptr);
+}
+
+KBProperty *KBProperty::fromJSON(const Json::Value &json)
+{
+    const char *desc = json["desc"].isNull() ? nullptr : json["desc"].asCString();
+    return new KBProperty(json["id"].asString(), json["type"].asString(), desc);
+}
+
+KBObject::KBObject(KBSymbol id, const vector<KBProperty *> &properties, KBSymbol group, const char *desc)
+    : KBIdentity(id, objectTag(), desc), group(group)
+{
+    this->properties.reserve(properties.size());
+    propertyIndex.reserve(properties.size());
+    try
+    {
+        for (KBProperty *property : properties)
+        {
+            addProperty(property);
+        }
+    }
+    catch (...)
+    {
+        for (KBProperty *property : this->properties)
+        {
+            delete property;
+        }
+        throw;
+    }
+}
+
+KBObject::~KBObject()
+{
+    for (KBProperty *property : properties)
+    {
+        kbDeleteChild(property);
+    }
+}
+
+void KBObject::addProperty(KBProperty *property)
+{
+    if (!propertyIndex.insert(property->getIdSymbol(), properties.size()))
+    {
+        string id = property->getId();
+        delete property;
+        throw invalid_argument("Duplicate property " + id + " in object " + getId());
+    }
+    property->owner = this;
+    properties.push_back(property);
+    if (KnowledgeBase *kb = dynamic_cast<KnowledgeBase *>(owner))
+    {
+        kb->schemaChanged();
+    }
+}
+
+KBProperty *KBObject::getProperty(KBSymbol id) const
+{
+    uint32_t index = propertyIndex.find(id);
+    return index != KBSymbolIndex::NOT_FOUND ? properties[index] : nullptr;
+}
+
+void KBObject::collectAttrs(KBAttrList &attrs) const
+{
+    KBIdentity::collectAttrs(attrs);
+    if (!group.empty())
+    {
+        attrs.set("group", group.str());
+    }
+}
+
+vector<xmlNodePtr> KBObject::getInnerXML() const
+{
+    xmlNodePtr node = xmlNewNode(nullptr, BAD_CAST "properties");
+    for (const KBProperty *property : properties)
+    {
+        xmlAddChild(node, property->toXML());
+    }
+    return {node};
+}
+
+void KBObject::writeInnerXML(KBXMLWriter &writer) const
+{
+    writer.startElement("properties");
+    for (const KBProperty *property : properties)
+    {
+        property->writeXML(writer);
+    }
+    writer.endElement();
+}
+
+Json::Value KBObject::toJSON() const
+{
+    Json::Value json = KBEntity::toJSON();
+    json["properties"] = Json::Value(Json::arrayValue);
+    for (const KBProperty *property : properties)
+    {
+        json["properties"].append(property->toJSON());
+    }
+    return json;
+}
+
+void KBObject::writeJSON(KBJSONWriter &writer) const
+{
+    writer.startObject();
+    if (getDesc() != nullptr)
+    {
+        writer.member("desc", getDesc());
+    }
+    if (!group.empty())
+    {
+        writer.member("group", group.str());
+    }
+    writer.member("id", getId());
+    writer.key("properties");
+    writer.startArray();
+    for (const KBProperty *property : properties)
+    {
+        property->writeJSON(writer);
+    }
+    writer.endArray();
+    writer.member("tag", getTag());
+    writer.endObject();
+}
+
+void KBObject::writeKRL(string &out) const
+{
+    out += "ОБЪЕКТ ";
+    out += getId();
+    out += '\n';
+    if (!group.empty())
+    {
+        out += "ГРУППА ";
+        out += group.str();
+        out += '\n';
+    }
+    out += "АТРИБУТЫ\n";
+    for (const KBProperty *property : properties)
+    {
+        property->writeKRL(out);
+    }
+    out += "КОММЕНТАРИЙ ";
+    out += getDesc() != nullptr ? getDesc() : getId().c_str();
+    out += '\n';
+}
+
+void KBObject::collectDiagnostics(const KnowledgeBase &kb, vector<KBDiagnostic> &diagnostics) const
+{
+    for (KBProperty *property : properties)
+    {
+        property->validate(kb, diagnostics);
+    }
+}
+
+KBObject *KBObject::fromXML(xmlNodePtr node)
+{
+    string id, group, desc;
+    xmlProp(node, "id", id);
+    xmlProp(node, "group", group);
+    bool hasDesc = xmlProp(node, "desc", desc);
+    KBObject *object = new KBObject(id, {}, group, hasDesc ? desc.c_str() : nullptr);
+    try
+    {
+        xmlNodePtr properties = findNodeByName(node->children, "properties");
+        for (xmlNodePtr child = properties ? xmlFirstElementChild(properties) : nullptr; child; child = xmlNextElementSibling(child))
+        {
+            if (xmlStrcmp(child->name, BAD_CAST "property") == 0)
+            {
+                object->addProperty(KBProperty::fromXML(child));
+            }
+        }
+    }
+    catch (...)
+    {
+        delete object;
+        throw;
+    }
+    return object;
+}
+
+KBObject *KBObject::fromJSON(const Json::Value &json)
+{
+    const char *desc = json["desc"].isNull() ? nullptr : json["desc"].asCString();
+    KBObject *object = new KBObject(json["id"].asString(), {}, json["group"].asString(), desc);
+    try
+    {
+        for (const Json::Value &property : json["properties"])
+        {
+            object->addProperty(KBProperty::fromJSON(property));
+        }
+    }
+    catch (...)
+    {
+        delete object;
+        throw;
+    }
+    return object;
+}
@@ -1,4 +1,5 @@
 #include "kb_operation.h"
+#include "knowledge_base.h"
 #include <stdexcept>
 #include <algorithm>
 
@@ -24,38 +25,78 @@ const map<string, map<string, string>> TAGS_SIGNS = {
     {"pow", {{"values", "^ ** pow"}, {"is_binary", "true"}, {"meta", "super_math"}}},
 };
 
-KBOperation::KBOperation(const string &sign, Evaluatable *left, Evaluatable *right, NonFactor *non_factor)
-    : Evaluatable(non_factor), left(left), right(right)
+static constexpr bool operatorsOrdered()
 {
-    auto is_binary = left != nullptr && right != nullptr;
+    for (size_t i = 0; i < KB_OPERATORS_COUNT; ++i)
+    {
+        if (static_cast<size_t>(KB_OPERATORS[i].op) != i)
+        {
+            return false;
+        }
+    }
+    return true;
+}
 
-    for (const auto &[op, properties] : TAGS_SIGNS)
+static_assert(operatorsOrdered(), "KB_OPERATORS must be ordered by KBOperator");
+
+bool parseOperatorSign(const string &sign, bool binary, KBOperator &op)
+{
+    for (const KBOperatorInfo &info : KB_OPERATORS)
     {
-        if (properties.at("values").find(sign) != string::npos)
+        if (info.binary != binary)
         {
-            if (properties.at("is_binary") == (is_binary ? "true" : "false"))
+            continue;
+        }
+        for (const char *s : info.signs)
+        {
+            if (s && sign == s)
             {
-                this->op = op;
-                this->setTag(op);
-                break;
+                op = info.op;
+                return true;
             }
         }
     }
+    return false;
+}
 
-    if (this->op.empty())
+// Интернированные теги операций, чтобы конструктор не обращался к таблице символов
+static KBSymbol operatorTag(KBOperator op)
+{
+    static const vector<KBSymbol> tags = []
     {
-        throw invalid_argument("Unknown operation: " + sign);
-    }
+        vector<KBSymbol> result;
+        for (const KBOperatorInfo &info : KB_OPERATORS)
+        {
+            result.push_back(KBSymbol(info.tag));
+        }
+        return result;
+    }();
+    return tags[static_cast<size_t>(op)];
+}
 
-    map<string, string> properties = TAGS_SIGNS.at(this->op);
-    if (properties.find("convert+_non_factor") != properties.end())
+bool parseOperatorTag(const string &tag, KBOperator &op)
+{
+    for (const KBOperatorInfo &info : KB_OPERATORS)
     {
-        this->convert_non_factor = properties.at("convert_non_factor") == "true";
+        if (tag == info.tag)
+        {
+            op = info.op;
+            return true;
+        }
     }
-    else
+    return false;
+}
+
+KBOperation::KBOperation(const string &sign, Evaluatable *left, Evaluatable *right, NonFactor *non_factor)
+    : Evaluatable(non_factor), left(left), right(right)
+{
+    auto is_binary = left != nullptr && right != nullptr;
+
+    if (!parseOperatorSign(sign, is_binary, this->op))
     {
-        this->convert_non_factor = false;
+        throw invalid_argument("Unknown operation: " + sign);
     }
+    this->setTag(operatorTag(this->op));
 
     if (this->left)
     {
@@ -69,31 +110,30 @@ KBOperation::KBOperation(const string &sign, Evaluatable *left, Evaluatable *rig
 
 KBOperation::~KBOperation()
 {
-    if (left)
-    {
-        delete left;
-    }
-    if (right)
-    {
-        delete right;
-    }
+    kbDeleteChild(left);
+    kbDeleteChild(right);
 }
 
-bool KBOperation::isBinary() const
+void KBOperation::setOp(const string &op)
 {
-    return TAGS_SIGNS.at(op).at("is_binary") == "true";
+    KBOperator parsed;
+    if (!parseOperatorTag(op, parsed))
+    {
+        throw invalid_argument("Unknown operation: " + op);
+    }
+    setOperator(parsed);
 }
 
-string KBOperation::getSign() const
+void KBOperation::setOperator(KBOperator op)
 {
-    return TAGS_SIGNS.at(op).at("values").substr(0, TAGS_SIGNS.at(op).at("values").find(' '));
+    this->op = op;
+    this->setTag(operatorTag(this->op));
 }
 
-map<string, string> KBOperation::getAttrs() const
+void KBOperation::collectAttrs(KBAttrList &attrs) const
 {
-    map<string, string> attrs = Evaluatable::getAttrs();
-    attrs["op"] = op;
-    return attrs;
+    Evaluatable::collectAttrs(attrs);
+    attrs.set("op", operatorInfo(op).tag);
 }
 
 vector<xmlNodePtr> KBOperation::getInnerXML() const
@@ -106,6 +146,15 @@ vector<xmlNodePtr> KBOperation::getInnerXML() const
     return innerXML;
 }
 
+void KBOperation::writeInnerXML(KBXMLWriter &writer) const
+{
+    left->writeXML(writer);
+    if (isBinary() && right)
+    {
+        right->writeXML(writer);
+    }
+}
+
 Json::Value KBOperation::toJSON() const
 {
     Json::Value json;
@@ -122,6 +171,61 @@ Json::Value KBOperation::toJSON() const
     return json;
 }
 
+void KBOperation::writeJSON(KBJSONWriter &writer) const
+{
+    writer.startObject();
+    writer.key("left");
+    left->writeJSON(writer);
+    writer.key("non_factor");
+    getNonFactor()->writeJSON(writer);
+    if (isBinary() && right)
+    {
+        writer.key("right");
+        right->writeJSON(writer);
+    }
+    writer.member("sign", operatorInfo(op).signs[0]);
+    writer.endObject();
+}
+
+// Значение, сравниваемое с атрибутом, должно быть допустимым для его типа
+static void checkComparedValue(const KBOperation *operation, const Evaluatable *ref, const Evaluatable *value,
+                               const KnowledgeBase &kb, vector<KBDiagnostic> &diagnostics)
+{
+    const KBReference *reference = dynamic_cast<const KBReference *>(ref);
+    const KBValue *constant = dynamic_cast<const KBValue *>(value);
+    if (!reference || !constant)
+    {
+        return;
+    }
+    const KBType *type = kb.getReferenceType(reference);
+    if (type && !type->validateValue(constant->getContentAsString()))
+    {
+        diagnostics.push_back({operation, "Value " + constant->getInnerKRL() + " is not valid for type " + type->getId() + " of " + reference->getInnerKRL()});
+    }
+}
+
+void KBOperation::collectDiagnostics(const KnowledgeBase &kb, vector<KBDiagnostic> &diagnostics) const
+{
+    Evaluatable::collectDiagnostics(kb, diagnostics);
+    if (!left || (isBinary() != (right != nullptr)))
+    {
+        diagnostics.push_back({this, string("Wrong number of operands for operation ") + operatorInfo(op).tag});
+    }
+    if (left)
+    {
+        left->validate(kb, diagnostics);
+    }
+    if (isBinary() && right)
+    {
+        right->validate(kb, diagnostics);
+        if (op == KBOperator::EQ || op == KBOperator::NE)
+        {
+            checkComparedValue(this, left, right, kb, diagnostics);
+            checkComparedValue(this, right, left, kb, diagnostics);
+        }
+    }
+}
+
 KBOperation *KBOperation::fromXML(xmlNodePtr node)
 {
     if (!node)
@@ -130,9 +234,14 @@ KBOperation *KBOperation::fromXML(xmlNodePtr node)
     }
 
     string sign = (const char *)node->name;
+    KBOperator op;
+    if (!parseOperatorTag(sign, op))
+    {
+        throw invalid_argument("Unknown operation: " + sign);
+    }
     Evaluatable *left = Evaluatable::fromXML(xmlFirstElementChild(node));
     Evaluatable *right = nullptr;
-    if (TAGS_SIGNS.at(sign).at("is_binary") == "true")
+    if (operatorInfo(op).binary)
     {
         right = Evaluatable::fromXML(xmlNextElementSibling(xmlFirstElementChild(node)));
     }
@@ -169,14 +278,24 @@ KBOperation *KBOperation::fromJSON(const Json::Value &json)
     return new KBOperation(sign, left, right, non_factor);
 }
 
-string KBOperation::getInnerKRL() const
+void KBOperation::writeInnerKRL(string &out) const
 {
+    const char *sign = operatorInfo(op).signs[0];
     if (isBinary())
     {
-        return "(" + left->KRL() + ") " + getSign() + " (" + right->KRL() + ")";
+        out += '(';
+        left->writeKRL(out);
+        out += ") ";
+        out += sign;
+        out += " (";
+        right->writeKRL(out);
+        out += ')';
     }
     else
     {
-        return getSign() + " (" + left->KRL() + ")";
+        out += sign;
+        out += " (";
+        left->writeKRL(out);
+        out += ')';
     }
 }
@@ -0,0 +1,105 @@
+#include "kb_parallel.h"
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+size_t kbDefaultThreadCount()
+{
+    return max<size_t>(1, thread::hardware_concurrency());
+}
+
+namespace
+{
+    // Часть диапазона одного потока; выравнивание исключает ложное разделение кэш-линий
+    struct alignas(64) KBWorkRange
+    {
+        atomic<size_t> next{0};
+        size_t end = 0;
+    };
+}
+
+void kbParallelFor(size_t count, size_t threadCount, size_t grain,
+                   const function<void(size_t worker, size_t begin, size_t end)> &body)
+{
+    if (count == 0)
+    {
+        return;
+    }
+    grain = max<size_t>(grain, 1);
+    if (threadCount == 0)
+    {
+        threadCount = kbDefaultThreadCount();
+    }
+    threadCount = min(threadCount, (count + grain - 1) / grain);
+    if (threadCount <= 1)
+    {
+        for (size_t begin = 0; begin < count; begin += grain)
+        {
+            body(0, begin, min(begin + grain, count));
+        }
+        return;
+    }
+
+    unique_ptr<KBWorkRange[]> ranges(new KBWorkRange[threadCount]);
+    for (size_t i = 0; i < threadCount; ++i)
+    {
+        ranges[i].next.store(count * i / threadCount, memory_order_relaxed);
+        ranges[i].end = count * (i + 1) / threadCount;
+    }
+
+    atomic<bool> failed{false};
+    exception_ptr error;
+    mutex errorMutex;
+
+    auto work = [&](size_t worker)
+    {
+        try
+        {
+            // Сначала своя часть, затем части остальных потоков по кругу
+            for (size_t step = 0; step < threadCount; ++step)
+            {
+                KBWorkRange &range = ranges[(worker + step) % threadCount];
+                while (!failed.load(memory_order_relaxed))
+                {
+                    size_t begin = range.next.fetch_add(grain, memory_order_relaxed);
+                    if (begin >= range.end)
+                    {
+                        break;
+                    }
+                    body(worker, begin, min(begin + grain, range.end));
+                }
+            }
+        }
+        catch (...)
+        {
+            lock_guard<mutex> lock(errorMutex);
+            if (!error)
+            {
+                error = current_exception();
+            }
+            failed.store(true, memory_order_relaxed);
+        }
+    };
+
+    vector<thread> threads;
+    threads.reserve(threadCount - 1);
+    for (size_t i = 1; i < threadCount; ++i)
+    {
+        threads.emplace_back(work, i);
+    }
+    work(0);
+    for (thread &t : threads)
+    {
+        t.join();
+    }
+    if (error)
+    {
+        rethrow_exception(error);
+    }
+}
@@ -0,0 +1,394 @@
+#include "kb_program.h"
+#include "kb_operation.h"
+#include "kb_reference.h"
+#include "kb_slot_layout.h"
+#include <cmath>
+#include <stdexcept>
+#include <algorithm>
+
+using namespace std;
+
+KBEvalValue KBEvalValue::undefined(const KBNonFactorValue &nonFactor)
+{
+    KBEvalValue value;
+    value.nonFactor = nonFactor;
+    return value;
+}
+
+KBEvalValue KBEvalValue::fromNumber(double number, const KBNonFactorValue &nonFactor)
+{
+    KBEvalValue value;
+    value.kind = NUMBER;
+    value.number = number;
+    value.nonFactor = nonFactor;
+    return value;
+}
+
+KBEvalValue KBEvalValue::fromBoolean(bool boolean, const KBNonFactorValue &nonFactor)
+{
+    KBEvalValue value;
+    value.kind = BOOLEAN;
+    value.boolean = boolean;
+    value.nonFactor = nonFactor;
+    return value;
+}
+
+KBEvalValue KBEvalValue::fromSymbol(uint32_t symbol, const KBNonFactorValue &nonFactor)
+{
+    KBEvalValue value;
+    value.kind = SYMBOL;
+    value.symbol = symbol;
+    value.nonFactor = nonFactor;
+    return value;
+}
+
+bool KBEvalValue::operator==(const KBEvalValue &other) const
+{
+    if (kind != other.kind || nonFactor.belief != other.nonFactor.belief ||
+        nonFactor.probability != other.nonFactor.probability || nonFactor.accuracy != other.nonFactor.accuracy)
+    {
+        return false;
+    }
+    switch (kind)
+    {
+    case NUMBER:
+        return number == other.number;
+    case BOOLEAN:
+        return boolean == other.boolean;
+    case SYMBOL:
+        return symbol == other.symbol;
+    default:
+        return true;
+    }
+}
+
+// Коды инструкций в порядке KBOperator
+static constexpr KBOpCode OP_CODES[] = {
+    KBOpCode::EQ, KBOpCode::GT, KBOpCode::GE, KBOpCode::LT, KBOpCode::LE, KBOpCode::NE,
+    KBOpCode::AND, KBOpCode::OR, KBOpCode::NOT, KBOpCode::XOR,
+    KBOpCode::NEG, KBOpCode::ADD, KBOpCode::SUB, KBOpCode::MUL, KBOpCode::DIV, KBOpCode::MOD, KBOpCode::POW,
+};
+
+static_assert(sizeof(OP_CODES) / sizeof(OP_CODES[0]) == KB_OPERATORS_COUNT, "OP_CODES must cover every KBOperator");
+
+static KBNonFactorValue minNonFactor(const KBNonFactorValue &a, const KBNonFactorValue &b)
+{
+    return {std::min(a.belief, b.belief), std::min(a.probability, b.probability), std::max(a.accuracy, b.accuracy)};
+}
+
+static KBNonFactorValue maxNonFactor(const KBNonFactorValue &a, const KBNonFactorValue &b)
+{
+    return {std::max(a.belief, b.belief), std::max(a.probability, b.probability), std::max(a.accuracy, b.accuracy)};
+}
+
+KBNonFactorValue applyNonFactor(const KBNonFactorValue &value, const KBNonFactorValue &with)
+{
+    return minNonFactor(value, with);
+}
+
+int KBEvalValue::getTruth() const
+{
+    switch (kind)
+    {
+    case BOOLEAN:
+        return boolean ? 1 : 0;
+    case NUMBER:
+        return number != 0.0 ? 1 : 0;
+    default:
+        return -1;
+    }
+}
+
+static KBEvalValue fromTruth(int t, const KBNonFactorValue &nonFactor)
+{
+    return t < 0 ? KBEvalValue::undefined(nonFactor) : KBEvalValue::fromBoolean(t == 1, nonFactor);
+}
+
+static int equals(const KBEvalValue &left, const KBEvalValue &right)
+{
+    if (!left.isDefined() || !right.isDefined())
+    {
+        return -1;
+    }
+    if (left.kind != right.kind)
+    {
+        return 0;
+    }
+    switch (left.kind)
+    {
+    case KBEvalValue::NUMBER:
+        return left.number == right.number;
+    case KBEvalValue::BOOLEAN:
+        return left.boolean == right.boolean;
+    default:
+        return left.symbol == right.symbol;
+    }
+}
+
+KBEvalValue evalUnary(KBOpCode code, const KBEvalValue &operand)
+{
+    switch (code)
+    {
+    case KBOpCode::NOT:
+    {
+        KBNonFactorValue nf = {100.0 - operand.nonFactor.probability, 100.0 - operand.nonFactor.belief, operand.nonFactor.accuracy};
+        int t = operand.getTruth();
+        return fromTruth(t < 0 ? -1 : 1 - t, nf);
+    }
+    case KBOpCode::NEG:
+        if (operand.kind != KBEvalValue::NUMBER)
+        {
+            return KBEvalValue::undefined(operand.nonFactor);
+        }
+        return KBEvalValue::fromNumber(-operand.number, operand.nonFactor);
+    default:
+        throw invalid_argument("Operation is not unary");
+    }
+}
+
+KBEvalValue evalBinary(KBOpCode code, const KBEvalValue &left, const KBEvalValue &right)
+{
+    KBNonFactorValue nf = minNonFactor(left.nonFactor, right.nonFactor);
+    switch (code)
+    {
+    case KBOpCode::EQ:
+        return fromTruth(equals(left, right), nf);
+    case KBOpCode::NE:
+    {
+        int t = equals(left, right);
+        return fromTruth(t < 0 ? -1 : 1 - t, nf);
+    }
+    case KBOpCode::AND:
+    {
+        int l = left.getTruth(), r = right.getTruth();
+        return fromTruth(l == 0 || r == 0 ? 0 : (l < 0 || r < 0 ? -1 : 1), nf);
+    }
+    case KBOpCode::OR:
+    {
+        int l = left.getTruth(), r = right.getTruth();
+        return fromTruth(l == 1 || r == 1 ? 1 : (l < 0 || r < 0 ? -1 : 0), maxNonFactor(left.nonFactor, right.nonFactor));
+    }
+    case KBOpCode::XOR:
+    {
+        int l = left.getTruth(), r = right.getTruth();
+        return fromTruth(l < 0 || r < 0 ? -1 : l != r, nf);
+    }
+    default:
+        break;
+    }
+
+    if (left.kind != KBEvalValue::NUMBER || right.kind != KBEvalValue::NUMBER)
+    {
+        return KBEvalValue::undefined(nf);
+    }
+    double a = left.number, b = right.number;
+    switch (code)
+    {
+    case KBOpCode::GT:
+        return KBEvalValue::fromBoolean(a > b, nf);
+    case KBOpCode::GE:
+        return KBEvalValue::fromBoolean(a >= b, nf);
+    case KBOpCode::LT:
+        return KBEvalValue::fromBoolean(a < b, nf);
+    case KBOpCode::LE:
+        return KBEvalValue::fromBoolean(a <= b, nf);
+    case KBOpCode::ADD:
+        return KBEvalValue::fromNumber(a + b, nf);
+    case KBOpCode::SUB:
+        return KBEvalValue::fromNumber(a - b, nf);
+    case KBOpCode::MUL:
+        return KBEvalValue::fromNumber(a * b, nf);
+    case KBOpCode::DIV:
+        return b == 0.0 ? KBEvalValue::undefined(nf) : KBEvalValue::fromNumber(a / b, nf);
+    case KBOpCode::MOD:
+        return b == 0.0 ? KBEvalValue::undefined(nf) : KBEvalValue::fromNumber(fmod(a, b), nf);
+    case KBOpCode::POW:
+        return KBEvalValue::fromNumber(pow(a, b), nf);
+    default:
+        throw invalid_argument("Operation is not binary");
+    }
+}
+
+// KBProgram implementation
+
+KBProgram KBProgram::compile(const Evaluatable *root)
+{
+    if (!root)
+    {
+        throw invalid_argument("Cannot compile empty expression");
+    }
+    KBProgram program;
+    program.emit(root, 0);
+    return program;
+}
+
+KBProgram KBProgram::compile(const Evaluatable *root, const KBSlotLayout &layout)
+{
+    if (!root)
+    {
+        throw invalid_argument("Cannot compile empty expression");
+    }
+    KBProgram program;
+    program.layout = &layout;
+    program.emit(root, 0);
+    return program;
+}
+
+size_t KBProgram::getSlotCount() const
+{
+    return layout ? layout->getSlotCount() : references.size();
+}
+
+KBEvalValue KBProgram::constant(const KBValue *value)
+{
+    // Литерал без явной уверенности считается достоверным
+    KBNonFactorValue nf = value->getNonFactorValue();
+    if (nf.isDefault())
+    {
+        nf = {100.0, 100.0, 0.0};
+    }
+    if (const KBNumericValue *numeric = dynamic_cast<const KBNumericValue *>(value))
+    {
+        return KBEvalValue::fromNumber(numeric->getContent(), nf);
+    }
+    if (const KBBooleanValue *boolean = dynamic_cast<const KBBooleanValue *>(value))
+    {
+        return KBEvalValue::fromBoolean(boolean->getContent(), nf);
+    }
+    if (const KBSymbolicValue *symbolic = dynamic_cast<const KBSymbolicValue *>(value))
+    {
+        return KBEvalValue::fromSymbol(symbolic->getSymbol().getId(), nf);
+    }
+    return symbol(value->getContentAsString(), nf);
+}
+
+KBOpCode KBProgram::opCode(const KBOperation *op)
+{
+    return OP_CODES[static_cast<size_t>(op->getOperator())];
+}
+
+string KBProgram::referencePath(const KBReference *ref)
+{
+    string path = ref->getId();
+    for (const KBReference *current = ref->getRef(); current; current = current->getRef())
+    {
+        path += "." + current->getId();
+    }
+    return path;
+}
+
+uint32_t KBProgram::addReference(const string &path)
+{
+    auto it = find(references.begin(), references.end(), path);
+    if (it != references.end())
+    {
+        return it - references.begin();
+    }
+    references.push_back(path);
+    return references.size() - 1;
+}
+
+uint32_t KBProgram::addReference(const KBReference *ref)
+{
+    if (!layout)
+    {
+        return addReference(referencePath(ref));
+    }
+    // Привязанная ссылка уже знает свой слот - без поиска по схеме
+    uint32_t slot = layout->require(ref);
+    addReference(layout->getSlotPath(slot));
+    return slot;
+}
+
+void KBProgram::emit(const Evaluatable *node, size_t depth)
+{
+    maxStack = std::max(maxStack, depth + 1);
+    KBNonFactorValue nf = node->getNonFactorValue();
+
+    if (const KBValue *value = dynamic_cast<const KBValue *>(node))
+    {
+        constants.push_back(constant(value));
+        code.push_back({KBOpCode::PUSH_CONST, (uint32_t)(constants.size() - 1)});
+        return;
+    }
+
+    if (const KBReference *ref = dynamic_cast<const KBReference *>(node))
+    {
+        code.push_back({KBOpCode::LOAD_REF, addReference(ref)});
+    }
+    else if (const KBOperation *op = dynamic_cast<const KBOperation *>(node))
+    {
+        emit(op->getLeft(), depth);
+        if (op->isBinary())
+        {
+            emit(op->getRight(), depth + 1);
+        }
+        code.push_back({opCode(op), 0});
+    }
+    else
+    {
+        throw invalid_argument("Unsupported evaluatable: " + node->getTag());
+    }
+
+    if (!nf.isDefault())
+    {
+        nonFactors.push_back(nf);
+        code.push_back({KBOpCode::WITH, (uint32_t)(nonFactors.size() - 1)});
+    }
+}
+
+vector<KBEvalValue> KBProgram::bind(const map<string, KBEvalValue> &facts) const
+{
+    if (layout)
+    {
+        return layout->bind(facts);
+    }
+    vector<KBEvalValue> slots(references.size());
+    for (size_t i = 0; i < references.size(); ++i)
+    {
+        auto it = facts.find(references[i]);
+        if (it != facts.end())
+        {
+            slots[i] = it->second;
+        }
+    }
+    return slots;
+}
+
+// KBVirtualMachine implementation
+
+KBEvalValue KBVirtualMachine::run(const KBProgram &program, const KBEvalValue *slots)
+{
+    if (stack.size() < program.getMaxStack())
+    {
+        stack.resize(program.getMaxStack());
+    }
+    KBEvalValue *top = stack.data() - 1;
+    const KBEvalValue *constants = program.getConstants().data();
+    const KBNonFactorValue *nonFactors = program.getNonFactors().data();
+
+    for (const KBInstruction &instruction : program.getCode())
+    {
+        switch (instruction.code)
+        {
+        case KBOpCode::PUSH_CONST:
+            *++top = constants[instruction.arg];
+            break;
+        case KBOpCode::LOAD_REF:
+            *++top = slots[instruction.arg];
+            break;
+        case KBOpCode::WITH:
+            top->nonFactor = applyNonFactor(top->nonFactor, nonFactors[instruction.arg]);
+            break;
+        case KBOpCode::NOT:
+        case KBOpCode::NEG:
+            *top = evalUnary(instruction.code, *top);
+            break;
+        default:
+            --top;
+            *top = evalBinary(instruction.code, top[0], top[1]);
+            break;
+        }
+    }
+    return *top;
+}
@@ -1,28 +1,30 @@
 #include "kb_reference.h"
+#include "knowledge_base.h"
+#include <memory>
 #include <stdexcept>
 
 using namespace std;
 
-KBReference::KBReference(const string &id, KBReference *ref, NonFactor *non_factor)
+KBReference::KBReference(KBSymbol id, KBReference *ref, NonFactor *non_factor)
     : Evaluatable(non_factor), id(id), ref(ref)
 {
+    static const KBSymbol REF_TAG("ref");
     if (this->ref)
     {
         this->ref->owner = this;
     }
-    this->setTag("ref");
+    this->setTag(REF_TAG);
 }
 
 KBReference::~KBReference()
 {
-    delete ref;
+    kbDeleteChild(ref);
 }
 
-map<string, string> KBReference::getAttrs() const
+void KBReference::collectAttrs(KBAttrList &attrs) const
 {
-    map<string, string> attrs = Evaluatable::getAttrs();
-    attrs["id"] = id;
-    return attrs;
+    Evaluatable::collectAttrs(attrs);
+    attrs.set("id", id.str());
 }
 
 vector<xmlNodePtr> KBReference::getInnerXML() const
@@ -35,10 +37,18 @@ vector<xmlNodePtr> KBReference::getInnerXML() const
     return innerXML;
 }
 
+void KBReference::writeInnerXML(KBXMLWriter &writer) const
+{
+    if (ref)
+    {
+        ref->writeXML(writer);
+    }
+}
+
 Json::Value KBReference::toJSON() const
 {
     Json::Value json;
-    json["id"] = id;
+    json["id"] = id.str();
     if (ref)
     {
         json["ref"] = ref->toJSON();
@@ -50,6 +60,20 @@ Json::Value KBReference::toJSON() const
     return json;
 }
 
+void KBReference::writeJSON(KBJSONWriter &writer) const
+{
+    writer.startObject();
+    writer.member("id", id.str());
+    writer.key("non_factor");
+    getNonFactor()->writeJSON(writer);
+    if (ref)
+    {
+        writer.key("ref");
+        ref->writeJSON(writer);
+    }
+    writer.endObject();
+}
+
 KBReference *KBReference::fromXML(xmlNodePtr node)
 {
     if (!node)
@@ -57,31 +81,23 @@ KBReference *KBReference::fromXML(xmlNodePtr node)
         throw runtime_error("Invalid XML node");
     }
 
-    string id = (const char *)xmlGetProp(node, BAD_CAST "id");
-    xmlNodePtr refNode = xmlFirstElementChild(node);
+    xmlChar *idAttr = xmlGetProp(node, BAD_CAST "id");
+    KBSymbol id((const char *)idAttr);
+    xmlFree(idAttr);
     KBReference *ref = nullptr;
-    NonFactor *non_factor = nullptr;
-    if (refNode)
+    unique_ptr<NonFactor> non_factor;
+    for (xmlNodePtr child = xmlFirstElementChild(node); child; child = xmlNextElementSibling(child))
     {
-        string refNodeName = (const char *)refNode->name;
-        if (refNodeName == "with")
+        if (xmlStrcmp(child->name, BAD_CAST "with") == 0)
         {
-            non_factor = NonFactor::fromXML(refNode);
+            non_factor.reset(NonFactor::fromXML(child));
         }
-        else if (refNodeName == "ref")
+        else if (xmlStrcmp(child->name, BAD_CAST "ref") == 0 && !ref)
         {
-            ref = fromXML(refNode);
-            if (refNode->next)
-            {
-                string nextName = (const char *)refNode->next->name;
-                if (nextName == "with")
-                {
-                    non_factor = NonFactor::fromXML(refNode);
-                }
-            }
+            ref = fromXML(child);
         }
     }
-    return new KBReference(id, ref, non_factor);
+    return new KBReference(id, ref, non_factor.get());
 }
 
 KBReference *KBReference::fromJSON(const Json::Value &json)
@@ -91,21 +107,44 @@ KBReference *KBReference::fromJSON(const Json::Value &json)
         throw runtime_error("Invalid JSON value");
     }
 
-    string id = json["id"].asString();
+    KBSymbol id(json["id"].asString());
     KBReference *ref = json.isMember("ref") ? fromJSON(json["ref"]) : nullptr;
     NonFactor *non_factor = json.isMember("non_factor") ? NonFactor::fromJSON(json["non_factor"]) : nullptr;
 
     return new KBReference(id, ref, non_factor);
 }
 
-string KBReference::getInnerKRL() const
+// Путь проверяет головная ссылка цепочки: ОБЪЕКТ либо ОБЪЕКТ.АТРИБУТ
+void KBReference::collectDiagnostics(const KnowledgeBase &kb, vector<KBDiagnostic> &diagnostics) const
+{
+    Evaluatable::collectDiagnostics(kb, diagnostics);
+    if (dynamic_cast<const KBReference *>(owner))
+    {
+        return;
+    }
+    KBObject *object = kb.getObject(id);
+    if (!object)
+    {
+        diagnostics.push_back({this, "Unknown object " + id.str()});
+    }
+    else if (ref && !object->getProperty(ref->id))
+    {
+        diagnostics.push_back({this, "Unknown attribute " + getInnerKRL()});
+    }
+    else if (ref && ref->ref)
+    {
+        diagnostics.push_back({this, "Unsupported reference path " + getInnerKRL()});
+    }
+}
+
+void KBReference::writeInnerKRL(string &out) const
 {
-    string result = id;
+    out += id.str();
     const KBReference *currentRef = ref;
     while (currentRef)
     {
-        result += "." + currentRef->getId();
+        out += '.';
+        out += currentRef->getId();
         currentRef = currentRef->getRef();
     }
-    return result;
 }
@@ -0,0 +1,383 @@
+#include "kb_rete.h"
+#include "kb_operation.h"
+#include "kb_reference.h"
+#include "utils.h"
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+
+using namespace std;
+
+static void appendNonFactor(string &key, const KBNonFactorValue &nf)
+{
+    key += '[';
+    appendDouble(key, nf.belief);
+    key += ';';
+    appendDouble(key, nf.probability);
+    key += ';';
+    appendDouble(key, nf.accuracy);
+    key += ']';
+}
+
+// Структурный ключ подвыражения: совпадает у одинаковых подвыражений разных правил
+static void appendKey(const KBSlotLayout &layout, const Evaluatable *node, string &key)
+{
+    if (const KBValue *value = dynamic_cast<const KBValue *>(node))
+    {
+        KBEvalValue constant = KBProgram::constant(value);
+        key += 'c';
+        key += to_string(constant.kind);
+        key += ':';
+        switch (constant.kind)
+        {
+        case KBEvalValue::NUMBER:
+            appendDouble(key, constant.number);
+            break;
+        case KBEvalValue::BOOLEAN:
+            key += constant.boolean ? '1' : '0';
+            break;
+        default:
+            key += to_string(constant.symbol);
+            break;
+        }
+        appendNonFactor(key, constant.nonFactor);
+        return;
+    }
+    if (const KBReference *ref = dynamic_cast<const KBReference *>(node))
+    {
+        key += 'r';
+        key += to_string(layout.require(ref));
+    }
+    else if (const KBOperation *op = dynamic_cast<const KBOperation *>(node))
+    {
+        key += '(';
+        key += to_string(static_cast<int>(KBProgram::opCode(op)));
+        key += ' ';
+        appendKey(layout, op->getLeft(), key);
+        if (op->isBinary())
+        {
+            key += ' ';
+            appendKey(layout, op->getRight(), key);
+        }
+        key += ')';
+    }
+    else
+    {
+        throw invalid_argument("Unsupported evaluatable: " + node->getTag());
+    }
+    if (node->hasOwnNonFactor())
+    {
+        appendNonFactor(key, node->getNonFactorValue());
+    }
+}
+
+KBReteEngine::KBReteEngine(KnowledgeBase &kb)
+    : kb(kb), layout(kb.bindReferences()), schemaVersion(kb.getSchemaVersion())
+{
+    memory.resize(layout.getSlotCount());
+    slotAlphas.resize(layout.getSlotCount());
+
+    map<string, uint32_t> shared;
+    const vector<KBRule *> &rules = kb.getRules();
+    for (uint32_t i = 0; i < rules.size(); ++i)
+    {
+        uint32_t root = KBSlotLayout::NONE;
+        if (rules[i]->getCondition())
+        {
+            root = build(rules[i]->getCondition(), shared);
+            nodes[root].rules.push_back(i);
+        }
+        conditions.push_back(root);
+        thenActions.push_back(compileActions(rules[i]->getInstructions()));
+        elseActions.push_back(compileActions(rules[i]->getElseInstructions()));
+    }
+
+    // Узел создается после своих операндов, поэтому проход по номерам вычисляет сеть целиком
+    for (uint32_t i = 0; i < nodes.size(); ++i)
+    {
+        evaluate(i);
+    }
+    ruleStates.assign(rules.size(), UNKNOWN);
+    for (uint32_t i = 0; i < rules.size(); ++i)
+    {
+        if (conditions[i] == KBSlotLayout::NONE)
+        {
+            ruleStates[i] = MATCHED;
+            agenda.insert(i * 2);
+        }
+        else
+        {
+            updateRule(i);
+        }
+    }
+}
+
+uint32_t KBReteEngine::addProgram(const Evaluatable *node)
+{
+    programs.push_back(KBProgram::compile(node, layout));
+    return programs.size() - 1;
+}
+
+uint32_t KBReteEngine::build(const Evaluatable *node, map<string, uint32_t> &shared)
+{
+    vector<uint32_t> slots;
+    layout.collectSlots(node, slots);
+
+    Node entry;
+    entry.left = KBSlotLayout::NONE;
+    entry.right = KBSlotLayout::NONE;
+    entry.slot = KBSlotLayout::NONE;
+    entry.program = KBSlotLayout::NONE;
+    entry.code = KBOpCode::PUSH_CONST;
+    entry.hasWith = false;
+    entry.queued = false;
+
+    string key;
+    const KBOperation *op = dynamic_cast<const KBOperation *>(node);
+    if (slots.size() <= 1 || !op)
+    {
+        // Подвыражение одного атрибута (или без атрибутов) вычисляется целиком одной программой
+        key = "a";
+        appendKey(layout, node, key);
+        auto it = shared.find(key);
+        if (it != shared.end())
+        {
+            return it->second;
+        }
+        entry.kind = slots.empty() ? CONSTANT : ALPHA;
+        entry.program = addProgram(node);
+        if (!slots.empty())
+        {
+            entry.slot = slots.front();
+        }
+    }
+    else
+    {
+        entry.kind = BETA;
+        entry.code = KBProgram::opCode(op);
+        entry.with = op->getNonFactorValue();
+        entry.hasWith = !entry.with.isDefault();
+        entry.left = build(op->getLeft(), shared);
+        if (op->isBinary())
+        {
+            entry.right = build(op->getRight(), shared);
+        }
+        key = "b" + to_string(static_cast<int>(entry.code)) + ":" + to_string(entry.left) + ":" + to_string(entry.right);
+        if (entry.hasWith)
+        {
+            appendNonFactor(key, entry.with);
+        }
+        auto it = shared.find(key);
+        if (it != shared.end())
+        {
+            return it->second;
+        }
+    }
+
+    uint32_t index = nodes.size();
+    nodes.push_back(entry);
+    shared.emplace(key, index);
+    if (entry.kind == ALPHA)
+    {
+        slotAlphas[entry.slot].push_back(index);
+    }
+    if (entry.left != KBSlotLayout::NONE)
+    {
+        nodes[entry.left].successors.push_back(index);
+    }
+    if (entry.right != KBSlotLayout::NONE && entry.right != entry.left)
+    {
+        nodes[entry.right].successors.push_back(index);
+    }
+    return index;
+}
+
+vector<KBReteEngine::Action> KBReteEngine::compileActions(const vector<KBAssign *> &instructions)
+{
+    vector<Action> actions;
+    for (const KBAssign *assign : instructions)
+    {
+        actions.push_back({layout.require(assign->getRef()), addProgram(assign->getValue())});
+    }
+    return actions;
+}
+
+void KBReteEngine::checkCurrent() const
+{
+    if (kb.getSchemaVersion() != schemaVersion || kb.getRules().size() != conditions.size())
+    {
+        throw logic_error("Knowledge base changed after the inference engine was created");
+    }
+}
+
+bool KBReteEngine::evaluate(uint32_t node)
+{
+    Node &entry = nodes[node];
+    KBEvalValue value;
+    switch (entry.kind)
+    {
+    case BETA:
+        value = entry.right == KBSlotLayout::NONE
+                    ? evalUnary(entry.code, nodes[entry.left].value)
+                    : evalBinary(entry.code, nodes[entry.left].value, nodes[entry.right].value);
+        if (entry.hasWith)
+        {
+            value.nonFactor = applyNonFactor(value.nonFactor, entry.with);
+        }
+        break;
+    default:
+        value = vm.run(programs[entry.program], memory.data());
+        break;
+    }
+    ++evaluated;
+    if (value == entry.value)
+    {
+        return false;
+    }
+    entry.value = value;
+    return true;
+}
+
+void KBReteEngine::enqueue(uint32_t node)
+{
+    if (!nodes[node].queued)
+    {
+        nodes[node].queued = true;
+        queue.push_back(node);
+        push_heap(queue.begin(), queue.end(), greater<uint32_t>());
+    }
+}
+
+void KBReteEngine::propagate()
+{
+    // Наследник имеет больший номер, чем его операнды: обработка по возрастанию номеров
+    // вычисляет каждый узел один раз после всех изменившихся операндов
+    while (!queue.empty())
+    {
+        pop_heap(queue.begin(), queue.end(), greater<uint32_t>());
+        uint32_t node = queue.back();
+        queue.pop_back();
+        nodes[node].queued = false;
+        if (!evaluate(node))
+        {
+            continue;
+        }
+        for (uint32_t successor : nodes[node].successors)
+        {
+            enqueue(successor);
+        }
+        for (uint32_t rule : nodes[node].rules)
+        {
+            updateRule(rule);
+        }
+    }
+}
+
+void KBReteEngine::updateRule(uint32_t rule)
+{
+    int truth = nodes[conditions[rule]].value.getTruth();
+    RuleState state = truth < 0 ? UNKNOWN : (truth ? MATCHED : FAILED);
+    if (state == ruleStates[rule])
+    {
+        return;
+    }
+    ruleStates[rule] = state;
+    agenda.erase(rule * 2);
+    agenda.erase(rule * 2 + 1);
+    if (state == MATCHED)
+    {
+        agenda.insert(rule * 2);
+    }
+    else if (state == FAILED && !elseActions[rule].empty())
+    {
+        agenda.insert(rule * 2 + 1);
+    }
+}
+
+void KBReteEngine::write(uint32_t slot, const KBEvalValue &value)
+{
+    memory[slot] = value;
+    for (uint32_t alpha : slotAlphas[slot])
+    {
+        enqueue(alpha);
+    }
+}
+
+const KBEvalValue &KBReteEngine::get(const string &path) const
+{
+    uint32_t slot = layout.slot(path);
+    if (slot == KBSlotLayout::NONE)
+    {
+        throw invalid_argument("Unknown attribute " + path);
+    }
+    return memory[slot];
+}
+
+size_t KBReteEngine::getAlphaCount() const
+{
+    return count_if(nodes.begin(), nodes.end(), [](const Node &node) { return node.kind == ALPHA; });
+}
+
+size_t KBReteEngine::getBetaCount() const
+{
+    return count_if(nodes.begin(), nodes.end(), [](const Node &node) { return node.kind == BETA; });
+}
+
+bool KBReteEngine::set(uint32_t slot, const KBEvalValue &value)
+{
+    checkCurrent();
+    if (slot >= memory.size())
+    {
+        throw out_of_range("Slot " + to_string(slot) + " is out of range");
+    }
+    if (memory[slot] == value)
+    {
+        return false;
+    }
+    write(slot, value);
+    propagate();
+    return true;
+}
+
+bool KBReteEngine::set(const string &path, const KBEvalValue &value)
+{
+    checkCurrent();
+    uint32_t slot = layout.slot(path);
+    if (slot == KBSlotLayout::NONE)
+    {
+        throw invalid_argument("Unknown attribute " + path);
+    }
+    return set(slot, value);
+}
+
+size_t KBReteEngine::run(size_t maxFirings)
+{
+    checkCurrent();
+    size_t count = 0;
+    vector<KBEvalValue> values;
+    while (!agenda.empty() && count < maxFirings)
+    {
+        uint32_t activation = *agenda.begin();
+        agenda.erase(agenda.begin());
+        uint32_t rule = activation / 2;
+        const vector<Action> &actions = (activation & 1) ? elseActions[rule] : thenActions[rule];
+
+        // Правые части вычисляются до первой записи, как при одновременном присваивании
+        values.clear();
+        for (const Action &action : actions)
+        {
+            values.push_back(vm.run(programs[action.program], memory.data()));
+        }
+        for (size_t i = 0; i < actions.size(); ++i)
+        {
+            if (memory[actions[i].slot] != values[i])
+            {
+                write(actions[i].slot, values[i]);
+            }
+        }
+        propagate();
+        fired.push_back(rule);
+        ++count;
+    }
+    return count;
+}
@@ -0,0 +1,392 @@
+#include "kb_rule.h"
+#include "knowledge_base.h"
+#include "utils.h"
+#include <memory>
+#include <stdexcept>
+
+using namespace std;
+
+static KBSymbol assignTag()
+{
+    static const KBSymbol ASSIGN_TAG("assign");
+    return ASSIGN_TAG;
+}
+
+static KBSymbol ruleTag()
+{
+    static const KBSymbol RULE_TAG("rule");
+    return RULE_TAG;
+}
+
+KBAssign::KBAssign(KBReference *ref, Evaluatable *value)
+    : KBEntity(assignTag()), ref(ref), value(value)
+{
+    if (!ref || !value)
+    {
+        delete ref;
+        delete value;
+        throw invalid_argument("Assignment requires a reference and a value");
+    }
+    this->ref->owner = this;
+    this->value->owner = this;
+}
+
+KBAssign::~KBAssign()
+{
+    kbDeleteChild(ref);
+    kbDeleteChild(value);
+}
+
+vector<xmlNodePtr> KBAssign::getInnerXML() const
+{
+    return {ref->toXML(), value->toXML()};
+}
+
+void KBAssign::writeInnerXML(KBXMLWriter &writer) const
+{
+    ref->writeXML(writer);
+    value->writeXML(writer);
+}
+
+Json::Value KBAssign::toJSON() const
+{
+    Json::Value json = KBEntity::toJSON();
+    json["ref"] = ref->toJSON();
+    json["value"] = value->toJSON();
+    return json;
+}
+
+void KBAssign::writeJSON(KBJSONWriter &writer) const
+{
+    writer.startObject();
+    writer.key("ref");
+    ref->writeJSON(writer);
+    writer.member("tag", getTag());
+    writer.key("value");
+    value->writeJSON(writer);
+    writer.endObject();
+}
+
+void KBAssign::writeKRL(string &out) const
+{
+    ref->writeKRL(out);
+    out += " = ";
+    value->writeKRL(out);
+}
+
+void KBAssign::collectDiagnostics(const KnowledgeBase &kb, vector<KBDiagnostic> &diagnostics) const
+{
+    size_t before = diagnostics.size();
+    ref->validate(kb, diagnostics);
+    value->validate(kb, diagnostics);
+    if (diagnostics.size() != before)
+    {
+        return;
+    }
+    if (!ref->getRef())
+    {
+        diagnostics.push_back({this, "Assignment target " + ref->getInnerKRL() + " is not an attribute"});
+        return;
+    }
+    const KBValue *constant = dynamic_cast<const KBValue *>(value);
+    const KBType *type = kb.getReferenceType(ref);
+    if (constant && type && !type->validateValue(constant->getContentAsString()))
+    {
+        diagnostics.push_back({this, "Value " + constant->getInnerKRL() + " is not valid for type " + type->getId() + " of " + ref->getInnerKRL()});
+    }
+}
+
+KBAssign *KBAssign::fromXML(xmlNodePtr node)
+{
+    xmlNodePtr refNode = xmlFirstElementChild(node);
+    xmlNodePtr valueNode = refNode ? xmlNextElementSibling(refNode) : nullptr;
+    if (!valueNode || xmlStrcmp(refNode->name, BAD_CAST "ref") != 0)
+    {
+        throw runtime_error("Assignment must contain a reference and a value");
+    }
+    unique_ptr<KBReference> ref(KBReference::fromXML(refNode));
+    Evaluatable *value = Evaluatable::fromXML(valueNode);
+    return new KBAssign(ref.release(), value);
+}
+
+KBAssign *KBAssign::fromJSON(const Json::Value &json)
+{
+    if (!json.isMember("ref") || !json.isMember("value"))
+    {
+        throw runtime_error("Assignment must contain a reference and a value");
+    }
+    unique_ptr<KBReference> ref(KBReference::fromJSON(json["ref"]));
+    Evaluatable *value = Evaluatable::fromJSON(json["value"]);
+    return new KBAssign(ref.release(), value);
+}
+
+KBRule::KBRule(KBSymbol id, Evaluatable *condition, const vector<KBAssign *> &instructions,
+               const vector<KBAssign *> &elseInstructions, const char *desc)
+    : KBIdentity(id, ruleTag(), desc), condition(condition), instructions(instructions), elseInstructions(elseInstructions)
+{
+    if (this->condition)
+    {
+        this->condition->owner = this;
+    }
+    for (KBAssign *instruction : this->instructions)
+    {
+        instruction->owner = this;
+    }
+    for (KBAssign *instruction : this->elseInstructions)
+    {
+        instruction->owner = this;
+    }
+}
+
+KBRule::~KBRule()
+{
+    kbDeleteChild(condition);
+    for (KBAssign *instruction : instructions)
+    {
+        kbDeleteChild(instruction);
+    }
+    for (KBAssign *instruction : elseInstructions)
+    {
+        kbDeleteChild(instruction);
+    }
+}
+
+void KBRule::collectAttrs(KBAttrList &attrs) const
+{
+    KBIdentity::collectAttrs(attrs);
+    attrs.set("meta", getMeta());
+}
+
+static xmlNodePtr instructionsXML(const char *name, const vector<KBAssign *> &instructions)
+{
+    xmlNodePtr node = xmlNewNode(nullptr, BAD_CAST name);
+    for (const KBAssign *instruction : instructions)
+    {
+        xmlAddChild(node, instruction->toXML());
+    }
+    return node;
+}
+
+vector<xmlNodePtr> KBRule::getInnerXML() const
+{
+    xmlNodePtr conditionNode = xmlNewNode(nullptr, BAD_CAST "condition");
+    if (condition)
+    {
+        xmlAddChild(conditionNode, condition->toXML());
+    }
+    vector<xmlNodePtr> innerXML = {conditionNode, instructionsXML("action", instructions)};
+    if (!elseInstructions.empty())
+    {
+        innerXML.push_back(instructionsXML("else-action", elseInstructions));
+    }
+    return innerXML;
+}
+
+static void writeInstructionsXML(KBXMLWriter &writer, const char *name, const vector<KBAssign *> &instructions)
+{
+    writer.startElement(name);
+    for (const KBAssign *instruction : instructions)
+    {
+        instruction->writeXML(writer);
+    }
+    writer.endElement();
+}
+
+void KBRule::writeInnerXML(KBXMLWriter &writer) const
+{
+    writer.startElement("condition");
+    if (condition)
+    {
+        condition->writeXML(writer);
+    }
+    writer.endElement();
+    writeInstructionsXML(writer, "action", instructions);
+    if (!elseInstructions.empty())
+    {
+        writeInstructionsXML(writer, "else-action", elseInstructions);
+    }
+}
+
+static Json::Value instructionsJSON(const vector<KBAssign *> &instructions)
+{
+    Json::Value json(Json::arrayValue);
+    for (const KBAssign *instruction : instructions)
+    {
+        json.append(instruction->toJSON());
+    }
+    return json;
+}
+
+Json::Value KBRule::toJSON() const
+{
+    Json::Value json = KBEntity::toJSON();
+    json["condition"] = condition ? condition->toJSON() : Json::Value();
+    json["instructions"] = instructionsJSON(instructions);
+    json["else_instructions"] = instructionsJSON(elseInstructions);
+    return json;
+}
+
+static void writeInstructionsJSON(KBJSONWriter &writer, const char *name, const vector<KBAssign *> &instructions)
+{
+    writer.key(name);
+    writer.startArray();
+    for (const KBAssign *instruction : instructions)
+    {
+        instruction->writeJSON(writer);
+    }
+    writer.endArray();
+}
+
+void KBRule::writeJSON(KBJSONWriter &writer) const
+{
+    writer.startObject();
+    writer.key("condition");
+    if (condition)
+    {
+        condition->writeJSON(writer);
+    }
+    else
+    {
+        writer.null();
+    }
+    if (getDesc() != nullptr)
+    {
+        writer.member("desc", getDesc());
+    }
+    writeInstructionsJSON(writer, "else_instructions", elseInstructions);
+    writer.member("id", getId());
+    writeInstructionsJSON(writer, "instructions", instructions);
+    writer.member("meta", getMeta());
+    writer.member("tag", getTag());
+    writer.endObject();
+}
+
+void KBRule::writeKRL(string &out) const
+{
+    out += "ПРАВИЛО ";
+    out += getId();
+    out += "\nЕСЛИ\n    ";
+    if (condition)
+    {
+        condition->writeKRL(out);
+    }
+    out += "\nТО\n";
+    for (const KBAssign *instruction : instructions)
+    {
+        out += "    ";
+        instruction->writeKRL(out);
+        out += '\n';
+    }
+    if (!elseInstructions.empty())
+    {
+        out += "ИНАЧЕ\n";
+        for (const KBAssign *instruction : elseInstructions)
+        {
+            out += "    ";
+            instruction->writeKRL(out);
+            out += '\n';
+        }
+    }
+    out += "КОММЕНТАРИЙ ";
+    out += getDesc() != nullptr ? getDesc() : getId().c_str();
+    out += '\n';
+}
+
+void KBRule::collectDiagnostics(const KnowledgeBase &kb, vector<KBDiagnostic> &diagnostics) const
+{
+    if (condition)
+    {
+        condition->validate(kb, diagnostics);
+    }
+    else
+    {
+        diagnostics.push_back({this, "Rule " + getId() + " has no condition"});
+    }
+    for (KBAssign *instruction : instructions)
+    {
+        instruction->validate(kb, diagnostics);
+    }
+    for (KBAssign *instruction : elseInstructions)
+    {
+        instruction->validate(kb, diagnostics);
+    }
+}
+
+// Владение действиями передается правилу только после разбора всех частей
+struct KBRuleParts
+{
+    unique_ptr<Evaluatable> condition;
+    vector<unique_ptr<KBAssign>> instructions;
+    vector<unique_ptr<KBAssign>> elseInstructions;
+
+    KBRule *build(KBSymbol id, const char *desc)
+    {
+        vector<KBAssign *> then, otherwise;
+        for (auto &instruction : instructions)
+        {
+            then.push_back(instruction.get());
+        }
+        for (auto &instruction : elseInstructions)
+        {
+            otherwise.push_back(instruction.get());
+        }
+        KBRule *rule = new KBRule(id, condition.get(), then, otherwise, desc);
+        condition.release();
+        for (auto &instruction : instructions)
+        {
+            instruction.release();
+        }
+        for (auto &instruction : elseInstructions)
+        {
+            instruction.release();
+        }
+        return rule;
+    }
+};
+
+KBRule *KBRule::fromXML(xmlNodePtr node)
+{
+    string id, desc;
+    xmlProp(node, "id", id);
+    bool hasDesc = xmlProp(node, "desc", desc);
+    KBRuleParts parts;
+    for (xmlNodePtr child = xmlFirstElementChild(node); child; child = xmlNextElementSibling(child))
+    {
+        if (xmlStrcmp(child->name, BAD_CAST "condition") == 0)
+        {
+            xmlNodePtr expression = xmlFirstElementChild(child);
+            if (expression)
+            {
+                parts.condition.reset(Evaluatable::fromXML(expression));
+            }
+        }
+        else if (xmlStrcmp(child->name, BAD_CAST "action") == 0 || xmlStrcmp(child->name, BAD_CAST "else-action") == 0)
+        {
+            auto &target = child->name[0] == 'a' ? parts.instructions : parts.elseInstructions;
+            for (xmlNodePtr assign = xmlFirstElementChild(child); assign; assign = xmlNextElementSibling(assign))
+            {
+                target.emplace_back(KBAssign::fromXML(assign));
+            }
+        }
+    }
+    return parts.build(id, hasDesc ? desc.c_str() : nullptr);
+}
+
+KBRule *KBRule::fromJSON(const Json::Value &json)
+{
+    KBRuleParts parts;
+    if (!json["condition"].isNull())
+    {
+        parts.condition.reset(Evaluatable::fromJSON(json["condition"]));
+    }
+    for (const Json::Value &instruction : json["instructions"])
+    {
+        parts.instructions.emplace_back(KBAssign::fromJSON(instruction));
+    }
+    for (const Json::Value &instruction : json["else_instructions"])
+    {
+        parts.elseInstructions.emplace_back(KBAssign::fromJSON(instruction));
+    }
+    const char *desc = json["desc"].isNull() ? nullptr : json["desc"].asCString();
+    return parts.build(json["id"].asString(), desc);
+}
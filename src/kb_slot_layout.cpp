@@ -0,0 +1,155 @@
+#include "kb_slot_layout.h"
+#include "knowledge_base.h"
+#include "kb_operation.h"
+#include "kb_reference.h"
+#include <stdexcept>
+#include <algorithm>
+
+using namespace std;
+
+void KBSlotLayout::rebuild(const KnowledgeBase &kb)
+{
+    this->kb = &kb;
+    schemaVersion = kb.getSchemaVersion();
+    objectBase.clear();
+    paths.clear();
+    objectBase.reserve(kb.getObjects().size());
+    for (const KBObject *object : kb.getObjects())
+    {
+        objectBase.push_back((uint32_t)paths.size());
+        for (const KBProperty *property : object->getProperties())
+        {
+            paths.push_back(object->getId() + "." + property->getId());
+        }
+    }
+}
+
+bool KBSlotLayout::isCurrent() const
+{
+    return kb != nullptr && kb->getSchemaVersion() == schemaVersion;
+}
+
+void KBSlotLayout::checkCurrent() const
+{
+    if (!isCurrent())
+    {
+        throw logic_error("Slot layout is out of date with the knowledge base schema");
+    }
+}
+
+uint32_t KBSlotLayout::slot(KBSymbol object, KBSymbol property) const
+{
+    checkCurrent();
+    uint32_t objectIndex = kb->getObjectIndex(object);
+    if (objectIndex == KBSymbolIndex::NOT_FOUND)
+    {
+        return NONE;
+    }
+    uint32_t propertyIndex = kb->getObjects()[objectIndex]->getPropertyIndex(property);
+    if (propertyIndex == KBSymbolIndex::NOT_FOUND)
+    {
+        return NONE;
+    }
+    return objectBase[objectIndex] + propertyIndex;
+}
+
+uint32_t KBSlotLayout::slot(string_view path) const
+{
+    size_t dot = path.find('.');
+    if (dot == string_view::npos)
+    {
+        return NONE;
+    }
+    return slot(KBSymbol(path.substr(0, dot)), KBSymbol(path.substr(dot + 1)));
+}
+
+uint32_t KBSlotLayout::resolve(const KBReference *ref) const
+{
+    checkCurrent();
+    if (!ref || !ref->getRef() || ref->getRef()->getRef())
+    {
+        return NONE;
+    }
+    uint32_t bound = ref->getSlot(kb, schemaVersion);
+    if (bound != KBReference::NO_SLOT)
+    {
+        return bound;
+    }
+    return slot(ref->getIdSymbol(), ref->getRef()->getIdSymbol());
+}
+
+uint32_t KBSlotLayout::require(const KBReference *ref) const
+{
+    uint32_t index = resolve(ref);
+    if (index == NONE)
+    {
+        throw invalid_argument("Cannot resolve reference " + KBProgram::referencePath(ref) + " to a slot");
+    }
+    return index;
+}
+
+void KBSlotLayout::collectSlots(const Evaluatable *root, vector<uint32_t> &slots) const
+{
+    if (const KBReference *ref = dynamic_cast<const KBReference *>(root))
+    {
+        uint32_t index = require(ref);
+        if (find(slots.begin(), slots.end(), index) == slots.end())
+        {
+            slots.push_back(index);
+        }
+    }
+    else if (const KBOperation *op = dynamic_cast<const KBOperation *>(root))
+    {
+        collectSlots(op->getLeft(), slots);
+        if (op->getRight())
+        {
+            collectSlots(op->getRight(), slots);
+        }
+    }
+}
+
+size_t KBSlotLayout::bindReferences(const Evaluatable *root) const
+{
+    if (!root)
+    {
+        return 0;
+    }
+    if (const KBReference *ref = dynamic_cast<const KBReference *>(root))
+    {
+        uint32_t index = resolve(ref);
+        ref->bindSlot(index, kb, schemaVersion);
+        return index == NONE ? 1 : 0;
+    }
+    if (const KBOperation *op = dynamic_cast<const KBOperation *>(root))
+    {
+        return bindReferences(op->getLeft()) + bindReferences(op->getRight());
+    }
+    return 0;
+}
+
+size_t KBSlotLayout::bindReferences(const KBRule *rule) const
+{
+    size_t unresolved = bindReferences(rule->getCondition());
+    for (const vector<KBAssign *> *instructions : {&rule->getInstructions(), &rule->getElseInstructions()})
+    {
+        for (const KBAssign *assign : *instructions)
+        {
+            unresolved += bindReferences(assign->getRef()) + bindReferences(assign->getValue());
+        }
+    }
+    return unresolved;
+}
+
+vector<KBEvalValue> KBSlotLayout::bind(const map<string, KBEvalValue> &facts) const
+{
+    vector<KBEvalValue> memory(paths.size());
+    for (size_t i = 0; i < paths.size(); ++i)
+    {
+        auto it = facts.find(paths[i]);
+        if (it != facts.end())
+        {
+            memory[i] = it->second;
+        }
+    }
+    return memory;
+}
@@ -0,0 +1,525 @@
+#include "kb_snapshot.h"
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+
+static const char SNAPSHOT_MAGIC[8] = {'K', 'B', 'S', 'N', 'A', 'P', 0, 0};
+static constexpr uint32_t BYTE_ORDER_MARK = 0x01020304;
+static constexpr size_t SECTION_COUNT = static_cast<size_t>(KBSnapshotSection::COUNT);
+static constexpr size_t SECTION_ALIGN = 8;
+
+static size_t align(size_t value)
+{
+    return (value + SECTION_ALIGN - 1) & ~(SECTION_ALIGN - 1);
+}
+
+// Размер элемента каждой секции
+static constexpr size_t SECTION_ITEM_SIZE[SECTION_COUNT] = {
+    sizeof(char),
+    sizeof(uint32_t),
+    sizeof(KBSnapshotType),
+    sizeof(uint32_t),
+    sizeof(KBSnapshotMF),
+    sizeof(KBSnapshotPoint),
+    sizeof(KBSnapshotNonFactor),
+    sizeof(KBSnapshotNode),
+    sizeof(uint32_t),
+};
+
+// KBSnapshotWriter
+
+KBSnapshotWriter::KBSnapshotWriter()
+{
+    // Символ 0 - пустая строка
+    strings.push_back('\0');
+    symbols.push_back(0);
+    symbolIndex.emplace(string(), 0);
+}
+
+uint32_t KBSnapshotWriter::symbol(const string &value)
+{
+    auto it = symbolIndex.find(value);
+    if (it != symbolIndex.end())
+    {
+        return it->second;
+    }
+    uint32_t index = symbols.size();
+    symbols.push_back(strings.size());
+    strings.append(value);
+    strings.push_back('\0');
+    symbolIndex.emplace(value, index);
+    return index;
+}
+
+void KBSnapshotWriter::addType(const KBType *type)
+{
+    KBSnapshotType record = {};
+    record.id = symbol(type->getId());
+    record.desc = type->getDesc() != nullptr ? symbol(type->getDesc()) : KB_SNAPSHOT_NONE;
+    record.kind = KBSnapshotTypeKind::ABSTRACT;
+
+    if (const KBNumericType *numeric = dynamic_cast<const KBNumericType *>(type))
+    {
+        record.kind = KBSnapshotTypeKind::NUMERIC;
+        record.from = numeric->getFrom();
+        record.to = numeric->getTo();
+    }
+    else if (const KBSymbolicType *symbolic = dynamic_cast<const KBSymbolicType *>(type))
+    {
+        record.kind = KBSnapshotTypeKind::SYMBOLIC;
+        record.first = values.size();
+        for (KBSymbol value : symbolic->getValueSymbols())
+        {
+            values.push_back(symbol(value.str()));
+        }
+        record.count = values.size() - record.first;
+    }
+    else if (const KBFuzzyType *fuzzy = dynamic_cast<const KBFuzzyType *>(type))
+    {
+        record.kind = KBSnapshotTypeKind::FUZZY;
+        record.first = mfs.size();
+        for (const MembershipFunction *mf : fuzzy->getMembershipFunctionList())
+        {
+            KBSnapshotMF mfRecord = {};
+            mfRecord.name = symbol(mf->name);
+            mfRecord.min = mf->min;
+            mfRecord.max = mf->max;
+            mfRecord.firstPoint = points.size();
+            for (const MFPoint *point : mf->points)
+            {
+                points.push_back({point->x, point->y});
+            }
+            mfRecord.pointCount = points.size() - mfRecord.firstPoint;
+            mfs.push_back(mfRecord);
+        }
+        record.count = mfs.size() - record.first;
+    }
+    types.push_back(record);
+}
+
+// Узлы пишутся в обратном порядке обхода: потомки всегда имеют меньший индекс, чем родитель
+uint32_t KBSnapshotWriter::addNode(const Evaluatable *node)
+{
+    KBSnapshotNode record = {};
+    record.nonFactor = KB_SNAPSHOT_NONE;
+    record.left = KB_SNAPSHOT_NONE;
+    record.right = KB_SNAPSHOT_NONE;
+    record.convertNonFactor = node->getConvertNonFactor();
+    if (node->hasOwnNonFactor())
+    {
+        KBNonFactorValue value = node->getNonFactorValue();
+        record.nonFactor = nonFactors.size();
+        nonFactors.push_back({value.belief, value.probability, value.accuracy});
+    }
+
+    if (const KBOperation *operation = dynamic_cast<const KBOperation *>(node))
+    {
+        record.kind = KBSnapshotNodeKind::OPERATION;
+        record.op = operation->getOperator();
+        record.left = addNode(operation->getLeft());
+        if (operation->isBinary() && operation->getRight())
+        {
+            record.right = addNode(operation->getRight());
+        }
+    }
+    else if (const KBReference *reference = dynamic_cast<const KBReference *>(node))
+    {
+        record.kind = KBSnapshotNodeKind::REFERENCE;
+        record.left = symbol(reference->getId());
+        if (reference->getRef())
+        {
+            record.right = addNode(reference->getRef());
+        }
+    }
+    else if (const KBNumericValue *numeric = dynamic_cast<const KBNumericValue *>(node))
+    {
+        record.kind = KBSnapshotNodeKind::NUMBER;
+        record.number = numeric->getContent();
+    }
+    else if (const KBBooleanValue *boolean = dynamic_cast<const KBBooleanValue *>(node))
+    {
+        record.kind = KBSnapshotNodeKind::BOOLEAN;
+        record.left = boolean->getContent() ? 1 : 0;
+    }
+    else if (const KBSymbolicValue *symbolic = dynamic_cast<const KBSymbolicValue *>(node))
+    {
+        record.kind = KBSnapshotNodeKind::SYMBOL;
+        record.left = symbol(symbolic->getContentAsString());
+    }
+    else
+    {
+        throw invalid_argument("Unsupported evaluatable " + node->getTag() + " in snapshot");
+    }
+    nodes.push_back(record);
+    return nodes.size() - 1;
+}
+
+void KBSnapshotWriter::addExpression(const Evaluatable *expression)
+{
+    expressions.push_back(addNode(expression));
+}
+
+string KBSnapshotWriter::serialize() const
+{
+    const void *sources[SECTION_COUNT] = {
+        strings.data(), symbols.data(), types.data(), values.data(), mfs.data(),
+        points.data(), nonFactors.data(), nodes.data(), expressions.data()};
+    const size_t counts[SECTION_COUNT] = {
+        strings.size(), symbols.size(), types.size(), values.size(), mfs.size(),
+        points.size(), nonFactors.size(), nodes.size(), expressions.size()};
+
+    KBSnapshotHeader header = {};
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    header.version = KB_SNAPSHOT_VERSION;
+    header.byteOrder = BYTE_ORDER_MARK;
+
+    size_t offset = align(sizeof(KBSnapshotHeader));
+    for (size_t i = 0; i < SECTION_COUNT; ++i)
+    {
+        header.sections[i].offset = offset;
+        header.sections[i].count = counts[i];
+        offset = align(offset + counts[i] * SECTION_ITEM_SIZE[i]);
+    }
+    header.fileSize = offset;
+
+    string result(offset, '\0');
+    memcpy(&result[0], &header, sizeof(header));
+    for (size_t i = 0; i < SECTION_COUNT; ++i)
+    {
+        if (counts[i] > 0)
+        {
+            memcpy(&result[header.sections[i].offset], sources[i], counts[i] * SECTION_ITEM_SIZE[i]);
+        }
+    }
+    return result;
+}
+
+void KBSnapshotWriter::writeToFile(const string &path) const
+{
+    string data = serialize();
+    ofstream file(path, ios::binary | ios::trunc);
+    if (!file || !file.write(data.data(), data.size()))
+    {
+        throw runtime_error("Couldn't write snapshot " + path);
+    }
+}
+
+// KBSnapshot
+
+KBSnapshot::KBSnapshot(const string &data) : buffer(data)
+{
+    open(buffer.data(), buffer.size());
+}
+
+KBSnapshot *KBSnapshot::fromFile(const string &path)
+{
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        throw runtime_error("Couldn't open snapshot " + path);
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0)
+    {
+        close(fd);
+        throw runtime_error("Couldn't read snapshot " + path);
+    }
+    void *data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+    {
+        throw runtime_error("Couldn't map snapshot " + path);
+    }
+
+    unique_ptr<KBSnapshot> result(new KBSnapshot());
+    result->mapped = data;
+    result->mappedSize = st.st_size;
+    result->open(static_cast<const char *>(data), st.st_size);
+    return result.release();
+}
+
+KBSnapshot::~KBSnapshot()
+{
+    if (mapped)
+    {
+        munmap(mapped, mappedSize);
+    }
+}
+
+void KBSnapshot::open(const char *data, size_t size)
+{
+    if (size < sizeof(KBSnapshotHeader) || reinterpret_cast<uintptr_t>(data) % SECTION_ALIGN != 0)
+    {
+        throw runtime_error("Invalid snapshot: truncated header");
+    }
+    const KBSnapshotHeader *header = reinterpret_cast<const KBSnapshotHeader *>(data);
+    if (memcmp(header->magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0)
+    {
+        throw runtime_error("Invalid snapshot: bad magic");
+    }
+    if (header->byteOrder != BYTE_ORDER_MARK)
+    {
+        throw runtime_error("Invalid snapshot: incompatible byte order");
+    }
+    if (header->version != KB_SNAPSHOT_VERSION)
+    {
+        throw runtime_error("Unsupported snapshot version " + to_string(header->version));
+    }
+    if (header->fileSize != size)
+    {
+        throw runtime_error("Invalid snapshot: size mismatch");
+    }
+    for (size_t i = 0; i < SECTION_COUNT; ++i)
+    {
+        const KBSnapshotSectionInfo &info = header->sections[i];
+        if (info.offset % SECTION_ALIGN != 0 || info.offset > size ||
+            info.count > (size - info.offset) / SECTION_ITEM_SIZE[i])
+        {
+            throw runtime_error("Invalid snapshot: section " + to_string(i) + " out of bounds");
+        }
+    }
+    const KBSnapshotSectionInfo &stringsInfo = header->sections[static_cast<size_t>(KBSnapshotSection::STRINGS)];
+    if (stringsInfo.count == 0 || data[stringsInfo.offset + stringsInfo.count - 1] != '\0')
+    {
+        throw runtime_error("Invalid snapshot: unterminated strings");
+    }
+    const KBSnapshotSectionInfo &symbolsInfo = header->sections[static_cast<size_t>(KBSnapshotSection::SYMBOLS)];
+    const uint32_t *offsets = reinterpret_cast<const uint32_t *>(data + symbolsInfo.offset);
+    for (size_t i = 0; i < symbolsInfo.count; ++i)
+    {
+        if (offsets[i] >= stringsInfo.count)
+        {
+            throw runtime_error("Invalid snapshot: symbol out of bounds");
+        }
+    }
+
+    this->data = data;
+    this->size = size;
+    this->header = header;
+    // Символы снимка переводятся в глобальную таблицу при открытии: после этого снимок только читается
+    // и может использоваться из нескольких потоков
+    symbolCache.clear();
+    symbolCache.reserve(symbolsInfo.count);
+    for (uint32_t i = 0; i < symbolsInfo.count; ++i)
+    {
+        symbolCache.push_back(KBSymbol(getString(i)));
+    }
+}
+
+string_view KBSnapshot::getString(uint32_t symbol) const
+{
+    if (symbol >= getCount(KBSnapshotSection::SYMBOLS))
+    {
+        throw out_of_range("Unknown snapshot symbol " + to_string(symbol));
+    }
+    uint32_t offset = section<uint32_t>(KBSnapshotSection::SYMBOLS)[symbol];
+    return string_view(section<char>(KBSnapshotSection::STRINGS) + offset);
+}
+
+KBSymbol KBSnapshot::getSymbol(uint32_t symbol) const
+{
+    if (symbol >= symbolCache.size())
+    {
+        throw out_of_range("Unknown snapshot symbol " + to_string(symbol));
+    }
+    return symbolCache[symbol];
+}
+
+KBType *KBSnapshot::materializeType(size_t index) const
+{
+    if (index >= getTypeCount())
+    {
+        throw out_of_range("Snapshot type index out of range");
+    }
+    const KBSnapshotType &record = getTypes()[index];
+    KBSymbol id = getSymbol(record.id);
+    string desc;
+    if (record.desc != KB_SNAPSHOT_NONE)
+    {
+        desc = getString(record.desc);
+    }
+    const char *descStr = record.desc != KB_SNAPSHOT_NONE ? desc.c_str() : nullptr;
+
+    switch (record.kind)
+    {
+    case KBSnapshotTypeKind::ABSTRACT:
+        return new KBType(id, descStr);
+    case KBSnapshotTypeKind::NUMERIC:
+        return new KBNumericType(id, record.from, record.to, descStr);
+    case KBSnapshotTypeKind::SYMBOLIC:
+    {
+        if (record.first > getCount(KBSnapshotSection::VALUES) || record.count > getCount(KBSnapshotSection::VALUES) - record.first)
+        {
+            throw runtime_error("Invalid snapshot: type values out of bounds");
+        }
+        const uint32_t *symbols = section<uint32_t>(KBSnapshotSection::VALUES) + record.first;
+        vector<string> values;
+        values.reserve(record.count);
+        for (uint32_t i = 0; i < record.count; ++i)
+        {
+            values.push_back(getSymbol(symbols[i]).str());
+        }
+        return new KBSymbolicType(id, values, descStr);
+    }
+    case KBSnapshotTypeKind::FUZZY:
+    {
+        if (record.first > getCount(KBSnapshotSection::MFS) || record.count > getCount(KBSnapshotSection::MFS) - record.first)
+        {
+            throw runtime_error("Invalid snapshot: membership functions out of bounds");
+        }
+        vector<MembershipFunction *> mfs;
+        vector<MFPoint *> points;
+        for (uint32_t i = 0; i < record.count; ++i)
+        {
+            const KBSnapshotMF &mf = getMembershipFunctions()[record.first + i];
+            if (mf.firstPoint > getCount(KBSnapshotSection::POINTS) || mf.pointCount > getCount(KBSnapshotSection::POINTS) - mf.firstPoint)
+            {
+                for (MembershipFunction *created : mfs)
+                {
+                    delete created;
+                }
+                throw runtime_error("Invalid snapshot: points out of bounds");
+            }
+            for (uint32_t p = 0; p < mf.pointCount; ++p)
+            {
+                const KBSnapshotPoint &point = getPoints()[mf.firstPoint + p];
+                points.push_back(new MFPoint(point.x, point.y));
+            }
+            mfs.push_back(new MembershipFunction(string(getString(mf.name)), mf.min, mf.max, points));
+            for (MFPoint *point : points)
+            {
+                delete point;
+            }
+            points.clear();
+        }
+        KBFuzzyType *type = new KBFuzzyType(id, mfs, descStr);
+        for (MembershipFunction *mf : mfs)
+        {
+            delete mf;
+        }
+        return type;
+    }
+    }
+    throw runtime_error("Invalid snapshot: unknown type kind");
+}
+
+vector<KBType *> KBSnapshot::materializeTypes() const
+{
+    vector<KBType *> types;
+    types.reserve(getTypeCount());
+    try
+    {
+        for (size_t i = 0; i < getTypeCount(); ++i)
+        {
+            types.push_back(materializeType(i));
+        }
+    }
+    catch (...)
+    {
+        for (KBType *type : types)
+        {
+            delete type;
+        }
+        throw;
+    }
+    return types;
+}
+
+const KBSnapshotNode &KBSnapshot::node(uint32_t index) const
+{
+    if (index >= getCount(KBSnapshotSection::NODES))
+    {
+        throw runtime_error("Invalid snapshot: node out of bounds");
+    }
+    return getNodes()[index];
+}
+
+Evaluatable *KBSnapshot::materializeNode(uint32_t index) const
+{
+    const KBSnapshotNode &record = node(index);
+    // Потомки записываются раньше родителя, это исключает циклы в поврежденном файле
+    auto child = [&](uint32_t childIndex) -> Evaluatable *
+    {
+        if (childIndex >= index)
+        {
+            throw runtime_error("Invalid snapshot: malformed expression");
+        }
+        return materializeNode(childIndex);
+    };
+
+    unique_ptr<Evaluatable> result;
+    switch (record.kind)
+    {
+    case KBSnapshotNodeKind::NUMBER:
+        result.reset(new KBNumericValue(record.number));
+        break;
+    case KBSnapshotNodeKind::BOOLEAN:
+        result.reset(new KBBooleanValue(record.left != 0));
+        break;
+    case KBSnapshotNodeKind::SYMBOL:
+        result.reset(new KBSymbolicValue(getSymbol(record.left)));
+        break;
+    case KBSnapshotNodeKind::REFERENCE:
+    {
+        unique_ptr<Evaluatable> next;
+        if (record.right != KB_SNAPSHOT_NONE)
+        {
+            next.reset(child(record.right));
+            if (!dynamic_cast<KBReference *>(next.get()))
+            {
+                throw runtime_error("Invalid snapshot: reference path must consist of references");
+            }
+        }
+        result.reset(new KBReference(getSymbol(record.left), static_cast<KBReference *>(next.release())));
+        break;
+    }
+    case KBSnapshotNodeKind::OPERATION:
+    {
+        if (static_cast<size_t>(record.op) >= KB_OPERATORS_COUNT)
+        {
+            throw runtime_error("Invalid snapshot: unknown operator");
+        }
+        const KBOperatorInfo &info = operatorInfo(record.op);
+        unique_ptr<Evaluatable> left(child(record.left));
+        unique_ptr<Evaluatable> right;
+        if (info.binary)
+        {
+            right.reset(child(record.right));
+        }
+        Evaluatable *l = left.release();
+        result.reset(new KBOperation(info.signs[0], l, right.release()));
+        break;
+    }
+    default:
+        throw runtime_error("Invalid snapshot: unknown node kind");
+    }
+
+    if (record.nonFactor != KB_SNAPSHOT_NONE)
+    {
+        if (record.nonFactor >= getCount(KBSnapshotSection::NON_FACTORS))
+        {
+            throw runtime_error("Invalid snapshot: non-factor out of bounds");
+        }
+        const KBSnapshotNonFactor &value = section<KBSnapshotNonFactor>(KBSnapshotSection::NON_FACTORS)[record.nonFactor];
+        NonFactor nonFactor(value.belief, value.probability, value.accuracy);
+        result->setNonFactor(&nonFactor);
+    }
+    result->setConvertNonFactor(record.convertNonFactor != 0);
+    return result.release();
+}
+
+Evaluatable *KBSnapshot::materializeExpression(size_t index) const
+{
+    if (index >= getExpressionCount())
+    {
+        throw out_of_range("Snapshot expression index out of range");
+    }
+    return materializeNode(section<uint32_t>(KBSnapshotSection::EXPRESSIONS)[index]);
+}
@@ -0,0 +1,113 @@
+#include "kb_symbol.h"
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <stdexcept>
+
+using namespace std;
+
+// Строки хранятся блоками фиксированного размера: адреса строк не меняются при добавлении,
+// поэтому чтение по дескриптору не требует блокировки.
+static constexpr uint32_t CHUNK_BITS = 12;
+static constexpr uint32_t CHUNK_SIZE = 1u << CHUNK_BITS;
+static constexpr uint32_t MAX_CHUNKS = 1u << 16;
+
+namespace
+{
+    struct SymbolStorage
+    {
+        atomic<string *> chunks[MAX_CHUNKS] = {};
+        atomic<uint32_t> count{0};
+        unordered_map<string_view, uint32_t> index;
+        shared_mutex mutex;
+
+        SymbolStorage()
+        {
+            // Дескриптор 0 зарезервирован за пустой строкой
+            chunks[0].store(new string[CHUNK_SIZE], memory_order_release);
+            index.emplace(string_view(), 0);
+            count.store(1, memory_order_release);
+        }
+    };
+
+    // Таблица не разрушается при завершении программы: символы могут понадобиться деструкторам статических объектов
+    SymbolStorage &storage()
+    {
+        static SymbolStorage *instance = new SymbolStorage();
+        return *instance;
+    }
+}
+
+uint32_t KBSymbolTable::intern(string_view value)
+{
+    SymbolStorage &s = storage();
+    {
+        shared_lock<shared_mutex> lock(s.mutex);
+        auto it = s.index.find(value);
+        if (it != s.index.end())
+        {
+            return it->second;
+        }
+    }
+
+    unique_lock<shared_mutex> lock(s.mutex);
+    auto it = s.index.find(value);
+    if (it != s.index.end())
+    {
+        return it->second;
+    }
+    uint32_t id = s.count.load(memory_order_relaxed);
+    uint32_t chunk = id >> CHUNK_BITS;
+    if (chunk >= MAX_CHUNKS)
+    {
+        throw overflow_error("Symbol table is full");
+    }
+    string *block = s.chunks[chunk].load(memory_order_relaxed);
+    if (!block)
+    {
+        block = new string[CHUNK_SIZE];
+        s.chunks[chunk].store(block, memory_order_release);
+    }
+    string &stored = block[id & (CHUNK_SIZE - 1)];
+    stored.assign(value.data(), value.size());
+    s.index.emplace(string_view(stored), id);
+    s.count.store(id + 1, memory_order_release);
+    return id;
+}
+
+const string &KBSymbolTable::lookup(uint32_t id)
+{
+    SymbolStorage &s = storage();
+    if (id >= s.count.load(memory_order_acquire))
+    {
+        throw out_of_range("Unknown symbol id " + to_string(id));
+    }
+    return s.chunks[id >> CHUNK_BITS].load(memory_order_acquire)[id & (CHUNK_SIZE - 1)];
+}
+
+bool KBSymbolTable::contains(uint32_t id)
+{
+    return id < storage().count.load(memory_order_acquire);
+}
+
+size_t KBSymbolTable::size()
+{
+    return storage().count.load(memory_order_acquire);
+}
+
+KBSymbol::KBSymbol(string_view value) : id(value.empty() ? 0 : KBSymbolTable::intern(value)) {}
+
+KBSymbol KBSymbol::fromId(uint32_t id)
+{
+    if (!KBSymbolTable::contains(id))
+    {
+        throw out_of_range("Unknown symbol id " + to_string(id));
+    }
+    return KBSymbol(id, true);
+}
+
+const string &KBSymbol::str() const
+{
+    return KBSymbolTable::lookup(id);
+}
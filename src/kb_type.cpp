@@ -7,7 +7,11 @@
 #include <libxml/tree.h>
 #include <json/value.h>
 #include <sstream>
+#include <algorithm>
+#include <memory>
 #include "utils.h"
+#include "kb_krl_parser.h"
+#include "knowledge_base.h"
 
 using namespace std;
 
@@ -27,38 +31,58 @@ string join(const vector<string> &values, const string &delimiter)
 
 // KBType implementation
 
-KBType::KBType(const string id, const char *desc)
+KBType::KBType(KBSymbol id, const char *desc)
     : KBIdentity(id, "type", desc) {}
 
-string KBType::KRL() const
+void KBType::writeKRL(string &out) const
 {
-    stringstream ss;
-    ss << "ТИП " << getId() << endl;
-    ss << getKRLType() << endl;
-
-    string innerKRL = getInnerKRL();
-    if (!innerKRL.empty()) {
-        ss << innerKRL << endl;
+    out += "ТИП ";
+    out += getId();
+    out += '\n';
+    out += getKRLType();
+    out += '\n';
+
+    size_t innerStart = out.size();
+    writeInnerKRL(out);
+    if (out.size() != innerStart) {
+        out += '\n';
     }
-    ss << "КОММЕНТАРИЙ " << (getDesc() != nullptr ? getDesc() : getId()) << endl;
-    return ss.str();
+    out += "КОММЕНТАРИЙ ";
+    out += getDesc() != nullptr ? getDesc() : getId().c_str();
+    out += '\n';
+}
+
+string KBType::getInnerKRL() const
+{
+    string result;
+    writeInnerKRL(result);
+    return result;
 }
 
-map<string, string> KBType::getAttrs() const
+void KBType::collectAttrs(KBAttrList &attrs) const
 {
-    map<string, string> attrs = KBIdentity::getAttrs();
-    attrs["meta"] = getMeta();
-    attrs["desc"] = getDesc() != nullptr ? string(getDesc()) : getId();
-    return attrs;
+    KBIdentity::collectAttrs(attrs);
+    attrs.set("meta", getMeta());
+    attrs.set("desc", getDesc() != nullptr ? string(getDesc()) : getId());
 }
 
 KBType *KBType::fromXML(xmlNodePtr node)
 {
-    string meta = (const char *)xmlGetProp(node, BAD_CAST "meta");
+    string meta;
+    xmlProp(node, "meta", meta);
     if (meta == "numeric" || meta == "number")
         return KBNumericType::fromXML(node);
     else if (meta == "string" || meta == "symbolic")
         return KBSymbolicType::fromXML(node);
+    else if (meta == "fuzzy")
+        return KBFuzzyType::fromXML(node);
+    else if (meta == "abstract")
+    {
+        string id, desc;
+        xmlProp(node, "id", id);
+        bool hasDesc = xmlProp(node, "desc", desc);
+        return new KBType(id, hasDesc ? desc.c_str() : nullptr);
+    }
     return nullptr;
 }
 
@@ -69,9 +93,21 @@ KBType *KBType::fromJSON(const Json::Value &json)
         return KBNumericType::fromJSON(json);
     else if (meta == "string" || meta == "symbolic")
         return KBSymbolicType::fromJSON(json);
+    else if (meta == "fuzzy")
+        return KBFuzzyType::fromJSON(json);
+    else if (meta == "abstract")
+        return new KBType(json["id"].asString(), json["desc"].isNull() ? nullptr : json["desc"].asCString());
     return nullptr;
 }
 
+KBType *KBType::fromKRL(const string &krl)
+{
+    KBKRLParser parser(krl);
+    unique_ptr<KBType> type(parser.parseType());
+    parser.expectEnd();
+    return type.release();
+}
+
 string KBType::getXMLOwnerPath() const
 {
     // This should be implemented based on your specific XML structure.
@@ -81,23 +117,22 @@ string KBType::getXMLOwnerPath() const
 
 // KBNumericType implementation
 
-KBNumericType::KBNumericType(const string id, double from, double to, const char *desc)
+KBNumericType::KBNumericType(KBSymbol id, double from, double to, const char *desc)
     : KBType(id, desc), from(from), to(to) {}
 
-string KBNumericType::getInnerKRL() const
+void KBNumericType::writeInnerKRL(string &out) const
 {
-    stringstream ss;
-    ss << "ОТ " << from << endl;
-    ss << "ДО " << to;
-    return ss.str();
+    out += "ОТ ";
+    appendDouble(out, from);
+    out += "\nДО ";
+    appendDouble(out, to);
 }
 
-map<string, string> KBNumericType::getAttrs() const
+void KBNumericType::collectAttrs(KBAttrList &attrs) const
 {
-    map<string, string> attrs = KBType::getAttrs();
-    attrs["from"] = doubleToString(from);
-    attrs["to"] = doubleToString(to);
-    return attrs;
+    KBType::collectAttrs(attrs);
+    attrs.set("from", doubleToString(from));
+    attrs.set("to", doubleToString(to));
 }
 
 vector<xmlNodePtr> KBNumericType::getInnerXML() const
@@ -114,6 +149,12 @@ vector<xmlNodePtr> KBNumericType::getInnerXML() const
     return innerXML;
 }
 
+void KBNumericType::writeInnerXML(KBXMLWriter &writer) const
+{
+    writer.textElement("from", doubleToString(from));
+    writer.textElement("to", doubleToString(to));
+}
+
 Json::Value KBNumericType::toJSON() const 
 { 
     Json::Value json = KBType::toJSON();
@@ -122,30 +163,63 @@ Json::Value KBNumericType::toJSON() const
     return json;
 }
 
+void KBNumericType::writeJSON(KBJSONWriter &writer) const
+{
+    writer.startObject();
+    writer.member("desc", getComment());
+    writer.member("from", from);
+    writer.member("id", getId());
+    writer.member("meta", getMeta());
+    writer.member("tag", getTag());
+    writer.member("to", to);
+    writer.endObject();
+}
+
 bool KBNumericType::validateValue(const string &value) const
 {
-    // Placeholder implementation
-    // Implement proper validation logic
-    return true;
+    double number = 0.0;
+    return parseDecimal(value, number) && number >= from && number <= to;
+}
+
+void KBNumericType::collectDiagnostics(const KnowledgeBase &, vector<KBDiagnostic> &diagnostics) const
+{
+    if (!(from <= to))
+    {
+        diagnostics.push_back({this, "Invalid range of type " + getId() + ": from " + doubleToString(from) + " to " + doubleToString(to)});
+    }
 }
 
 KBNumericType *KBNumericType::fromXML(xmlNodePtr node)
 {
-    string id = (const char *)xmlGetProp(node, BAD_CAST "id");
+    KBSymbol id = (const char *)xmlGetProp(node, BAD_CAST "id");
     const char *desc = (const char *)xmlGetProp(node, BAD_CAST "desc");
 
     xmlNodePtr fromNode = xmlFirstElementChild(node);
-    double from = atof((const char *)xmlNodeGetContent(fromNode));
+    double from = 0.0;
+    xmlChar *fromContent = xmlNodeGetContent(fromNode);
+    if (fromContent)
+    {
+        string text = (const char *)fromContent;
+        xmlFree(fromContent);
+        from = parseDouble(text);
+    }
 
     xmlNodePtr toNode = xmlNextElementSibling(fromNode);
-    double to = atof((const char *)xmlNodeGetContent(toNode));
+    double to = 0.0;
+    xmlChar *toContent = xmlNodeGetContent(toNode);
+    if (toContent)
+    {
+        string text = (const char *)toContent;
+        xmlFree(toContent);
+        to = parseDouble(text);
+    }
 
     return new KBNumericType(id, from, to, desc);
 }
 
 KBNumericType *KBNumericType::fromJSON(const Json::Value &json)
 {
-    string id = json["id"].asString();
+    KBSymbol id = json["id"].asString();
     const char *desc = json["desc"].isNull() ? nullptr : json["desc"].asCString();
     double from = json["from"].asDouble();
     double to = json["to"].asDouble();
@@ -155,28 +229,40 @@ KBNumericType *KBNumericType::fromJSON(const Json::Value &json)
 
 // KBSymbolicType implementation
 
-KBSymbolicType::KBSymbolicType(const string id, const vector<string> &values, const char *desc)
-    : KBType(id, desc), values(values) {}
+KBSymbolicType::KBSymbolicType(KBSymbol id, const vector<string> &values, const char *desc)
+    : KBType(id, desc)
+{
+    this->values.reserve(values.size());
+    for (const string &v : values)
+    {
+        this->values.push_back(KBSymbol(v));
+    }
+}
 
-string KBSymbolicType::getInnerKRL() const
+void KBSymbolicType::writeInnerKRL(string &out) const
 {
-    stringstream ss;
-    ss << "\"" << join(values, "\"\n\"") << "\"";
-    return ss.str();
+    out += '"';
+    for (size_t i = 0; i < values.size(); ++i)
+    {
+        if (i != 0)
+        {
+            out += "\"\n\"";
+        }
+        out += values[i].str();
+    }
+    out += '"';
 }
 
-map<string, string> KBSymbolicType::getAttrs() const
+void KBSymbolicType::collectAttrs(KBAttrList &attrs) const
 {
-    map<string, string> attrs = KBType::getAttrs();
-    string joined_values = join(values, ",");
-    attrs["values"] = joined_values;
-    return attrs;
+    KBType::collectAttrs(attrs);
+    attrs.set("values", join(getValues(), ","));
 }
 
 vector<xmlNodePtr> KBSymbolicType::getInnerXML() const
 {
     vector<xmlNodePtr> innerXML;
-    for (const string &v : values)
+    for (KBSymbol v : values)
     {
         xmlNodePtr valueNode = xmlNewNode(nullptr, BAD_CAST "value");
         xmlNodeSetContent(valueNode, BAD_CAST v.c_str());
@@ -185,25 +271,77 @@ vector<xmlNodePtr> KBSymbolicType::getInnerXML() const
     return innerXML;
 }
 
+void KBSymbolicType::writeInnerXML(KBXMLWriter &writer) const
+{
+    for (KBSymbol v : values)
+    {
+        writer.textElement("value", v.str());
+    }
+}
+
 Json::Value KBSymbolicType::toJSON() const
 {
     Json::Value json = KBType::toJSON();
     Json::Value valuesArray(Json::arrayValue);
-    for (const auto& str : values) {
-        valuesArray.append(str);
+    for (KBSymbol str : values) {
+        valuesArray.append(str.str());
     }
     json["values"] = valuesArray;
     return json;
 }
 
+void KBSymbolicType::writeJSON(KBJSONWriter &writer) const
+{
+    writer.startObject();
+    writer.member("desc", getComment());
+    writer.member("id", getId());
+    writer.member("meta", getMeta());
+    writer.member("tag", getTag());
+    writer.key("values");
+    writer.startArray();
+    for (KBSymbol value : values)
+    {
+        writer.value(value.str());
+    }
+    writer.endArray();
+    writer.endObject();
+}
+
 bool KBSymbolicType::validateValue(const string &value) const
 {
-    return true;
+    for (KBSymbol symbol : values)
+    {
+        if (symbol.str() == value)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void KBSymbolicType::collectDiagnostics(const KnowledgeBase &, vector<KBDiagnostic> &diagnostics) const
+{
+    if (values.empty())
+    {
+        diagnostics.push_back({this, "Symbolic type " + getId() + " has no values"});
+    }
+    for (size_t i = 0; i < values.size(); ++i)
+    {
+        if (find(values.begin(), values.begin() + i, values[i]) != values.begin() + i)
+        {
+            diagnostics.push_back({this, "Duplicate value " + values[i].str() + " in type " + getId()});
+        }
+    }
+}
+
+bool KBSymbolicType::hasValue(KBSymbol value) const
+{
+    return find(values.begin(), values.end(), value) != values.end();
 }
 
 KBSymbolicType *KBSymbolicType::fromXML(xmlNodePtr node)
 {
-    string id = (const char *)xmlGetProp(node, BAD_CAST "id");
+    KBSymbol id = (const char *)xmlGetProp(node, BAD_CAST "id");
     const char *desc = (const char *)xmlGetProp(node, BAD_CAST "desc");
 
     vector<string> values;
@@ -217,7 +355,7 @@ KBSymbolicType *KBSymbolicType::fromXML(xmlNodePtr node)
 
 KBSymbolicType *KBSymbolicType::fromJSON(const Json::Value &json)
 {
-    string id = json["id"].asString();
+    KBSymbol id = json["id"].asString();
     const char *desc = json["desc"].isNull() ? nullptr : json["desc"].asCString();
     vector<string> values;
     for (const Json::Value &value : json["values"])
@@ -228,29 +366,25 @@ KBSymbolicType *KBSymbolicType::fromJSON(const Json::Value &json)
     return new KBSymbolicType(id, values, desc);
 }
 
-KBFuzzyType::KBFuzzyType(const string id, const vector<MembershipFunction*> &membership_functions, const char *desc)
+KBFuzzyType::KBFuzzyType(KBSymbol id, const vector<MembershipFunction*> &membership_functions, const char *desc)
     : KBType(id, desc) {
     this->membership_functions = {};
     for (auto mf : membership_functions) {
-        MembershipFunction* new_mf = MembershipFunction::fromJSON(mf->toJSON());
+        MembershipFunction* new_mf = new MembershipFunction(mf->name, mf->min, mf->max, mf->points);
         new_mf->owner = this;
         this->membership_functions.push_back(new_mf);
     }
 }
 
-string KBFuzzyType::getInnerKRL() const {
-    int mf_size = membership_functions.size();
-    int i = 0;
-
-    string innerKRL = to_string(mf_size) + "\n";
-    for (auto mf : membership_functions) {
-        innerKRL += mf->KRL();
-        if (mf_size > 0 && i < mf_size - 1) {
-            innerKRL += "\n";
+void KBFuzzyType::writeInnerKRL(string &out) const {
+    out += to_string(membership_functions.size());
+    out += '\n';
+    for (size_t i = 0; i < membership_functions.size(); ++i) {
+        if (i > 0) {
+            out += '\n';
         }
-        i++;
+        membership_functions[i]->writeKRL(out);
     }
-    return innerKRL;
 }
 
 vector<xmlNodePtr> KBFuzzyType::getInnerXML() const {
@@ -262,6 +396,12 @@ vector<xmlNodePtr> KBFuzzyType::getInnerXML() const {
     return innerXML;
 }
 
+void KBFuzzyType::writeInnerXML(KBXMLWriter &writer) const {
+    for (auto mf : membership_functions) {
+        mf->writeInnerXML(writer);
+    }
+}
+
 Json::Value KBFuzzyType::toJSON() const {
     Json::Value json = KBType::toJSON();
     json["membership_functions"] = Json::Value(Json::arrayValue);
@@ -271,9 +411,82 @@ Json::Value KBFuzzyType::toJSON() const {
     return json;
 }
 
+void KBFuzzyType::writeJSON(KBJSONWriter &writer) const {
+    writer.startObject();
+    writer.member("desc", getComment());
+    writer.member("id", getId());
+    writer.key("membership_functions");
+    writer.startArray();
+    for (const auto& mf : membership_functions) {
+        mf->writeJSON(writer);
+    }
+    writer.endArray();
+    writer.member("meta", getMeta());
+    writer.member("tag", getTag());
+    writer.endObject();
+}
+
+// Функции принадлежности задаются элементами <parameter> либо парами <value>/<mf>,
+// как их записывает getInnerXML(); границы пары берутся по крайним точкам
+KBFuzzyType *KBFuzzyType::fromXML(xmlNodePtr node) {
+    string id, desc;
+    xmlProp(node, "id", id);
+    bool hasDesc = xmlProp(node, "desc", desc);
+    vector<unique_ptr<MembershipFunction>> mfs;
+    string pendingName;
+    for (xmlNodePtr child = xmlFirstElementChild(node); child; child = xmlNextElementSibling(child)) {
+        if (xmlStrcmp(child->name, BAD_CAST "parameter") == 0) {
+            mfs.emplace_back(MembershipFunction::fromXML(child));
+        } else if (xmlStrcmp(child->name, BAD_CAST "value") == 0) {
+            xmlChar* content = xmlNodeGetContent(child);
+            pendingName = content ? (const char*)content : "";
+            xmlFree(content);
+        } else if (xmlStrcmp(child->name, BAD_CAST "mf") == 0) {
+            vector<unique_ptr<MFPoint>> points;
+            for (xmlNodePtr point = xmlFirstElementChild(child); point; point = xmlNextElementSibling(point)) {
+                points.emplace_back(MFPoint::fromXML(point));
+            }
+            vector<MFPoint*> list;
+            for (const auto& point : points) {
+                list.push_back(point.get());
+            }
+            double min = list.empty() ? 0.0 : list.front()->x;
+            double max = list.empty() ? 0.0 : list.back()->x;
+            mfs.emplace_back(new MembershipFunction(pendingName, min, max, list));
+        }
+    }
+    vector<MembershipFunction*> list;
+    for (const auto& mf : mfs) {
+        list.push_back(mf.get());
+    }
+    return new KBFuzzyType(id, list, hasDesc ? desc.c_str() : nullptr);
+}
+
+KBFuzzyType *KBFuzzyType::fromJSON(const Json::Value &json) {
+    vector<unique_ptr<MembershipFunction>> mfs;
+    for (const Json::Value& mf : json["membership_functions"]) {
+        mfs.emplace_back(MembershipFunction::fromJSON(mf));
+    }
+    vector<MembershipFunction*> list;
+    for (const auto& mf : mfs) {
+        list.push_back(mf.get());
+    }
+    const char *desc = json["desc"].isNull() ? nullptr : json["desc"].asCString();
+    return new KBFuzzyType(json["id"].asString(), list, desc);
+}
+
+void KBFuzzyType::collectDiagnostics(const KnowledgeBase &kb, vector<KBDiagnostic> &diagnostics) const {
+    if (membership_functions.empty()) {
+        diagnostics.push_back({this, "Fuzzy type " + getId() + " has no membership functions"});
+    }
+    for (MembershipFunction* mf : membership_functions) {
+        mf->validate(kb, diagnostics);
+    }
+}
+
 KBFuzzyType::~KBFuzzyType() {
     for (auto mf : membership_functions) {
-        delete mf;
+        kbDeleteChild(mf);
     }
     KBEntity::~KBEntity();
 }
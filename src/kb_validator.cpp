@@ -0,0 +1,49 @@
+#include "kb_validator.h"
+#include "kb_parallel.h"
+#include <algorithm>
+#include <utility>
+
+using namespace std;
+
+KBValidator::KBValidator(size_t threadCount, size_t grain)
+    : threadCount(threadCount != 0 ? threadCount : kbDefaultThreadCount()), grain(grain) {}
+
+vector<KBDiagnostic> KBValidator::validate(KnowledgeBase &kb) const
+{
+    vector<KBEntity *> entities;
+    entities.reserve(kb.size());
+    entities.insert(entities.end(), kb.getTypes().begin(), kb.getTypes().end());
+    entities.insert(entities.end(), kb.getObjects().begin(), kb.getObjects().end());
+    entities.insert(entities.end(), kb.getRules().begin(), kb.getRules().end());
+
+    // Буфер потока: номер сущности и найденная ошибка
+    vector<vector<pair<size_t, KBDiagnostic>>> buffers(threadCount);
+    kbParallelFor(entities.size(), threadCount, grain, [&](size_t worker, size_t begin, size_t end)
+                  {
+        vector<pair<size_t, KBDiagnostic>> &buffer = buffers[worker];
+        vector<KBDiagnostic> found;
+        for (size_t i = begin; i < end; ++i)
+        {
+            found.clear();
+            entities[i]->validate(kb, found);
+            for (KBDiagnostic &diagnostic : found)
+            {
+                buffer.emplace_back(i, move(diagnostic));
+            }
+        } });
+
+    vector<pair<size_t, KBDiagnostic>> merged;
+    for (auto &buffer : buffers)
+    {
+        move(buffer.begin(), buffer.end(), back_inserter(merged));
+    }
+    stable_sort(merged.begin(), merged.end(), [](const auto &a, const auto &b)
+                { return a.first < b.first; });
+    vector<KBDiagnostic> diagnostics;
+    diagnostics.reserve(merged.size());
+    for (auto &item : merged)
+    {
+        diagnostics.push_back(move(item.second));
+    }
+    return diagnostics;
+}
@@ -2,53 +2,84 @@
 #include "non_factor.h"
 #include <libxml/parser.h>
 #include <json/json.h>
-#include <regex>
 #include "utils.h"
 #include "kb_operation.h"
 #include "kb_reference.h"
+#include "kb_krl_parser.h"
+#include <memory>
 
 using namespace std;
 
+static KBSymbol evaluatableTag()
+{
+    static const KBSymbol tag("evaluatable");
+    return tag;
+}
+
 Evaluatable::Evaluatable(NonFactor *nonFactor)
-    : KBEntity("evaluatable"),
-      nonFactor(nonFactor != nullptr ? new NonFactor(
-                                           nonFactor->getBelief(),
-                                           nonFactor->getProbability(),
-                                           nonFactor->getAccuracy())
-                                     : new NonFactor()),
+    : KBEntity(evaluatableTag()),
+      nonFactor(nullptr),
       convertNonFactor(nonFactor != nullptr)
 {
-    this->nonFactor->owner = this;
+    if (nonFactor != nullptr && !nonFactor->isDefault())
+    {
+        this->nonFactor = new NonFactor(nonFactor->getBelief(), nonFactor->getProbability(), nonFactor->getAccuracy());
+        this->nonFactor->owner = this;
+    }
 }
 
 Evaluatable::~Evaluatable()
 {
-    if (nonFactor)
+    kbDeleteChild(nonFactor);
+}
+
+void Evaluatable::setNonFactor(const NonFactor *nonFactor)
+{
+    if (this->nonFactor)
     {
-        delete nonFactor;
+        delete this->nonFactor;
+        this->nonFactor = nullptr;
+    }
+    if (nonFactor != nullptr && !nonFactor->isDefault())
+    {
+        this->nonFactor = nonFactor->copy();
+        this->nonFactor->owner = this;
     }
 }
 
-map<string, string> Evaluatable::getAttrs() const
+void Evaluatable::collectAttrs(KBAttrList &attrs) const
 {
-    map<string, string> attrs = KBEntity::getAttrs();
-    if (nonFactor && (nonFactor->isInitialized() || convertNonFactor && !nonFactor->isInitialized()))
+    KBEntity::collectAttrs(attrs);
+    if (hasNonFactorOutput())
     {
-        attrs["non_factor"] = nonFactor->toJSON().toStyledString();
+        attrs.set("non_factor", getNonFactor()->toJSON().toStyledString());
     }
-    return attrs;
 }
 
 xmlNodePtr Evaluatable::toXML() const
 {
     xmlNodePtr node = KBEntity::toXML();
-    if (nonFactor && (nonFactor->isInitialized() || convertNonFactor && !nonFactor->isInitialized()))
+    if (hasNonFactorOutput())
     {
-        xmlAddChild(node, nonFactor->toXML());
+        xmlAddChild(node, getNonFactor()->toXML());
     }
     return node;
 }
 
+void Evaluatable::writeXML(KBXMLWriter &writer) const
+{
+    KBAttrList attrs;
+    collectAttrs(attrs);
+    writer.startElement(getTag().c_str());
+    writer.attributes(attrs);
+    writeInnerXML(writer);
+    if (hasNonFactorOutput())
+    {
+        getNonFactor()->writeXML(writer);
+    }
+    writer.endElement();
+}
+
 Evaluatable *Evaluatable::fromXML(xmlNodePtr xml)
 {
     const char* tag = (const char*)xml->name;
@@ -75,10 +106,14 @@ Evaluatable *Evaluatable::fromJSON(const Json::Value &json)
 {
     string tag = json["tag"].asString();
 
-        if (tag == "value") {
+        // KBReference и KBOperation пишут JSON без "tag", поэтому узнаются по своим полям
+        if (json.isMember("sign")) {
+            return KBOperation::fromJSON(json);
+        }
+        else if (tag == "value" || json.isMember("content")) {
             return KBValue::fromJSON(json);
         }
-        else if (tag == "ref") {
+        else if (tag == "ref" || json.isMember("id")) {
             return KBReference::fromJSON(json);
         }
         // else if (tag == "EvRel" || tag == "IntRel" || tag == "EvIntRel") {
@@ -90,44 +125,118 @@ Evaluatable *Evaluatable::fromJSON(const Json::Value &json)
         }
 }
 
-string Evaluatable::KRL() const
+Evaluatable *Evaluatable::fromKRL(const string &krl)
+{
+    KBKRLParser parser(krl);
+    unique_ptr<Evaluatable> result(parser.parseExpression());
+    parser.expectEnd();
+    return result.release();
+}
+
+void Evaluatable::writeKRL(string &out) const
+{
+    writeInnerKRL(out);
+    if (nonFactor)
+    {
+        out += ' ';
+        nonFactor->writeKRL(out);
+    }
+}
+
+void Evaluatable::collectDiagnostics(const KnowledgeBase &kb, vector<KBDiagnostic> &diagnostics) const
 {
-    string result = getInnerKRL();
-    if (nonFactor && (nonFactor->isInitialized() || convertNonFactor && !nonFactor->isInitialized()) && !nonFactor->isDefault())
+    if (nonFactor)
     {
-        result += " " + nonFactor->KRL();
+        nonFactor->validate(kb, diagnostics);
     }
+}
+
+string Evaluatable::getInnerKRL() const
+{
+    string result;
+    writeInnerKRL(result);
     return result;
 }
 
 KBValue::KBValue(NonFactor *nonFactor) : Evaluatable(nonFactor)
 {
-    this->setTag("value");
+    static const KBSymbol VALUE_TAG("value");
+    this->setTag(VALUE_TAG);
+}
+
+Json::Value KBValue::toJSON() const
+{
+    Json::Value json = KBEntity::toJSON();
+    json["content"] = getJSONContent();
+    return json;
+}
+
+void KBValue::writeJSON(KBJSONWriter &writer) const
+{
+    KBAttrList attrs;
+    collectAttrs(attrs);
+    attrs.set("tag", getTag());
+    attrs.sort();
+    // "content" предшествует остальным ключам значения, как в Json::Value
+    writer.startObject();
+    writer.key("content");
+    writeJSONContent(writer);
+    for (const auto &attr : attrs)
+    {
+        writer.member(attr.first, attr.second);
+    }
+    writer.endObject();
 }
 
 KBValue *KBValue::fromXML(xmlNodePtr node)
 {
-    xmlChar *content = xmlNodeGetContent(node);
-    string contentStr = reinterpret_cast<const char *>(content);
-    xmlFree(content);
+    // Текст значения - только собственные текстовые узлы; вложенный <with> задает коэффициент
+    string contentStr;
+    unique_ptr<NonFactor> nonFactor;
+    bool hasChildren = false;
+    for (xmlNodePtr child = node->children; child; child = child->next)
+    {
+        if (child->type == XML_TEXT_NODE || child->type == XML_CDATA_SECTION_NODE)
+        {
+            contentStr += reinterpret_cast<const char *>(child->content);
+        }
+        else if (child->type == XML_ELEMENT_NODE)
+        {
+            hasChildren = true;
+            if (xmlStrcmp(child->name, BAD_CAST "with") == 0)
+            {
+                nonFactor.reset(NonFactor::fromXML(child));
+            }
+        }
+    }
+    if (hasChildren)
+    {
+        size_t begin = contentStr.find_first_not_of(" \t\r\n");
+        size_t end = contentStr.find_last_not_of(" \t\r\n");
+        contentStr = begin == string::npos ? "" : contentStr.substr(begin, end - begin + 1);
+    }
 
+    return fromString(contentStr, nonFactor.get());
+}
+
+KBValue *KBValue::fromString(const string &contentStr, NonFactor *nonFactor)
+{
     // Check if content is boolean
     if (contentStr == "True" || contentStr == "False")
     {
         bool value = (contentStr == "True");
-        return new KBBooleanValue(value);
+        return new KBBooleanValue(value, nonFactor);
     }
 
     // Check if content is numeric
-    std::regex numeric_regex("^[-+]?[0-9]*\\.?[0-9]+$");
-    if (std::regex_match(contentStr, numeric_regex))
+    double value = 0.0;
+    if (parseDecimal(contentStr, value))
     {
-        double value = std::stod(contentStr);
-        return new KBNumericValue(value);
+        return new KBNumericValue(value, nonFactor);
     }
 
     // Otherwise, it is symbolic
-    return new KBSymbolicValue(contentStr);
+    return new KBSymbolicValue(contentStr, nonFactor);
 }
 
 KBValue *KBValue::fromJSON(const Json::Value &json)
@@ -146,7 +255,7 @@ KBValue *KBValue::fromJSON(const Json::Value &json)
 
     if (content.isString())
     {
-        return new KBSymbolicValue(content.asString(), nonFactor);
+        return new KBSymbolicValue(KBSymbol(content.asString()), nonFactor);
     }
     else if (content.isBool())
     {
@@ -162,12 +271,14 @@ KBValue *KBValue::fromJSON(const Json::Value &json)
     }
 }
 
-KBSymbolicValue::KBSymbolicValue(const string &content, NonFactor *nonFactor)
+KBSymbolicValue::KBSymbolicValue(KBSymbol content, NonFactor *nonFactor)
     : KBValue(nonFactor), content(content) {}
 
-string KBSymbolicValue::getInnerKRL() const
+void KBSymbolicValue::writeInnerKRL(string &out) const
 {
-    return "\"" + content + "\"";
+    out += '"';
+    out += content.str();
+    out += '"';
 }
 
 vector<xmlNodePtr> KBSymbolicValue::getInnerXML() const
@@ -178,6 +289,21 @@ vector<xmlNodePtr> KBSymbolicValue::getInnerXML() const
     return nodes;
 }
 
+void KBSymbolicValue::writeInnerXML(KBXMLWriter &writer) const
+{
+    writer.text(content.str());
+}
+
+Json::Value KBSymbolicValue::getJSONContent() const
+{
+    return content.str();
+}
+
+void KBSymbolicValue::writeJSONContent(KBJSONWriter &writer) const
+{
+    writer.value(content.str());
+}
+
 KBValue *KBSymbolicValue::evaluate()
 {
     return new KBSymbolicValue(content);
@@ -186,9 +312,9 @@ KBValue *KBSymbolicValue::evaluate()
 KBNumericValue::KBNumericValue(double content, NonFactor *nonFactor)
     : KBValue(nonFactor), content(content) {}
 
-string KBNumericValue::getInnerKRL() const
+void KBNumericValue::writeInnerKRL(string &out) const
 {
-    return doubleToString(content);
+    appendDouble(out, content);
 }
 
 vector<xmlNodePtr> KBNumericValue::getInnerXML() const
@@ -200,6 +326,21 @@ vector<xmlNodePtr> KBNumericValue::getInnerXML() const
     return nodes;
 }
 
+void KBNumericValue::writeInnerXML(KBXMLWriter &writer) const
+{
+    writer.text(doubleToString(content));
+}
+
+Json::Value KBNumericValue::getJSONContent() const
+{
+    return content;
+}
+
+void KBNumericValue::writeJSONContent(KBJSONWriter &writer) const
+{
+    writer.value(content);
+}
+
 KBValue *KBNumericValue::evaluate()
 {
     return new KBNumericValue(content);
@@ -208,9 +349,9 @@ KBValue *KBNumericValue::evaluate()
 KBBooleanValue::KBBooleanValue(bool content, NonFactor *nonFactor)
     : KBValue(nonFactor), content(content) {}
 
-string KBBooleanValue::getInnerKRL() const
+void KBBooleanValue::writeInnerKRL(string &out) const
 {
-    return content ? "true" : "false";
+    out += content ? "true" : "false";
 }
 
 vector<xmlNodePtr> KBBooleanValue::getInnerXML() const
@@ -222,6 +363,21 @@ vector<xmlNodePtr> KBBooleanValue::getInnerXML() const
     return nodes;
 }
 
+void KBBooleanValue::writeInnerXML(KBXMLWriter &writer) const
+{
+    writer.text(content ? "True" : "False");
+}
+
+Json::Value KBBooleanValue::getJSONContent() const
+{
+    return content;
+}
+
+void KBBooleanValue::writeJSONContent(KBJSONWriter &writer) const
+{
+    writer.value(content);
+}
+
 KBValue *KBBooleanValue::evaluate()
 {
     return new KBBooleanValue(content);
@@ -0,0 +1,459 @@
+#include "kb_xml_reader.h"
+#include <stdexcept>
+#include <climits>
+#include <cstring>
+#include <memory>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+
+static string trim(const string &value)
+{
+    size_t begin = value.find_first_not_of(" \t\r\n");
+    if (begin == string::npos)
+    {
+        return "";
+    }
+    size_t end = value.find_last_not_of(" \t\r\n");
+    return value.substr(begin, end - begin + 1);
+}
+
+KBXMLReader::KBXMLReader(const string &xml) : buffer(xml)
+{
+    open(buffer.data(), buffer.size(), "noname.xml");
+}
+
+KBXMLReader *KBXMLReader::fromFile(const string &path)
+{
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        throw runtime_error("Couldn't open xml file " + path);
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0)
+    {
+        close(fd);
+        throw runtime_error("Couldn't read xml file " + path);
+    }
+    void *data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED)
+    {
+        throw runtime_error("Couldn't map xml file " + path);
+    }
+    madvise(data, st.st_size, MADV_SEQUENTIAL);
+
+    // Отображение освобождается деструктором читателя, если открыть документ не удалось
+    unique_ptr<KBXMLReader> result(new KBXMLReader());
+    result->mapped = data;
+    result->mappedSize = st.st_size;
+    result->open(static_cast<const char *>(data), st.st_size, path.c_str());
+    return result.release();
+}
+
+KBXMLReader::~KBXMLReader()
+{
+    if (reader)
+    {
+        xmlFreeTextReader(reader);
+    }
+    if (mapped)
+    {
+        munmap(mapped, mappedSize);
+    }
+}
+
+void KBXMLReader::open(const char *data, size_t size, const char *url)
+{
+    // Размер буфера libxml2 - int
+    if (size > (size_t)INT_MAX)
+    {
+        throw runtime_error("XML document is too large: " + to_string(size) + " bytes");
+    }
+    reader = xmlReaderForMemory(data, (int)size, url, nullptr, XML_PARSE_NONET | XML_PARSE_HUGE);
+    if (!reader)
+    {
+        throw runtime_error("Couldn't create xml reader");
+    }
+}
+
+bool KBXMLReader::read()
+{
+    int result = xmlTextReaderRead(reader);
+    if (result < 0)
+    {
+        throw runtime_error("Couldn't parse xml document");
+    }
+    return result == 1;
+}
+
+int KBXMLReader::nodeType() const
+{
+    return xmlTextReaderNodeType(reader);
+}
+
+int KBXMLReader::depth() const
+{
+    return xmlTextReaderDepth(reader);
+}
+
+bool KBXMLReader::isEmptyElement() const
+{
+    return xmlTextReaderIsEmptyElement(reader) == 1;
+}
+
+string KBXMLReader::getName() const
+{
+    const xmlChar *name = xmlTextReaderConstName(reader);
+    return name ? (const char *)name : "";
+}
+
+KBSymbol KBXMLReader::attribute(const char *name) const
+{
+    xmlChar *value = xmlTextReaderGetAttribute(reader, BAD_CAST name);
+    KBSymbol result((const char *)value);
+    xmlFree(value);
+    return result;
+}
+
+bool KBXMLReader::attribute(const char *name, string &value) const
+{
+    xmlChar *attr = xmlTextReaderGetAttribute(reader, BAD_CAST name);
+    if (!attr)
+    {
+        return false;
+    }
+    value = (const char *)attr;
+    xmlFree(attr);
+    return true;
+}
+
+double KBXMLReader::numericAttribute(const char *name, double fallback) const
+{
+    string value;
+    if (!attribute(name, value))
+    {
+        return fallback;
+    }
+    return parseDouble(value);
+}
+
+bool KBXMLReader::nextElement()
+{
+    while (read())
+    {
+        if (nodeType() == XML_READER_TYPE_ELEMENT)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void KBXMLReader::forEachElement(const string &name, const function<void(KBXMLReader &)> &handler)
+{
+    while (nextElement())
+    {
+        if (getName() == name)
+        {
+            handler(*this);
+        }
+    }
+}
+
+void KBXMLReader::readChildren(const function<void(const string &name)> &onElement, string *text)
+{
+    if (isEmptyElement())
+    {
+        return;
+    }
+    int level = depth();
+    while (read())
+    {
+        int type = nodeType();
+        if (type == XML_READER_TYPE_END_ELEMENT && depth() == level)
+        {
+            return;
+        }
+        if (type == XML_READER_TYPE_ELEMENT)
+        {
+            onElement(getName());
+        }
+        else if (text && (type == XML_READER_TYPE_TEXT || type == XML_READER_TYPE_CDATA ||
+                          type == XML_READER_TYPE_WHITESPACE || type == XML_READER_TYPE_SIGNIFICANT_WHITESPACE))
+        {
+            const xmlChar *value = xmlTextReaderConstValue(reader);
+            if (value)
+            {
+                text->append((const char *)value);
+            }
+        }
+    }
+    throw runtime_error("Unexpected end of xml document");
+}
+
+void KBXMLReader::skipElement()
+{
+    readChildren([this](const string &)
+                 { skipElement(); });
+}
+
+string KBXMLReader::readText()
+{
+    string text;
+    readChildren([this](const string &)
+                 { skipElement(); },
+                 &text);
+    return text;
+}
+
+// Сущности
+
+NonFactor *KBXMLReader::readNonFactor()
+{
+    double belief = numericAttribute("belief", 50.0);
+    double probability = numericAttribute("probability", 100.0);
+    double accuracy = numericAttribute("accuracy", 0.0);
+    skipElement();
+    return new NonFactor(belief, probability, accuracy);
+}
+
+MFPoint *KBXMLReader::readPoint()
+{
+    double x = numericAttribute("x", 0.0);
+    double y = numericAttribute("y", 0.0);
+    skipElement();
+    return new MFPoint(x, y);
+}
+
+static MembershipFunction *buildMembershipFunction(const string &name, double min, double max, vector<MFPoint *> &points)
+{
+    MembershipFunction *mf = new MembershipFunction(name, min, max, points);
+    for (MFPoint *point : points)
+    {
+        delete point;
+    }
+    points.clear();
+    return mf;
+}
+
+MembershipFunction *KBXMLReader::readMembershipFunction()
+{
+    double min = numericAttribute("min-value", 0.0);
+    double max = numericAttribute("max-value", 0.0);
+    string name;
+    vector<MFPoint *> points;
+    readChildren([&](const string &child)
+                 {
+        if (child == "value")
+        {
+            name = readText();
+        }
+        else if (child == "mf")
+        {
+            readChildren([&](const string &pointName)
+                         {
+                if (pointName == "point")
+                {
+                    points.push_back(readPoint());
+                }
+                else
+                {
+                    skipElement();
+                } });
+        }
+        else
+        {
+            skipElement();
+        } });
+    return buildMembershipFunction(name, min, max, points);
+}
+
+KBType *KBXMLReader::readType()
+{
+    KBSymbol id = attribute("id");
+    string meta, desc;
+    attribute("meta", meta);
+    bool hasDesc = attribute("desc", desc);
+    return readTypeBody(id, meta, hasDesc ? &desc : nullptr);
+}
+
+KBType *KBXMLReader::readTypeBody(KBSymbol id, const string &meta, const string *desc)
+{
+    const char *descStr = desc ? desc->c_str() : nullptr;
+    if (meta == "numeric" || meta == "number")
+    {
+        double from = 0.0, to = 0.0;
+        readChildren([&](const string &child)
+                     {
+            if (child == "from")
+            {
+                from = parseDouble(readText());
+            }
+            else if (child == "to")
+            {
+                to = parseDouble(readText());
+            }
+            else
+            {
+                skipElement();
+            } });
+        return new KBNumericType(id, from, to, descStr);
+    }
+    if (meta == "string" || meta == "symbolic")
+    {
+        vector<string> values;
+        readChildren([&](const string &child)
+                     {
+            if (child == "value")
+            {
+                values.push_back(readText());
+            }
+            else
+            {
+                skipElement();
+            } });
+        return new KBSymbolicType(id, values, descStr);
+    }
+    if (meta == "fuzzy")
+    {
+        // Поддерживаются как элементы <parameter>, так и пары <value>/<mf> без обертки
+        vector<MembershipFunction *> mfs;
+        string pendingName;
+        vector<MFPoint *> points;
+        readChildren([&](const string &child)
+                     {
+            if (child == "parameter")
+            {
+                mfs.push_back(readMembershipFunction());
+            }
+            else if (child == "value")
+            {
+                pendingName = readText();
+            }
+            else if (child == "mf")
+            {
+                readChildren([&](const string &pointName)
+                             {
+                    if (pointName == "point")
+                    {
+                        points.push_back(readPoint());
+                    }
+                    else
+                    {
+                        skipElement();
+                    } });
+                double min = points.empty() ? 0.0 : points.front()->x;
+                double max = points.empty() ? 0.0 : points.back()->x;
+                mfs.push_back(buildMembershipFunction(pendingName, min, max, points));
+            }
+            else
+            {
+                skipElement();
+            } });
+        KBFuzzyType *type = new KBFuzzyType(id, mfs, descStr);
+        for (MembershipFunction *mf : mfs)
+        {
+            delete mf;
+        }
+        return type;
+    }
+    skipElement();
+    return new KBType(id, descStr);
+}
+
+Evaluatable *KBXMLReader::readEvaluatable()
+{
+    string name = getName();
+    if (name == "value")
+    {
+        return readValue();
+    }
+    if (name == "ref")
+    {
+        return readReference();
+    }
+    return readOperation();
+}
+
+KBValue *KBXMLReader::readValue()
+{
+    string text;
+    unique_ptr<NonFactor> nonFactor;
+    bool hasChildren = false;
+    readChildren([&](const string &child)
+                 {
+        hasChildren = true;
+        if (child == "with")
+        {
+            nonFactor.reset(readNonFactor());
+        }
+        else
+        {
+            skipElement();
+        } },
+                 &text);
+    // Отступы вокруг вложенного <with> не относятся к значению
+    if (hasChildren)
+    {
+        text = trim(text);
+    }
+    return KBValue::fromString(text, nonFactor.get());
+}
+
+KBReference *KBXMLReader::readReference()
+{
+    KBSymbol id = attribute("id");
+    unique_ptr<KBReference> ref;
+    unique_ptr<NonFactor> nonFactor;
+    readChildren([&](const string &child)
+                 {
+        if (child == "ref" && !ref)
+        {
+            ref.reset(readReference());
+        }
+        else if (child == "with")
+        {
+            nonFactor.reset(readNonFactor());
+        }
+        else
+        {
+            skipElement();
+        } });
+    return new KBReference(id, ref.release(), nonFactor.get());
+}
+
+KBOperation *KBXMLReader::readOperation()
+{
+    string tag = getName();
+    KBOperator op;
+    if (!parseOperatorTag(tag, op))
+    {
+        throw invalid_argument("Unknown operation: " + tag);
+    }
+    vector<unique_ptr<Evaluatable>> operands;
+    unique_ptr<NonFactor> nonFactor;
+    readChildren([&](const string &child)
+                 {
+        if (child == "with")
+        {
+            nonFactor.reset(readNonFactor());
+        }
+        else
+        {
+            operands.emplace_back(readEvaluatable());
+        } });
+
+    size_t arity = operatorInfo(op).binary ? 2 : 1;
+    if (operands.size() != arity)
+    {
+        throw invalid_argument("Operation " + tag + " expects " + to_string(arity) + " operands");
+    }
+    // Операнды передаются операции только после всех проверок
+    Evaluatable *right = arity == 2 ? operands[1].release() : nullptr;
+    return new KBOperation(tag, operands[0].release(), right, nonFactor.get());
+}
@@ -0,0 +1,249 @@
+#include "kb_xml_writer.h"
+#include "kb_entity.h"
+#include <algorithm>
+#include <cstring>
+#include <cerrno>
+#include <stdexcept>
+#include <unistd.h>
+
+using namespace std;
+
+// KBAttrList
+
+void KBAttrList::set(const char *name, string value)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (strcmp(items[i].first, name) == 0)
+        {
+            items[i].second = std::move(value);
+            return;
+        }
+    }
+    if (count == CAPACITY)
+    {
+        throw length_error(string("Too many attributes, can't add ") + name);
+    }
+    items[count].first = name;
+    items[count].second = std::move(value);
+    ++count;
+}
+
+const string *KBAttrList::get(const char *name) const
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (strcmp(items[i].first, name) == 0)
+        {
+            return &items[i].second;
+        }
+    }
+    return nullptr;
+}
+
+void KBAttrList::sort()
+{
+    std::sort(items, items + count, [](const pair<const char *, string> &a, const pair<const char *, string> &b)
+              { return strcmp(a.first, b.first) < 0; });
+}
+
+map<string, string> KBAttrList::toMap() const
+{
+    map<string, string> result;
+    for (size_t i = 0; i < count; ++i)
+    {
+        result[items[i].first] = items[i].second;
+    }
+    return result;
+}
+
+// KBXMLWriter
+
+KBXMLWriter::KBXMLWriter(int fd, size_t bufferSize) : fd(fd), flushThreshold(bufferSize)
+{
+    buffer.reserve(bufferSize + bufferSize / 4);
+}
+
+KBXMLWriter::~KBXMLWriter()
+{
+    if (fd >= 0)
+    {
+        try
+        {
+            flush();
+        }
+        catch (...)
+        {
+        }
+    }
+}
+
+void KBXMLWriter::flush()
+{
+    if (fd < 0)
+    {
+        return;
+    }
+    const char *data = buffer.data();
+    size_t left = buffer.size();
+    while (left > 0)
+    {
+        ssize_t written = ::write(fd, data, left);
+        if (written < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            throw runtime_error(string("Couldn't write xml: ") + strerror(errno));
+        }
+        data += written;
+        left -= written;
+    }
+    buffer.clear();
+}
+
+void KBXMLWriter::maybeFlush()
+{
+    if (fd >= 0 && buffer.size() >= flushThreshold)
+    {
+        flush();
+    }
+}
+
+void KBXMLWriter::closeStartTag()
+{
+    if (startTagPending)
+    {
+        buffer += '>';
+        startTagPending = false;
+    }
+}
+
+// Экранирование совпадает с libxml2 (xmlEscapeEntities / xmlAttrSerializeTxtContent)
+void KBXMLWriter::escape(string_view value, bool attribute)
+{
+    size_t plain = 0;
+    for (size_t i = 0; i < value.size(); ++i)
+    {
+        const char *replacement = nullptr;
+        switch (value[i])
+        {
+        case '&':
+            replacement = "&amp;";
+            break;
+        case '<':
+            replacement = "&lt;";
+            break;
+        case '>':
+            replacement = "&gt;";
+            break;
+        case '\r':
+            replacement = "&#13;";
+            break;
+        case '"':
+            replacement = attribute ? "&quot;" : nullptr;
+            break;
+        case '\n':
+            replacement = attribute ? "&#10;" : nullptr;
+            break;
+        case '\t':
+            replacement = attribute ? "&#9;" : nullptr;
+            break;
+        }
+        if (replacement)
+        {
+            buffer.append(value.data() + plain, i - plain);
+            buffer += replacement;
+            plain = i + 1;
+        }
+    }
+    buffer.append(value.data() + plain, value.size() - plain);
+}
+
+void KBXMLWriter::startElement(const char *name)
+{
+    closeStartTag();
+    maybeFlush();
+    buffer += '<';
+    buffer += name;
+    open.push_back(name);
+    startTagPending = true;
+}
+
+void KBXMLWriter::attribute(const char *name, string_view value)
+{
+    if (!startTagPending)
+    {
+        throw logic_error(string("Attribute ") + name + " outside of start tag");
+    }
+    buffer += ' ';
+    buffer += name;
+    buffer += "=\"";
+    escape(value, true);
+    buffer += '"';
+}
+
+void KBXMLWriter::attributes(KBAttrList &attrs)
+{
+    attrs.sort();
+    for (const auto &attr : attrs)
+    {
+        attribute(attr.first, attr.second);
+    }
+}
+
+void KBXMLWriter::text(string_view value)
+{
+    closeStartTag();
+    escape(value, false);
+}
+
+void KBXMLWriter::endElement()
+{
+    if (open.empty())
+    {
+        throw logic_error("No open element to close");
+    }
+    if (startTagPending)
+    {
+        buffer += "/>";
+        startTagPending = false;
+    }
+    else
+    {
+        buffer += "</";
+        buffer += open.back();
+        buffer += '>';
+    }
+    open.pop_back();
+}
+
+void KBXMLWriter::textElement(const char *name, string_view value)
+{
+    startElement(name);
+    if (!value.empty())
+    {
+        text(value);
+    }
+    endElement();
+}
+
+void KBXMLWriter::declaration()
+{
+    buffer += "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n";
+}
+
+void KBXMLWriter::write(const KBEntity &entity)
+{
+    entity.writeXML(*this);
+    maybeFlush();
+}
+
+void KBXMLWriter::document(const KBEntity &entity)
+{
+    declaration();
+    entity.writeXML(*this);
+    buffer += '\n';
+    maybeFlush();
+}
@@ -0,0 +1,316 @@
+#include "knowledge_base.h"
+#include "utils.h"
+#include <memory>
+#include <stdexcept>
+
+using namespace std;
+
+KnowledgeBase::KnowledgeBase() : KBEntity("knowledge-base") {}
+
+KnowledgeBase::~KnowledgeBase()
+{
+    // Сущности из кучи удаляются здесь, сущности арены базы разрушает деструктор арены
+    for (KBRule *rule : rules)
+    {
+        deleteOwned(rule);
+    }
+    for (KBObject *object : objects)
+    {
+        deleteOwned(object);
+    }
+    for (KBType *type : types)
+    {
+        deleteOwned(type);
+    }
+}
+
+void KnowledgeBase::deleteOwned(KBEntity *entity)
+{
+    if (KBArena::of(entity) != &arena)
+    {
+        delete entity;
+    }
+}
+
+template <typename T>
+static void addEntity(KBEntity *kb, vector<T *> &entities, KBSymbolIndex &index, T *entity, const char *kind)
+{
+    if (!index.insert(entity->getIdSymbol(), entities.size()))
+    {
+        string id = entity->getId();
+        delete entity;
+        throw invalid_argument(string("Duplicate ") + kind + " id: " + id);
+    }
+    entity->owner = kb;
+    entities.push_back(entity);
+}
+
+void KnowledgeBase::addType(KBType *type)
+{
+    addEntity(this, types, typeIndex, type, "type");
+    schemaChanged();
+}
+
+void KnowledgeBase::addObject(KBObject *object)
+{
+    addEntity(this, objects, objectIndex, object, "object");
+    schemaChanged();
+}
+
+void KnowledgeBase::addRule(KBRule *rule)
+{
+    addEntity(this, rules, ruleIndex, rule, "rule");
+    dependencies.addRule(rule, rules.size() - 1);
+}
+
+vector<KBRule *> KnowledgeBase::getAffectedRules(const vector<KBSymbol> &paths) const
+{
+    vector<KBRule *> affected;
+    for (uint32_t index : dependencies.getAffectedRules(paths))
+    {
+        affected.push_back(rules[index]);
+    }
+    return affected;
+}
+
+const KBSlotLayout &KnowledgeBase::bindReferences()
+{
+    if (!layout.isCurrent())
+    {
+        layout.rebuild(*this);
+        boundRules = 0;
+    }
+    for (; boundRules < rules.size(); ++boundRules)
+    {
+        layout.bindReferences(rules[boundRules]);
+    }
+    return layout;
+}
+
+KBType *KnowledgeBase::getType(KBSymbol id) const
+{
+    uint32_t index = typeIndex.find(id);
+    return index != KBSymbolIndex::NOT_FOUND ? types[index] : nullptr;
+}
+
+KBObject *KnowledgeBase::getObject(KBSymbol id) const
+{
+    uint32_t index = objectIndex.find(id);
+    return index != KBSymbolIndex::NOT_FOUND ? objects[index] : nullptr;
+}
+
+KBRule *KnowledgeBase::getRule(KBSymbol id) const
+{
+    uint32_t index = ruleIndex.find(id);
+    return index != KBSymbolIndex::NOT_FOUND ? rules[index] : nullptr;
+}
+
+KBProperty *KnowledgeBase::getProperty(KBSymbol object, KBSymbol property) const
+{
+    KBObject *owner = getObject(object);
+    return owner ? owner->getProperty(property) : nullptr;
+}
+
+KBProperty *KnowledgeBase::getProperty(const KBReference *ref) const
+{
+    if (!ref || !ref->getRef() || ref->getRef()->getRef())
+    {
+        return nullptr;
+    }
+    return getProperty(ref->getIdSymbol(), ref->getRef()->getIdSymbol());
+}
+
+KBType *KnowledgeBase::getReferenceType(const KBReference *ref) const
+{
+    KBProperty *property = getProperty(ref);
+    return property ? getType(property->getTypeSymbol()) : nullptr;
+}
+
+void KnowledgeBase::collectDiagnostics(const KnowledgeBase &kb, vector<KBDiagnostic> &diagnostics) const
+{
+    for (KBType *type : types)
+    {
+        type->validate(kb, diagnostics);
+    }
+    for (KBObject *object : objects)
+    {
+        object->validate(kb, diagnostics);
+    }
+    for (KBRule *rule : rules)
+    {
+        rule->validate(kb, diagnostics);
+    }
+}
+
+template <typename T>
+static xmlNodePtr sectionXML(const char *name, const vector<T *> &entities)
+{
+    xmlNodePtr node = xmlNewNode(nullptr, BAD_CAST name);
+    for (const T *entity : entities)
+    {
+        xmlAddChild(node, entity->toXML());
+    }
+    return node;
+}
+
+vector<xmlNodePtr> KnowledgeBase::getInnerXML() const
+{
+    return {sectionXML("types", types), sectionXML("classes", objects), sectionXML("rules", rules)};
+}
+
+template <typename T>
+static void writeSectionXML(KBXMLWriter &writer, const char *name, const vector<T *> &entities)
+{
+    writer.startElement(name);
+    for (const T *entity : entities)
+    {
+        entity->writeXML(writer);
+    }
+    writer.endElement();
+}
+
+void KnowledgeBase::writeInnerXML(KBXMLWriter &writer) const
+{
+    writeSectionXML(writer, "types", types);
+    writeSectionXML(writer, "classes", objects);
+    writeSectionXML(writer, "rules", rules);
+}
+
+template <typename T>
+static Json::Value sectionJSON(const vector<T *> &entities)
+{
+    Json::Value json(Json::arrayValue);
+    for (const T *entity : entities)
+    {
+        json.append(entity->toJSON());
+    }
+    return json;
+}
+
+Json::Value KnowledgeBase::toJSON() const
+{
+    Json::Value json = KBEntity::toJSON();
+    json["types"] = sectionJSON(types);
+    json["classes"] = sectionJSON(objects);
+    json["rules"] = sectionJSON(rules);
+    return json;
+}
+
+template <typename T>
+static void writeSectionJSON(KBJSONWriter &writer, const char *name, const vector<T *> &entities)
+{
+    writer.key(name);
+    writer.startArray();
+    for (const T *entity : entities)
+    {
+        entity->writeJSON(writer);
+    }
+    writer.endArray();
+}
+
+void KnowledgeBase::writeJSON(KBJSONWriter &writer) const
+{
+    writer.startObject();
+    writeSectionJSON(writer, "classes", objects);
+    writeSectionJSON(writer, "rules", rules);
+    writer.member("tag", getTag());
+    writeSectionJSON(writer, "types", types);
+    writer.endObject();
+}
+
+// Сущности разделяются пустой строкой
+void KnowledgeBase::writeKRL(string &out) const
+{
+    for (const KBType *type : types)
+    {
+        type->writeKRL(out);
+        out += '\n';
+    }
+    for (const KBObject *object : objects)
+    {
+        object->writeKRL(out);
+        out += '\n';
+    }
+    for (const KBRule *rule : rules)
+    {
+        rule->writeKRL(out);
+        out += '\n';
+    }
+}
+
+KnowledgeBase *KnowledgeBase::fromXML(xmlNodePtr node)
+{
+    unique_ptr<KnowledgeBase> kb(new KnowledgeBase());
+    KBArenaScope scope(kb->arena);
+    for (xmlNodePtr section = xmlFirstElementChild(node); section; section = xmlNextElementSibling(section))
+    {
+        if (xmlStrcmp(section->name, BAD_CAST "types") == 0)
+        {
+            kb->types.reserve(kb->types.size() + xmlChildElementCount(section));
+            kb->typeIndex.reserve(kb->types.capacity());
+            for (xmlNodePtr child = xmlFirstElementChild(section); child; child = xmlNextElementSibling(child))
+            {
+                KBType *type = KBType::fromXML(child);
+                if (!type)
+                {
+                    string id;
+                    xmlProp(child, "id", id);
+                    throw runtime_error("Unknown type meta for " + id);
+                }
+                kb->addType(type);
+            }
+        }
+        else if (xmlStrcmp(section->name, BAD_CAST "classes") == 0)
+        {
+            kb->objects.reserve(kb->objects.size() + xmlChildElementCount(section));
+            kb->objectIndex.reserve(kb->objects.capacity());
+            for (xmlNodePtr child = xmlFirstElementChild(section); child; child = xmlNextElementSibling(child))
+            {
+                kb->addObject(KBObject::fromXML(child));
+            }
+        }
+        else if (xmlStrcmp(section->name, BAD_CAST "rules") == 0)
+        {
+            kb->rules.reserve(kb->rules.size() + xmlChildElementCount(section));
+            kb->ruleIndex.reserve(kb->rules.capacity());
+            for (xmlNodePtr child = xmlFirstElementChild(section); child; child = xmlNextElementSibling(child))
+            {
+                kb->addRule(KBRule::fromXML(child));
+            }
+        }
+    }
+    return kb.release();
+}
+
+KnowledgeBase *KnowledgeBase::fromJSON(const Json::Value &json)
+{
+    unique_ptr<KnowledgeBase> kb(new KnowledgeBase());
+    KBArenaScope scope(kb->arena);
+    const Json::Value &types = json["types"];
+    kb->types.reserve(types.size());
+    kb->typeIndex.reserve(types.size());
+    for (const Json::Value &value : types)
+    {
+        KBType *type = KBType::fromJSON(value);
+        if (!type)
+        {
+            throw runtime_error("Unknown type meta for " + value["id"].asString());
+        }
+        kb->addType(type);
+    }
+    const Json::Value &objects = json["classes"];
+    kb->objects.reserve(objects.size());
+    kb->objectIndex.reserve(objects.size());
+    for (const Json::Value &value : objects)
+    {
+        kb->addObject(KBObject::fromJSON(value));
+    }
+    const Json::Value &rules = json["rules"];
+    kb->rules.reserve(rules.size());
+    kb->ruleIndex.reserve(rules.size());
+    for (const Json::Value &value : rules)
+    {
+        kb->addRule(KBRule::fromJSON(value));
+    }
+    return kb.release();
+}
@@ -1,5 +1,7 @@
 #include "membership_function.h"
 #include <sstream>
+#include <algorithm>
+#include <cmath>
 #include <libxml/parser.h>
 #include <libxml/tree.h>
 #include <json/json.h>
@@ -7,20 +9,34 @@
 
 using namespace std;
 
+// Числовой атрибут; отсутствие атрибута - ошибка, как и раньше
+static double numericProp(xmlNodePtr xml, const char* name) {
+    xmlChar* value = xmlGetProp(xml, BAD_CAST name);
+    if (!value) {
+        throw invalid_argument(string("Missing attribute ") + name);
+    }
+    double result = 0.0;
+    bool parsed = tryParseDouble((const char*)value, result);
+    xmlFree(value);
+    if (!parsed) {
+        throw invalid_argument(string("Invalid number in attribute ") + name);
+    }
+    return result;
+}
+
 // Реализация класса MFPoint
 MFPoint::MFPoint(double x, double y) : KBEntity("point"), x(x), y(y) {}
 
-map<string, string> MFPoint::getAttrs() const {
-    map<string, string> attrs = KBEntity::getAttrs();
-    attrs["x"] = doubleToString(x);
-    attrs["y"] = doubleToString(y);
-    return attrs;
+void MFPoint::collectAttrs(KBAttrList& attrs) const {
+    KBEntity::collectAttrs(attrs);
+    attrs.set("x", doubleToString(x));
+    attrs.set("y", doubleToString(y));
 }
 
-string MFPoint::KRL() const {
-    ostringstream oss;
-    oss << x << "|" << y;
-    return oss.str();
+void MFPoint::writeKRL(string& out) const {
+    appendDouble(out, x);
+    out += '|';
+    appendDouble(out, y);
 }
 
 Json::Value MFPoint::toJSON() const {
@@ -30,9 +46,17 @@ Json::Value MFPoint::toJSON() const {
     return json;
 }
 
+void MFPoint::writeJSON(KBJSONWriter& writer) const {
+    writer.startObject();
+    writer.member("tag", getTag());
+    writer.member("x", x);
+    writer.member("y", y);
+    writer.endObject();
+}
+
 MFPoint* MFPoint::fromXML(xmlNodePtr xml) {
-    double x = stof((const char*)xmlGetProp(xml, (const xmlChar*)"x"));
-    double y = stof((const char*)xmlGetProp(xml, (const xmlChar*)"y"));
+    double x = numericProp(xml, "x");
+    double y = numericProp(xml, "y");
     return new MFPoint(x, y);
 }
 
@@ -47,17 +71,112 @@ MembershipFunction::MembershipFunction(const string& name, double min, double ma
     : KBEntity("parameter"), name(name), min(min), max(max) {
     this->points = {};
     for (auto& point : points) {
-        MFPoint * new_point = MFPoint::fromJSON(point->toJSON());
+        MFPoint * new_point = new MFPoint(point->x, point->y);
         new_point->owner = this;
         this->points.push_back(new_point);
     }
+    updateCurve();
 }
 
-map<string, string> MembershipFunction::getAttrs() const {
-    map<string, string> attrs = KBEntity::getAttrs();
-    attrs["min-value"] = to_string(min);
-    attrs["max-value"] = to_string(max);
-    return attrs;
+void MembershipFunction::updateCurve() {
+    vector<const MFPoint*> sorted(points.begin(), points.end());
+    stable_sort(sorted.begin(), sorted.end(), [](const MFPoint* a, const MFPoint* b) { return a->x < b->x; });
+    curveX.resize(sorted.size());
+    curveY.resize(sorted.size());
+    slopes.assign(sorted.size(), 0.0);
+    for (size_t i = 0; i < sorted.size(); ++i) {
+        curveX[i] = sorted[i]->x;
+        curveY[i] = sorted[i]->y;
+    }
+    for (size_t i = 0; i + 1 < sorted.size(); ++i) {
+        double width = curveX[i + 1] - curveX[i];
+        if (width > 0.0) {
+            slopes[i] = (curveY[i + 1] - curveY[i]) / width;
+        }
+    }
+    if (lutResolution > 0) {
+        buildLookupTable();
+    }
+}
+
+double MembershipFunction::evaluateExact(double x) const {
+    size_t n = curveX.size();
+    if (n == 0) {
+        return 0.0;
+    }
+    const double* xs = curveX.data();
+    // Левее первой точки - первая точка, правее последней - последняя (наклон 0)
+    x = std::min(std::max(x, xs[0]), xs[n - 1]);
+    // Двоичный поиск последней точки с xs[i] <= x; сравнение превращается в условную пересылку
+    const double* base = xs;
+    for (size_t len = n; len > 1;) {
+        size_t half = len / 2;
+        base = base[half] <= x ? base + half : base;
+        len -= half;
+    }
+    size_t i = base - xs;
+    return curveY[i] + (x - xs[i]) * slopes[i];
+}
+
+double MembershipFunction::evaluateTable(double x) const {
+    double t = (x - min) * lutScale;
+    // За пределами [min, max] (и для NaN) - точное значение
+    if (!(t >= 0.0 && t <= (double)lutResolution)) {
+        return evaluateExact(x);
+    }
+    size_t i = std::min((size_t)t, lutResolution - 1);
+    double fraction = t - (double)i;
+    return lut[i] + fraction * (lut[i + 1] - lut[i]);
+}
+
+bool MembershipFunction::useLookupTable(size_t resolution, double maxError) {
+    lutResolution = resolution;
+    lutMaxError = maxError;
+    return buildLookupTable();
+}
+
+void MembershipFunction::dropLookupTable() {
+    lut.clear();
+    lut.shrink_to_fit();
+    lutResolution = 0;
+    lutError = 0.0;
+}
+
+bool MembershipFunction::buildLookupTable() {
+    lut.clear();
+    lutError = 0.0;
+    if (lutResolution == 0 || curveX.empty() || !(min < max)) {
+        return false;
+    }
+    vector<float> table(lutResolution + 1);
+    double step = (max - min) / (double)lutResolution;
+    for (size_t i = 0; i <= lutResolution; ++i) {
+        table[i] = (float)evaluateExact(i == lutResolution ? max : min + step * (double)i);
+    }
+    lut.swap(table);
+    lutScale = (double)lutResolution / (max - min);
+
+    // Обе кривые линейны между изломами исходной кривой и узлами сетки, а в узлах совпадают,
+    // поэтому наибольшее отклонение достигается в точках кривой. Для ступеньки проверяются
+    // оба предела: значения до и после скачка - соседние точки с одним x.
+    double error = 0.0;
+    for (size_t i = 0; i < curveX.size(); ++i) {
+        if (curveX[i] >= min && curveX[i] <= max) {
+            error = std::max(error, fabs(evaluateTable(curveX[i]) - curveY[i]));
+        }
+    }
+    lutError = error;
+    if (error > lutMaxError) {
+        lut.clear();
+        return false;
+    }
+    return true;
+}
+
+void MembershipFunction::collectAttrs(KBAttrList& attrs) const {
+    KBEntity::collectAttrs(attrs);
+    attrs.set("min-value", doubleToString(min));
+    attrs.set("max-value", doubleToString(max));
 }
 
 vector<xmlNodePtr> MembershipFunction::getInnerXML() const {
@@ -70,8 +189,8 @@ vector<xmlNodePtr> MembershipFunction::getInnerXML() const {
     xmlNodePtr mf = xmlNewNode(nullptr, BAD_CAST "mf");
     for (const auto& point : points) {
         xmlNodePtr pointElem = xmlNewNode(nullptr, BAD_CAST "point");
-        xmlNewProp(pointElem, BAD_CAST "x", BAD_CAST to_string(point->x).c_str());
-        xmlNewProp(pointElem, BAD_CAST "y", BAD_CAST to_string(point->y).c_str());
+        xmlNewProp(pointElem, BAD_CAST "x", BAD_CAST doubleToString(point->x).c_str());
+        xmlNewProp(pointElem, BAD_CAST "y", BAD_CAST doubleToString(point->y).c_str());
         xmlAddChild(mf, pointElem);
     }
     elements.push_back(mf);
@@ -79,6 +198,18 @@ vector<xmlNodePtr> MembershipFunction::getInnerXML() const {
     return elements;
 }
 
+void MembershipFunction::writeInnerXML(KBXMLWriter& writer) const {
+    writer.textElement("value", name);
+    writer.startElement("mf");
+    for (const auto& point : points) {
+        writer.startElement("point");
+        writer.attribute("x", doubleToString(point->x));
+        writer.attribute("y", doubleToString(point->y));
+        writer.endElement();
+    }
+    writer.endElement();
+}
+
 Json::Value MembershipFunction::toJSON() const {
     Json::Value json = KBEntity::toJSON();
     json["name"] = name;
@@ -90,9 +221,42 @@ Json::Value MembershipFunction::toJSON() const {
     return json;
 }
 
+void MembershipFunction::writeJSON(KBJSONWriter& writer) const {
+    writer.startObject();
+    writer.member("max", max);
+    writer.member("max-value", doubleToString(max));
+    writer.member("min", min);
+    writer.member("min-value", doubleToString(min));
+    writer.member("name", name);
+    if (!points.empty()) {
+        writer.key("points");
+        writer.startArray();
+        for (const auto& point : points) {
+            point->writeJSON(writer);
+        }
+        writer.endArray();
+    }
+    writer.member("tag", getTag());
+    writer.endObject();
+}
+
+void MembershipFunction::collectDiagnostics(const KnowledgeBase&, vector<KBDiagnostic>& diagnostics) const {
+    if (!(min <= max)) {
+        diagnostics.push_back({this, "Invalid range of membership function " + name});
+    }
+    for (size_t i = 0; i < points.size(); ++i) {
+        if (!(points[i]->y >= 0.0 && points[i]->y <= 1.0)) {
+            diagnostics.push_back({this, "Membership degree out of [0, 1] in " + name});
+        }
+        if (i > 0 && !(points[i - 1]->x <= points[i]->x)) {
+            diagnostics.push_back({this, "Points of membership function " + name + " are not sorted by x"});
+        }
+    }
+}
+
 MembershipFunction* MembershipFunction::fromXML(xmlNodePtr xml) {
-    double min = stof((const char*)xmlGetProp(xml, (const xmlChar*)"min-value"));
-    double max = stof((const char*)xmlGetProp(xml, (const xmlChar*)"max-value"));
+    double min = numericProp(xml, "min-value");
+    double max = numericProp(xml, "max-value");
 
     xmlNodePtr valueElem = xmlFirstElementChild(xml);
     string name = (const char*)xmlNodeGetContent(valueElem);
@@ -117,13 +281,19 @@ MembershipFunction* MembershipFunction::fromJSON(const Json::Value& json) {
     return new MembershipFunction(name, min, max, points);
 }
 
-string MembershipFunction::KRL() const {
-    ostringstream oss;
-    oss << "\"" << name << "\" " << min << " " << max << " " << points.size() << " ={";
+void MembershipFunction::writeKRL(string& out) const {
+    out += '"';
+    out += name;
+    out += "\" ";
+    appendDouble(out, min);
+    out += ' ';
+    appendDouble(out, max);
+    out += ' ';
+    out += to_string(points.size());
+    out += " ={";
     for (size_t i = 0; i < points.size(); ++i) {
-        if (i > 0) oss << "; ";
-        oss << points[i]->KRL();
+        if (i > 0) out += "; ";
+        points[i]->writeKRL(out);
     }
-    oss << "}";
-    return oss.str();
+    out += '}';
 }
\ No newline at end of file
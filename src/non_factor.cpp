@@ -1,4 +1,5 @@
 #include "non_factor.h"
+#include <sstream>
 #include <stdexcept>
 #include "utils.h"
 
@@ -15,16 +16,20 @@ NonFactor::NonFactor(double belief, double probability, double accuracy)
     this->initialized = (belief != 50.0) || (probability != 100.0) || (accuracy != 0.0);
 }
 
+const NonFactor* NonFactor::getDefault() {
+    static const NonFactor instance;
+    return &instance;
+}
+
 NonFactor* NonFactor::copy() const {
     return new NonFactor(belief, probability, accuracy);
 }
 
-map<string, string> NonFactor::getAttrs() const {
-    map<string, string> attrs = KBEntity::getAttrs();
-    attrs["belief"] = to_string(belief);
-    attrs["probability"] = to_string(probability);
-    attrs["accuracy"] = to_string(accuracy);
-    return attrs;
+void NonFactor::collectAttrs(KBAttrList& attrs) const {
+    KBEntity::collectAttrs(attrs);
+    attrs.set("belief", doubleToString(belief));
+    attrs.set("probability", doubleToString(probability));
+    attrs.set("accuracy", doubleToString(accuracy));
 }
 
 xmlNodePtr NonFactor::toXML() const {
@@ -35,6 +40,14 @@ xmlNodePtr NonFactor::toXML() const {
     return node;
 }
 
+void NonFactor::writeXML(KBXMLWriter& writer) const {
+    writer.startElement(this->getTag().c_str());
+    writer.attribute("belief", doubleToString(belief));
+    writer.attribute("probability", doubleToString(probability));
+    writer.attribute("accuracy", doubleToString(accuracy));
+    writer.endElement();
+}
+
 Json::Value NonFactor::toJSON() const {
     Json::Value json;
     json["belief"] = belief;
@@ -43,6 +56,23 @@ Json::Value NonFactor::toJSON() const {
     return json;
 }
 
+void NonFactor::writeJSON(KBJSONWriter& writer) const {
+    writer.startObject();
+    writer.member("accuracy", accuracy);
+    writer.member("belief", belief);
+    writer.member("probability", probability);
+    writer.endObject();
+}
+
+void NonFactor::collectDiagnostics(const KnowledgeBase&, vector<KBDiagnostic>& diagnostics) const {
+    if (!(belief >= 0.0 && belief <= probability && probability <= 100.0)) {
+        diagnostics.push_back({this, "Invalid confidence interval [" + doubleToString(belief) + "; " + doubleToString(probability) + "]"});
+    }
+    if (!(accuracy >= 0.0)) {
+        diagnostics.push_back({this, "Negative accuracy " + doubleToString(accuracy)});
+    }
+}
+
 NonFactor* NonFactor::fromXML(xmlNodePtr node) {
     if (!node) {
         return new NonFactor();
@@ -54,19 +84,19 @@ NonFactor* NonFactor::fromXML(xmlNodePtr node) {
 
     xmlChar* beliefAttr = xmlGetProp(node, BAD_CAST "belief");
     if (beliefAttr) {
-        belief = stod(reinterpret_cast<const char*>(beliefAttr));
+        belief = parseDouble(reinterpret_cast<const char*>(beliefAttr));
         xmlFree(beliefAttr);
     }
 
     xmlChar* probabilityAttr = xmlGetProp(node, BAD_CAST "probability");
     if (probabilityAttr) {
-        probability = stod(reinterpret_cast<const char*>(probabilityAttr));
+        probability = parseDouble(reinterpret_cast<const char*>(probabilityAttr));
         xmlFree(probabilityAttr);
     }
 
     xmlChar* accuracyAttr = xmlGetProp(node, BAD_CAST "accuracy");
     if (accuracyAttr) {
-        accuracy = stod(reinterpret_cast<const char*>(accuracyAttr));
+        accuracy = parseDouble(reinterpret_cast<const char*>(accuracyAttr));
         xmlFree(accuracyAttr);
     }
 
@@ -77,6 +107,17 @@ NonFactor* NonFactor::fromJSON(const Json::Value& json) {
     if (json.isNull()) {
         return new NonFactor();
     }
+    // Атрибут non_factor значений хранит JSON коэффициента строкой
+    if (json.isString()) {
+        Json::Value parsed;
+        Json::CharReaderBuilder builder;
+        string errors;
+        istringstream stream(json.asString());
+        if (!Json::parseFromStream(builder, stream, &parsed, &errors)) {
+            throw runtime_error("Invalid non_factor JSON: " + errors);
+        }
+        return fromJSON(parsed);
+    }
 
     double belief = json.get("belief", 50.0).asDouble();
     double probability = json.get("probability", 100.0).asDouble();
@@ -89,10 +130,16 @@ bool NonFactor::isDefault() const {
     return belief == 50.0 && probability == 100.0 && accuracy == 0.0;
 }
 
-string NonFactor::KRL() const {
-    return "УВЕРЕННОСТЬ [" + doubleToString(belief) + "; " + doubleToString(probability) + "] ТОЧНОСТЬ " + doubleToString(accuracy);
+void NonFactor::writeKRL(string& out) const {
+    out += "УВЕРЕННОСТЬ [";
+    appendDouble(out, belief);
+    out += "; ";
+    appendDouble(out, probability);
+    out += "] ТОЧНОСТЬ ";
+    appendDouble(out, accuracy);
 }
 
 string NonFactor::getXMLOwnerPath() const {
-    return this->owner->getXMLOwnerPath() + "/with";
+    // У общего коэффициента по умолчанию владельца нет
+    return (this->owner ? this->owner->getXMLOwnerPath() : string()) + "/with";
 }
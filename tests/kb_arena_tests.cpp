@@ -0,0 +1,113 @@
+#include <gtest/gtest.h>
+#include "kb_arena.h"
+#include "kb_operation.h"
+#include "kb_reference.h"
+#include "kb_type.h"
+#include "utils.h"
+
+using namespace std;
+
+// Проверяет выравнивание и переход на новый блок при исчерпании текущего.
+TEST(KBArenaTest, AllocateAndRelease)
+{
+    KBArena arena(128);
+    void *a = arena.allocate(24);
+    void *b = arena.allocate(24);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(a) % alignof(max_align_t), 0);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(b) % alignof(max_align_t), 0);
+    EXPECT_EQ(arena.getBlockCount(), 1);
+
+    void *big = arena.allocate(1000);
+    EXPECT_TRUE(arena.owns(big));
+    EXPECT_EQ(arena.getBlockCount(), 2);
+
+    arena.release();
+    EXPECT_EQ(arena.getBlockCount(), 0);
+    EXPECT_EQ(arena.getBytesUsed(), 0);
+}
+
+// Проверяет, что дерево выражения, построенное в области арены, целиком размещается в ней.
+TEST(KBArenaTest, ExpressionTreeInArena)
+{
+    KBArena arena;
+    KBOperation *op;
+    // Узел копирует коэффициент, переданный конструктору
+    NonFactor nf(60.0, 90.0, 0.0);
+    {
+        KBArenaScope scope(arena);
+        op = new KBOperation("&&",
+                             new KBOperation(">", new KBReference("obj", new KBReference("x")), new KBNumericValue(1.0)),
+                             new KBOperation("==", new KBReference("y"), new KBSymbolicValue("a"), &nf));
+    }
+    EXPECT_EQ(KBArena::current(), nullptr);
+    EXPECT_TRUE(arena.owns(op));
+    EXPECT_TRUE(arena.owns(op->getLeft()));
+    EXPECT_TRUE(arena.owns(op->getRight()->getNonFactor()));
+    EXPECT_EQ(arena.getBlockCount(), 1);
+    EXPECT_EQ(op->KRL(), "((obj.x) > (1)) && ((y) == (\"a\") УВЕРЕННОСТЬ [60; 90] ТОЧНОСТЬ 0)");
+    EXPECT_EQ(arena.getLiveCount(), 9);
+
+    // Дерево разрушает сама арена, без delete для корня
+    arena.release();
+    EXPECT_EQ(arena.getLiveCount(), 0);
+    EXPECT_EQ(arena.getBlockCount(), 0);
+}
+
+// Проверяет загрузку из XML в арену и то, что вне области объекты создаются в куче.
+TEST(KBArenaTest, FromXMLInArena)
+{
+    xmlNodePtr node = parseXmlString("<type id=\"t\" meta=\"number\" desc=\"d\"><from>0</from><to>10</to></type>");
+    KBArena arena;
+    KBType *type;
+    {
+        KBArenaScope scope(arena);
+        type = KBType::fromXML(node);
+    }
+    EXPECT_TRUE(arena.owns(type));
+    EXPECT_EQ(type->getId(), "t");
+
+    KBReference *ref = new KBReference("heap");
+    EXPECT_FALSE(arena.owns(ref));
+    delete ref;
+    delete type;
+}
+
+// Сущность, считающая вызовы деструктора
+class CountedEntity : public KBEntity
+{
+public:
+    static int destroyed;
+    KBEntity *child;
+
+    explicit CountedEntity(KBEntity *child = nullptr) : KBEntity("counted"), child(child) {}
+    ~CountedEntity() override
+    {
+        ++destroyed;
+        kbDeleteChild(child);
+    }
+};
+
+int CountedEntity::destroyed = 0;
+
+// Проверяет, что release() разрушает каждую оставшуюся сущность ровно один раз, включая дочерние из кучи.
+TEST(KBArenaTest, ReleaseDestroysLiveEntities)
+{
+    CountedEntity::destroyed = 0;
+    KBArena arena;
+    CountedEntity *heapChild = new CountedEntity();
+    {
+        KBArenaScope scope(arena);
+        new CountedEntity(new CountedEntity(heapChild));
+        delete new CountedEntity(new CountedEntity());
+        // Длинный идентификатор хранится в куче и освобождается деструктором
+        new KBReference(string(200, 'x'));
+    }
+    EXPECT_FALSE(arena.owns(heapChild));
+    EXPECT_EQ(KBArena::of(heapChild), nullptr);
+    EXPECT_EQ(CountedEntity::destroyed, 2);
+    EXPECT_EQ(arena.getLiveCount(), 3);
+
+    arena.release();
+    EXPECT_EQ(CountedEntity::destroyed, 5);
+    EXPECT_EQ(arena.getLiveCount(), 0);
+}
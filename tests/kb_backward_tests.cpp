@@ -0,0 +1,195 @@
+#include <gtest/gtest.h>
+#include "kb_backward.h"
+#include "kb_operation.h"
+#include "kb_test_helpers.h"
+#include <memory>
+
+using namespace std;
+
+class KBBackwardSolverTest : public ::testing::Test
+{
+protected:
+    unique_ptr<KnowledgeBase> kb;
+
+    void SetUp() override
+    {
+        kb.reset(new KnowledgeBase());
+        kb->addType(new KBNumericType("Число", -100, 100));
+        kb->addType(new KBSymbolicType("Диагноз", {"грипп", "простуда"}));
+        kb->addType(new KBSymbolicType("Лечение", {"покой", "чай"}));
+        kb->addObject(new KBObject("Пациент", {new KBProperty("температура", "Число"), new KBProperty("кашель", "Число"),
+                                               new KBProperty("диагноз", "Диагноз"), new KBProperty("лечение", "Лечение")}));
+        kb->addObject(new KBObject("Цикл", {new KBProperty("x", "Число"), new KBProperty("y", "Число")}));
+
+        kb->addRule(new KBRule("ГРИПП",
+                               new KBOperation("&",
+                                               new KBOperation(">", reference("Пациент", "температура"), new KBNumericValue(38)),
+                                               new KBOperation(">", reference("Пациент", "кашель"), new KBNumericValue(0))),
+                               {new KBAssign(reference("Пациент", "диагноз"), new KBSymbolicValue("грипп", new NonFactor(80, 100, 0)))}));
+        kb->addRule(new KBRule("ПРОСТУДА",
+                               new KBOperation(">", reference("Пациент", "температура"), new KBNumericValue(37)),
+                               {new KBAssign(reference("Пациент", "диагноз"), new KBSymbolicValue("простуда", new NonFactor(40, 100, 0)))}));
+        kb->addRule(new KBRule("ЛЕЧЕНИЕ",
+                               new KBOperation("==", reference("Пациент", "диагноз"), new KBSymbolicValue("грипп")),
+                               {new KBAssign(reference("Пациент", "лечение"), new KBSymbolicValue("покой"))},
+                               {new KBAssign(reference("Пациент", "лечение"), new KBSymbolicValue("чай"))}));
+        kb->addRule(new KBRule("X", new KBOperation(">", reference("Цикл", "y"), new KBNumericValue(0)),
+                               {new KBAssign(reference("Цикл", "x"), new KBNumericValue(1))}));
+        kb->addRule(new KBRule("Y", new KBOperation(">", reference("Цикл", "x"), new KBNumericValue(0)),
+                               {new KBAssign(reference("Цикл", "y"), new KBNumericValue(1))}));
+    }
+};
+
+// Проверяет индекс правил по присваиваемым атрибутам.
+TEST_F(KBBackwardSolverTest, Producers)
+{
+    KBBackwardSolver solver(*kb);
+    EXPECT_EQ(solver.getProducers(solver.getLayout().slot("Пациент.диагноз")), vector<uint32_t>({0, 1}));
+    EXPECT_EQ(solver.getProducers(solver.getLayout().slot("Пациент.лечение")), vector<uint32_t>({2}));
+    EXPECT_TRUE(solver.getProducers(solver.getLayout().slot("Пациент.температура")).empty());
+}
+
+// Проверяет вывод цели через подцели и выбор вывода с наибольшей уверенностью.
+TEST_F(KBBackwardSolverTest, SolveGoal)
+{
+    KBBackwardSolver solver(*kb);
+    const KBSlotLayout &layout = solver.getLayout();
+    KBSolverSession session = solver.createSession();
+    session.setFact(layout.slot("Пациент.температура"), KBEvalValue::fromNumber(39, {70, 100, 0}));
+    session.setFact(layout.slot("Пациент.кашель"), KBEvalValue::fromNumber(1, {100, 100, 0}));
+
+    const KBEvalValue &treatment = solver.solve(session, "Пациент.лечение");
+    ASSERT_EQ(treatment.kind, KBEvalValue::SYMBOL);
+    EXPECT_EQ(treatment.symbol, KBProgram::internSymbol("покой"));
+
+    // Оба правила диагноза сработали; грипп увереннее, но не увереннее температуры
+    const KBEvalValue &diagnosis = session.getValue(layout.slot("Пациент.диагноз"));
+    EXPECT_TRUE(session.isSolved(layout.slot("Пациент.диагноз")));
+    EXPECT_EQ(diagnosis.symbol, KBProgram::internSymbol("грипп"));
+    EXPECT_DOUBLE_EQ(diagnosis.nonFactor.belief, 70);
+
+    // Ветка ИНАЧЕ: без кашля - простуда и чай
+    session.setFact(layout.slot("Пациент.кашель"), KBEvalValue::fromNumber(0, {100, 100, 0}));
+    EXPECT_FALSE(session.isSolved(layout.slot("Пациент.диагноз")));
+    EXPECT_EQ(solver.solve(session, "Пациент.лечение").symbol, KBProgram::internSymbol("чай"));
+    EXPECT_EQ(session.getValue(layout.slot("Пациент.диагноз")).symbol, KBProgram::internSymbol("простуда"));
+}
+
+// Проверяет, что доказанные подцели берутся из таблицы сеанса.
+TEST_F(KBBackwardSolverTest, MemoizedSubgoals)
+{
+    KBBackwardSolver solver(*kb);
+    KBSolverSession session = solver.createSession();
+    session.setFact(solver.getLayout().slot("Пациент.температура"), KBEvalValue::fromNumber(39));
+    session.setFact(solver.getLayout().slot("Пациент.кашель"), KBEvalValue::fromNumber(1));
+
+    solver.solve(session, "Пациент.лечение");
+    size_t tried = solver.getRulesTried();
+    EXPECT_EQ(tried, 4);
+
+    size_t hits = session.getMemoHits();
+    solver.solve(session, "Пациент.диагноз");
+    solver.solve(session, "Пациент.лечение");
+    EXPECT_EQ(solver.getRulesTried(), tried);
+    EXPECT_EQ(session.getMemoHits(), hits + 2);
+
+    // Новый сеанс доказывает заново
+    KBSolverSession other = solver.createSession();
+    EXPECT_FALSE(solver.solve(other, "Пациент.лечение").isDefined());
+    EXPECT_EQ(solver.getRulesTried(), tried * 2);
+}
+
+// Проверяет, что циклическая зависимость подцелей не приводит к бесконечной рекурсии.
+TEST_F(KBBackwardSolverTest, CycleDetection)
+{
+    KBBackwardSolver solver(*kb);
+    KBSolverSession session = solver.createSession();
+    EXPECT_FALSE(solver.solve(session, "Цикл.x").isDefined());
+    EXPECT_GT(session.getCycles(), 0);
+    // y получен при незавершенном доказательстве x и завершается вместе с ним
+    EXPECT_TRUE(session.isSolved(solver.getLayout().slot("Цикл.y")));
+    EXPECT_FALSE(session.getValue(solver.getLayout().slot("Цикл.y")).isDefined());
+    EXPECT_TRUE(session.isSolved(solver.getLayout().slot("Цикл.x")));
+
+    KBSolverSession seeded = solver.createSession();
+    seeded.setFact(solver.getLayout().slot("Цикл.y"), KBEvalValue::fromNumber(5, {100, 100, 0}));
+    EXPECT_EQ(solver.solve(seeded, "Цикл.x").number, 1);
+    EXPECT_EQ(seeded.getCycles(), 0);
+
+    EXPECT_THROW(solver.solve(session, "Цикл.z"), invalid_argument);
+}
+
+// Проверяет, что ответ в сеансе не зависит от порядка запросов при циклической зависимости.
+TEST_F(KBBackwardSolverTest, CycleOrderIndependent)
+{
+    KnowledgeBase cyclic;
+    cyclic.addType(new KBNumericType("Число", -100, 100));
+    cyclic.addObject(new KBObject("C", {new KBProperty("x", "Число"), new KBProperty("y", "Число")}));
+    cyclic.addRule(new KBRule("RX1", new KBOperation(">", reference("C", "y"), new KBNumericValue(0)),
+                              {new KBAssign(reference("C", "x"), new KBNumericValue(1))}));
+    cyclic.addRule(new KBRule("RX2", new KBOperation(">", new KBNumericValue(1), new KBNumericValue(0)),
+                              {new KBAssign(reference("C", "x"), new KBNumericValue(1))}));
+    cyclic.addRule(new KBRule("RY", new KBOperation(">", reference("C", "x"), new KBNumericValue(0)),
+                              {new KBAssign(reference("C", "y"), new KBNumericValue(1))}));
+    KBBackwardSolver solver(cyclic);
+
+    KBSolverSession fresh = solver.createSession();
+    const KBEvalValue y = solver.solve(fresh, "C.y");
+    ASSERT_TRUE(y.isDefined());
+    EXPECT_EQ(y.number, 1);
+
+    KBSolverSession xFirst = solver.createSession();
+    EXPECT_EQ(solver.solve(xFirst, "C.x").number, 1);
+    EXPECT_EQ(solver.solve(xFirst, "C.y"), y);
+
+    KBSolverSession yFirst = solver.createSession();
+    EXPECT_EQ(solver.solve(yFirst, "C.y"), y);
+    EXPECT_EQ(solver.solve(yFirst, "C.x"), solver.solve(xFirst, "C.x"));
+}
+
+// Проверяет, что общие подцели цикла выводятся один раз за проход лидера, а не заново на каждом пути.
+TEST_F(KBBackwardSolverTest, CyclicDiamondTabled)
+{
+    // g0 <- a0 | b0, a0 <- g1, b0 <- g1, ..., g(N) <- 1 | g0
+    const int layers = 12;
+    KnowledgeBase diamond;
+    diamond.addType(new KBNumericType("Число", -100, 100));
+    vector<KBProperty *> properties;
+    for (int i = 0; i <= layers; ++i)
+    {
+        properties.push_back(new KBProperty("g" + to_string(i), "Число"));
+        properties.push_back(new KBProperty("a" + to_string(i), "Число"));
+        properties.push_back(new KBProperty("b" + to_string(i), "Число"));
+    }
+    diamond.addObject(new KBObject("D", properties));
+    auto rule = [&](const string &name, Evaluatable *condition, const string &target)
+    {
+        diamond.addRule(new KBRule(name, condition, {new KBAssign(reference("D", target), new KBNumericValue(1))}));
+    };
+    for (int i = 0; i < layers; ++i)
+    {
+        const string layer = to_string(i);
+        const string next = to_string(i + 1);
+        rule("GA" + layer, new KBOperation(">", reference("D", "a" + layer), new KBNumericValue(0)), "g" + layer);
+        rule("GB" + layer, new KBOperation(">", reference("D", "b" + layer), new KBNumericValue(0)), "g" + layer);
+        rule("A" + layer, new KBOperation(">", reference("D", "g" + next), new KBNumericValue(0)), "a" + layer);
+        rule("B" + layer, new KBOperation(">", reference("D", "g" + next), new KBNumericValue(0)), "b" + layer);
+    }
+    const string last = "g" + to_string(layers);
+    rule("SEED", new KBOperation(">", new KBNumericValue(1), new KBNumericValue(0)), last);
+    rule("BACK", new KBOperation(">", reference("D", "g0"), new KBNumericValue(0)), last);
+    const size_t ruleCount = diamond.getRules().size();
+
+    KBBackwardSolver solver(diamond);
+    KBSolverSession top = solver.createSession();
+    EXPECT_EQ(solver.solve(top, "D.g0").number, 1);
+    EXPECT_GT(top.getCycles(), 0);
+    // Два прохода лидера: каждое правило пробуется не более двух раз за проход
+    EXPECT_LE(solver.getRulesTried(), 4 * ruleCount);
+    EXPECT_EQ(solver.solve(top, "D." + last).number, 1);
+
+    KBSolverSession bottom = solver.createSession();
+    EXPECT_EQ(solver.solve(bottom, "D." + last).number, 1);
+    EXPECT_EQ(solver.solve(bottom, "D.g0").number, 1);
+    EXPECT_LE(solver.getRulesTried(), 8 * ruleCount);
+}
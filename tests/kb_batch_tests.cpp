@@ -0,0 +1,196 @@
+#include <gtest/gtest.h>
+#include "kb_batch.h"
+#include "kb_operation.h"
+#include "kb_reference.h"
+#include "kb_symbol.h"
+#include <cmath>
+#include <vector>
+
+using namespace std;
+
+// Проверяет, что пакетное вычисление совпадает с покомпонентным выполнением на KBVirtualMachine.
+TEST(KBBatchEvaluatorTest, MatchesScalarVM)
+{
+    KBOperation op("or",
+                   new KBOperation("gt", new KBOperation("mul", new KBReference("x"), new KBNumericValue(2.0)), new KBReference("y")),
+                   new KBOperation("not", new KBOperation("eq", new KBReference("y"), new KBNumericValue(3.0))));
+    KBProgram program = KBProgram::compile(&op);
+    ASSERT_EQ(program.getReferences().size(), 2);
+
+    const size_t rows = 1000;
+    vector<double> x(rows), y(rows), yBelief(rows);
+    for (size_t i = 0; i < rows; ++i)
+    {
+        x[i] = (double)(i % 17) - 5.0;
+        y[i] = i % 7 == 0 ? NAN : (double)(i % 5);
+        yBelief[i] = (double)(i % 100);
+    }
+    KBColumn xColumn;
+    xColumn.values = x.data();
+    KBColumn yColumn;
+    yColumn.values = y.data();
+    yColumn.belief = yBelief.data();
+
+    vector<double> result(rows), belief(rows);
+    KBBatchEvaluator evaluator(program);
+    evaluator.run({xColumn, yColumn}, rows, result.data(), belief.data());
+
+    KBVirtualMachine vm;
+    for (size_t i = 0; i < rows; ++i)
+    {
+        KBEvalValue yValue = std::isnan(y[i]) ? KBEvalValue::undefined({yBelief[i], 100.0, 0.0}) : KBEvalValue::fromNumber(y[i], {yBelief[i], 100.0, 0.0});
+        KBEvalValue expected = vm.run(program, {KBEvalValue::fromNumber(x[i]), yValue});
+        if (expected.isDefined())
+        {
+            EXPECT_EQ(result[i], expected.boolean ? 1.0 : 0.0) << "row " << i;
+        }
+        else
+        {
+            EXPECT_TRUE(std::isnan(result[i])) << "row " << i;
+        }
+        EXPECT_EQ(belief[i], expected.nonFactor.belief) << "row " << i;
+    }
+}
+
+// Проверяет арифметические ядра и обработку деления на ноль.
+TEST(KBBatchEvaluatorTest, ArithmeticKernels)
+{
+    KBOperation op("div", new KBOperation("sub", new KBReference("a"), new KBNumericValue(1.0)), new KBReference("b"));
+    KBProgram program = KBProgram::compile(&op);
+
+    vector<double> a = {3.0, 5.0, 7.0}, b = {2.0, 0.0, 3.0};
+    KBColumn aColumn, bColumn;
+    aColumn.values = a.data();
+    bColumn.values = b.data();
+    bColumn.defaultBelief = 80.0;
+
+    vector<double> result(3), belief(3);
+    KBBatchEvaluator evaluator(program);
+    evaluator.run({aColumn, bColumn}, 3, result.data(), belief.data());
+
+    EXPECT_EQ(result[0], 1.0);
+    EXPECT_TRUE(std::isnan(result[1]));
+    EXPECT_EQ(result[2], 2.0);
+    EXPECT_EQ(belief[0], 50.0);
+}
+
+// Значения столбца заданного вида; последняя строка не определена
+static vector<double> kindValues(KBEvalValue::Kind kind)
+{
+    switch (kind)
+    {
+    case KBEvalValue::BOOLEAN:
+        return {0.0, 1.0, 1.0, 0.0, NAN};
+    case KBEvalValue::SYMBOL:
+        return {(double)KBSymbol("a").getId(), (double)KBSymbol("b").getId(), (double)KBSymbol("a").getId(), 1.0, NAN};
+    default:
+        return {0.0, 1.0, -3.0, 2.0, NAN};
+    }
+}
+
+static KBEvalValue slotValue(KBEvalValue::Kind kind, double value)
+{
+    if (std::isnan(value))
+    {
+        return KBEvalValue::undefined();
+    }
+    switch (kind)
+    {
+    case KBEvalValue::BOOLEAN:
+        return KBEvalValue::fromBoolean(value != 0.0);
+    case KBEvalValue::SYMBOL:
+        return KBEvalValue::fromSymbol((uint32_t)value);
+    default:
+        return KBEvalValue::fromNumber(value);
+    }
+}
+
+static void expectSameAsVM(const KBEvalValue &expected, double result, double belief, KBEvalValue::Kind kind, const string &context)
+{
+    if (!expected.isDefined())
+    {
+        EXPECT_TRUE(std::isnan(result)) << context;
+    }
+    else
+    {
+        EXPECT_EQ(kind, expected.kind) << context;
+        EXPECT_EQ(result, expected.kind == KBEvalValue::BOOLEAN ? (expected.boolean ? 1.0 : 0.0) : expected.number) << context;
+    }
+    EXPECT_EQ(belief, expected.nonFactor.belief) << context;
+}
+
+// Проверяет, что каждая операция над значениями разных видов дает тот же результат, что KBVirtualMachine.
+TEST(KBBatchEvaluatorTest, MixedKindsMatchVM)
+{
+    const KBEvalValue::Kind kinds[] = {KBEvalValue::NUMBER, KBEvalValue::BOOLEAN, KBEvalValue::SYMBOL};
+    KBVirtualMachine vm;
+    for (const KBOperatorInfo &info : KB_OPERATORS)
+    {
+        for (KBEvalValue::Kind leftKind : kinds)
+        {
+            vector<double> left = kindValues(leftKind);
+            KBColumn leftColumn;
+            leftColumn.kind = leftKind;
+            if (!info.binary)
+            {
+                KBOperation op(info.tag, new KBReference("a"));
+                KBProgram program = KBProgram::compile(&op);
+                leftColumn.values = left.data();
+                vector<double> result(left.size()), belief(left.size());
+                KBBatchEvaluator evaluator(program);
+                evaluator.run({leftColumn}, left.size(), result.data(), belief.data());
+                for (size_t i = 0; i < left.size(); ++i)
+                {
+                    expectSameAsVM(vm.run(program, {slotValue(leftKind, left[i])}), result[i], belief[i], evaluator.getResultKind(),
+                                   string(info.tag) + " row " + to_string(i));
+                }
+                continue;
+            }
+
+            // Правый операнд - столбец каждого вида
+            for (KBEvalValue::Kind rightKind : kinds)
+            {
+                vector<double> right = kindValues(rightKind);
+                vector<double> a, b;
+                for (double x : left)
+                {
+                    for (double y : right)
+                    {
+                        a.push_back(x);
+                        b.push_back(y);
+                    }
+                }
+                KBColumn aColumn = leftColumn, bColumn;
+                aColumn.values = a.data();
+                bColumn.values = b.data();
+                bColumn.kind = rightKind;
+                KBOperation op(info.tag, new KBReference("a"), new KBReference("b"));
+                KBProgram program = KBProgram::compile(&op);
+                vector<double> result(a.size()), belief(a.size());
+                KBBatchEvaluator evaluator(program);
+                evaluator.run({aColumn, bColumn}, a.size(), result.data(), belief.data());
+                for (size_t i = 0; i < a.size(); ++i)
+                {
+                    expectSameAsVM(vm.run(program, {slotValue(leftKind, a[i]), slotValue(rightKind, b[i])}), result[i], belief[i],
+                                   evaluator.getResultKind(), string(info.tag) + " columns " + to_string(leftKind) + "/" + to_string(rightKind) + " row " + to_string(i));
+                }
+            }
+
+            // Правый операнд - литерал каждого вида
+            for (Evaluatable *constant : {(Evaluatable *)new KBNumericValue(2.0), (Evaluatable *)new KBBooleanValue(true), (Evaluatable *)new KBSymbolicValue("a")})
+            {
+                KBOperation op(info.tag, new KBReference("a"), constant);
+                KBProgram program = KBProgram::compile(&op);
+                leftColumn.values = left.data();
+                vector<double> result(left.size()), belief(left.size());
+                KBBatchEvaluator evaluator(program);
+                evaluator.run({leftColumn}, left.size(), result.data(), belief.data());
+                for (size_t i = 0; i < left.size(); ++i)
+                {
+                    expectSameAsVM(vm.run(program, {slotValue(leftKind, left[i])}), result[i], belief[i], evaluator.getResultKind(),
+                                   string(info.tag) + " " + op.KRL() + " row " + to_string(i));
+                }
+            }
+        }
+    }
+}
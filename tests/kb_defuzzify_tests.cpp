@@ -0,0 +1,118 @@
+#include <gtest/gtest.h>
+#include "kb_defuzzify.h"
+#include <algorithm>
+#include <cmath>
+#include <memory>
+
+using namespace std;
+
+static KBFuzzyType *makeType()
+{
+    MembershipFunction low("низкий", 0, 100, {new MFPoint(0, 1), new MFPoint(20, 1), new MFPoint(50, 0)});
+    MembershipFunction middle("средний", 0, 100, {new MFPoint(20, 0), new MFPoint(50, 1), new MFPoint(80, 0)});
+    MembershipFunction high("высокий", 0, 100, {new MFPoint(50, 0), new MFPoint(80, 1), new MFPoint(100, 1)});
+    // Ступенька: 0.2 до 60, затем скачок до 0.9 и спад до 0.5
+    MembershipFunction step("порог", 0, 100, {new MFPoint(0, 0.2), new MFPoint(60, 0.2), new MFPoint(60, 0.9), new MFPoint(100, 0.5)});
+    return new KBFuzzyType("Уровень", {&low, &middle, &high, &step});
+}
+
+// Центр тяжести и биссектриса по мелкой сетке - эталон для аналитического вычисления
+static void reference(const KBFuzzyType &type, const vector<double> &activations, bool scale, double &centroid, double &bisector)
+{
+    const vector<MembershipFunction *> &terms = type.getMembershipFunctionList();
+    const size_t n = 400000;
+    const double h = 100.0 / n;
+    vector<double> mu(n);
+    double area = 0.0;
+    double moment = 0.0;
+    for (size_t i = 0; i < n; ++i)
+    {
+        double x = (i + 0.5) * h;
+        for (size_t t = 0; t < terms.size(); ++t)
+        {
+            double y = terms[t]->evaluate(x);
+            mu[i] = std::max(mu[i], scale ? y * activations[t] : std::min(y, activations[t]));
+        }
+        area += mu[i] * h;
+        moment += x * mu[i] * h;
+    }
+    centroid = moment / area;
+    double rest = area / 2;
+    for (size_t i = 0; i < n; ++i)
+    {
+        if (mu[i] * h >= rest)
+        {
+            bisector = i * h + rest / mu[i];
+            return;
+        }
+        rest -= mu[i] * h;
+    }
+}
+
+// Проверяет значения для одного симметричного терма.
+TEST(KBDefuzzifierTest, SymmetricTerm)
+{
+    unique_ptr<KBFuzzyType> type(makeType());
+    KBDefuzzifier defuzzifier(*type);
+    ASSERT_EQ(defuzzifier.getTermCount(), 4);
+    EXPECT_EQ(defuzzifier.getMin(), 0);
+    EXPECT_EQ(defuzzifier.getMax(), 100);
+    for (double alpha : {1.0, 0.5})
+    {
+        vector<double> activations = {0, alpha, 0, 0};
+        EXPECT_NEAR(defuzzifier.defuzzify(activations, KBDefuzzifier::CENTROID), 50, 1e-9);
+        EXPECT_NEAR(defuzzifier.defuzzify(activations, KBDefuzzifier::BISECTOR), 50, 1e-9);
+        EXPECT_NEAR(defuzzifier.defuzzify(activations, KBDefuzzifier::MEAN_OF_MAX), 50, 1e-9);
+    }
+}
+
+// Проверяет ограничение термов уровнем активации и их объединение по сравнению с сеткой.
+TEST(KBDefuzzifierTest, ClippedUnion)
+{
+    unique_ptr<KBFuzzyType> type(makeType());
+    KBDefuzzifier defuzzifier(*type);
+    vector<double> activations = {0.5, 0.3, 1.0, 0.1};
+    double centroid, bisector;
+    reference(*type, activations, false, centroid, bisector);
+    EXPECT_NEAR(defuzzifier.defuzzify(activations, KBDefuzzifier::CENTROID), centroid, 1e-6);
+    EXPECT_NEAR(defuzzifier.defuzzify(activations, KBDefuzzifier::BISECTOR), bisector, 1e-6);
+    // Максимум - плато высокого терма на [80, 100]
+    EXPECT_NEAR(defuzzifier.defuzzify(activations, KBDefuzzifier::MEAN_OF_MAX), 90, 1e-9);
+
+    // Объединение - непрерывная цепочка отрезков на всей области
+    vector<KBDefuzzifier::Segment> segments = defuzzifier.aggregate(activations);
+    ASSERT_FALSE(segments.empty());
+    EXPECT_EQ(segments.front().x0, 0);
+    EXPECT_EQ(segments.back().x1, 100);
+    for (size_t i = 1; i < segments.size(); ++i)
+    {
+        EXPECT_DOUBLE_EQ(segments[i].x0, segments[i - 1].x1);
+        EXPECT_LE(std::max(segments[i].y0, segments[i].y1), 1.0);
+    }
+}
+
+// Проверяет масштабирование термов и ступеньку.
+TEST(KBDefuzzifierTest, ScaledUnion)
+{
+    unique_ptr<KBFuzzyType> type(makeType());
+    KBDefuzzifier defuzzifier(*type, KBDefuzzifier::SCALE);
+    vector<double> activations = {0.4, 0.8, 0.2, 0.7};
+    double centroid, bisector;
+    reference(*type, activations, true, centroid, bisector);
+    EXPECT_NEAR(defuzzifier.defuzzify(activations, KBDefuzzifier::CENTROID), centroid, 1e-6);
+    EXPECT_NEAR(defuzzifier.defuzzify(activations, KBDefuzzifier::BISECTOR), bisector, 1e-6);
+    // Вершина среднего терма 0.8 выше ступеньки 0.9 * 0.7
+    EXPECT_NEAR(defuzzifier.defuzzify(activations, KBDefuzzifier::MEAN_OF_MAX), 50, 1e-9);
+}
+
+// Проверяет, что без активных термов результат неопределен.
+TEST(KBDefuzzifierTest, NoActivation)
+{
+    unique_ptr<KBFuzzyType> type(makeType());
+    KBDefuzzifier defuzzifier(*type);
+    vector<double> activations = {0, 0, -1, numeric_limits<double>::quiet_NaN()};
+    EXPECT_TRUE(std::isnan(defuzzifier.defuzzify(activations, KBDefuzzifier::CENTROID)));
+    EXPECT_TRUE(std::isnan(defuzzifier.defuzzify(activations, KBDefuzzifier::BISECTOR)));
+    EXPECT_TRUE(std::isnan(defuzzifier.defuzzify(activations, KBDefuzzifier::MEAN_OF_MAX)));
+    EXPECT_THROW(defuzzifier.defuzzify(vector<double>{1}, KBDefuzzifier::CENTROID), invalid_argument);
+}
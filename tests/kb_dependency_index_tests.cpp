@@ -0,0 +1,80 @@
+#include <gtest/gtest.h>
+#include "knowledge_base.h"
+#include "kb_operation.h"
+#include "kb_test_helpers.h"
+#include <memory>
+
+using namespace std;
+
+class KBDependencyIndexTest : public ::testing::Test
+{
+protected:
+    unique_ptr<KnowledgeBase> kb;
+
+    void SetUp() override
+    {
+        kb.reset(new KnowledgeBase());
+        kb->addType(new KBNumericType("Давление", 0, 100));
+        kb->addObject(new KBObject("Насос", {new KBProperty("давление", "Давление"), new KBProperty("уставка", "Давление")}));
+        kb->addObject(new KBObject("Клапан", {new KBProperty("давление", "Давление")}));
+        kb->addRule(new KBRule("ПРАВИЛО1",
+                               new KBOperation(">", reference("Насос", "давление"), new KBNumericValue(10)),
+                               {new KBAssign(reference("Клапан", "давление"), reference("Насос", "уставка"))}));
+        kb->addRule(new KBRule("ПРАВИЛО2",
+                               new KBOperation("&",
+                                               new KBOperation("<", reference("Клапан", "давление"), new KBNumericValue(5)),
+                                               new KBOperation(">", reference("Насос", "давление"), new KBNumericValue(1))),
+                               {}));
+    }
+};
+
+static vector<string> ruleIds(const vector<KBRule *> &rules)
+{
+    vector<string> result;
+    for (const KBRule *rule : rules)
+    {
+        result.push_back(rule->getId());
+    }
+    return result;
+}
+
+// Проверяет, что индекс связывает путь с ближайшим выражением и правилом.
+TEST_F(KBDependencyIndexTest, Dependents)
+{
+    const KBDependencyIndex &index = kb->getDependencies();
+    EXPECT_EQ(index.size(), 3);
+
+    const vector<KBDependency> &pressure = index.getDependents("Насос.давление");
+    ASSERT_EQ(pressure.size(), 2);
+    EXPECT_EQ(pressure[0].rule, 0);
+    EXPECT_TRUE(pressure[0].condition);
+    EXPECT_EQ(pressure[0].expression, kb->getRule("ПРАВИЛО1")->getCondition());
+    EXPECT_EQ(pressure[1].rule, 1);
+    EXPECT_EQ(pressure[1].expression, pressure[1].ref->owner);
+
+    const vector<KBDependency> &setpoint = index.getDependents("Насос.уставка");
+    ASSERT_EQ(setpoint.size(), 1);
+    EXPECT_FALSE(setpoint[0].condition);
+    EXPECT_EQ(setpoint[0].expression, setpoint[0].ref);
+
+    EXPECT_TRUE(index.getDependents("Котел.давление").empty());
+}
+
+// Проверяет выбор правил для перепроверки после изменения фактов.
+TEST_F(KBDependencyIndexTest, AffectedRules)
+{
+    EXPECT_EQ(ruleIds(kb->getAffectedRules({"Насос.давление"})), vector<string>({"ПРАВИЛО1", "ПРАВИЛО2"}));
+    EXPECT_EQ(ruleIds(kb->getAffectedRules({"Клапан.давление"})), vector<string>({"ПРАВИЛО2"}));
+    EXPECT_TRUE(kb->getAffectedRules({"Насос.уставка"}).empty());
+    EXPECT_EQ(ruleIds(kb->getAffectedRules({"Клапан.давление", "Насос.давление"})), vector<string>({"ПРАВИЛО1", "ПРАВИЛО2"}));
+}
+
+// Проверяет, что индекс строится при загрузке базы из XML.
+TEST_F(KBDependencyIndexTest, BuiltOnLoad)
+{
+    xmlNodePtr node = kb->toXML();
+    unique_ptr<KnowledgeBase> loaded(KnowledgeBase::fromXML(node));
+    xmlFreeNode(node);
+    EXPECT_EQ(loaded->getDependencies().size(), 3);
+    EXPECT_EQ(ruleIds(loaded->getAffectedRules({"Клапан.давление"})), vector<string>({"ПРАВИЛО2"}));
+}
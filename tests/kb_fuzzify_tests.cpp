@@ -0,0 +1,82 @@
+#include <gtest/gtest.h>
+#include "kb_fuzzify.h"
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <random>
+
+using namespace std;
+
+static KBFuzzyType *makeType()
+{
+    MembershipFunction low("низкий", 0, 100, {new MFPoint(0, 1), new MFPoint(20, 1), new MFPoint(50, 0)});
+    MembershipFunction middle("средний", 0, 100, {new MFPoint(20, 0), new MFPoint(50, 1), new MFPoint(80, 0)});
+    MembershipFunction high("высокий", 0, 100, {new MFPoint(50, 0), new MFPoint(80, 1), new MFPoint(100, 1)});
+    // Ступенька: 0.2 до 60, затем скачок до 0.9 и спад до 0.5
+    MembershipFunction step("порог", 0, 100, {new MFPoint(0, 0.2), new MFPoint(60, 0.2), new MFPoint(60, 0.9), new MFPoint(100, 0.5)});
+    return new KBFuzzyType("Уровень", {&low, &middle, &high, &step});
+}
+
+// Проверяет форму матрицы и значения в характерных точках.
+TEST(KBFuzzifierTest, TermBySampleMatrix)
+{
+    unique_ptr<KBFuzzyType> type(makeType());
+    KBFuzzifier fuzzifier(*type);
+    ASSERT_EQ(fuzzifier.getTermCount(), 4);
+    EXPECT_EQ(fuzzifier.getTermName(1), "средний");
+
+    vector<double> x = {-10, 20, 35, 65, 60, 120};
+    vector<double> degrees = fuzzifier.fuzzify(x);
+    ASSERT_EQ(degrees.size(), 4 * x.size());
+    const double expected[4][6] = {
+        {1, 1, 0.5, 0, 0, 0},
+        {0, 0, 0.5, 0.5, 2.0 / 3, 0},
+        {0, 0, 0, 0.5, 1.0 / 3, 1},
+        {0.2, 0.2, 0.2, 0.85, 0.9, 0.5},
+    };
+    for (size_t t = 0; t < 4; ++t)
+    {
+        for (size_t i = 0; i < x.size(); ++i)
+        {
+            EXPECT_NEAR(degrees[t * x.size() + i], expected[t][i], 1e-12) << t << " " << x[i];
+        }
+    }
+}
+
+// Проверяет совпадение с точной кривой на нескольких блоках случайных значений, в том числе
+// для термов в режиме таблицы.
+TEST(KBFuzzifierTest, MatchesScalarEvaluation)
+{
+    unique_ptr<KBFuzzyType> type(makeType());
+    const vector<MembershipFunction *> &terms = type->getMembershipFunctionList();
+    EXPECT_TRUE(terms[0]->useLookupTable(100));
+    KBFuzzifier fuzzifier(*type);
+    mt19937 random(42);
+    uniform_real_distribution<double> distribution(-20, 120);
+    vector<double> x(KBFuzzifier::BLOCK_SIZE * 3 + 17);
+    for (double &value : x)
+    {
+        value = distribution(random);
+    }
+    vector<double> degrees = fuzzifier.fuzzify(x);
+    for (size_t t = 0; t < terms.size(); ++t)
+    {
+        for (size_t i = 0; i < x.size(); ++i)
+        {
+            ASSERT_NEAR(degrees[t * x.size() + i], terms[t]->evaluateExact(x[i]), 1e-12);
+        }
+    }
+}
+
+// Проверяет, что неопределенное значение дает NaN, а терм без точек - 0.
+TEST(KBFuzzifierTest, UndefinedAndEmpty)
+{
+    MembershipFunction flat("ровный", 0, 1, {new MFPoint(0.5, 0.4)});
+    MembershipFunction empty("пустой", 0, 1, {});
+    KBFuzzifier fuzzifier(vector<MembershipFunction *>{&flat, &empty});
+    vector<double> degrees = fuzzifier.fuzzify({numeric_limits<double>::quiet_NaN(), 0.9});
+    EXPECT_TRUE(std::isnan(degrees[0]));
+    EXPECT_DOUBLE_EQ(degrees[1], 0.4);
+    EXPECT_DOUBLE_EQ(degrees[2], 0.0);
+    EXPECT_DOUBLE_EQ(degrees[3], 0.0);
+}
@@ -0,0 +1,155 @@
+#include <gtest/gtest.h>
+#include "kb_fuzzy_inference.h"
+#include "kb_operation.h"
+#include "kb_test_helpers.h"
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <random>
+
+using namespace std;
+
+static KBOperation *is(const char *property, const char *term)
+{
+    return new KBOperation("==", reference("Котел", property), new KBSymbolicValue(term));
+}
+
+class KBFuzzyInferenceTest : public ::testing::Test
+{
+protected:
+    unique_ptr<KnowledgeBase> kb;
+
+    void SetUp() override
+    {
+        kb.reset(new KnowledgeBase());
+        MembershipFunction cold("холодно", 0, 40, {new MFPoint(0, 1), new MFPoint(10, 1), new MFPoint(20, 0)});
+        MembershipFunction warm("тепло", 0, 40, {new MFPoint(10, 0), new MFPoint(20, 1), new MFPoint(30, 0)});
+        MembershipFunction hot("жарко", 0, 40, {new MFPoint(20, 0), new MFPoint(30, 1), new MFPoint(40, 1)});
+        kb->addType(new KBFuzzyType("Температура", {&cold, &warm, &hot}));
+        MembershipFunction dry("низкая", 0, 100, {new MFPoint(0, 1), new MFPoint(50, 0)});
+        MembershipFunction wet("высокая", 0, 100, {new MFPoint(50, 0), new MFPoint(100, 1)});
+        kb->addType(new KBFuzzyType("Влажность", {&dry, &wet}));
+        MembershipFunction low("низкая", 0, 100, {new MFPoint(0, 1), new MFPoint(20, 1), new MFPoint(50, 0)});
+        MembershipFunction middle("средняя", 0, 100, {new MFPoint(20, 0), new MFPoint(50, 1), new MFPoint(80, 0)});
+        MembershipFunction high("высокая", 0, 100, {new MFPoint(50, 0), new MFPoint(80, 1), new MFPoint(100, 1)});
+        kb->addType(new KBFuzzyType("Мощность", {&low, &middle, &high}));
+        kb->addType(new KBNumericType("Число", 0, 1000));
+        kb->addType(new KBSymbolicType("Режим", {"норма", "авария"}));
+        kb->addObject(new KBObject("Котел", {new KBProperty("температура", "Температура"), new KBProperty("влажность", "Влажность"),
+                                             new KBProperty("мощность", "Мощность"), new KBProperty("расход", "Число"),
+                                             new KBProperty("режим", "Режим")}));
+
+        kb->addRule(new KBRule("ХОЛОДНО", is("температура", "холодно"),
+                               {new KBAssign(reference("Котел", "мощность"), new KBSymbolicValue("высокая")),
+                                new KBAssign(reference("Котел", "расход"), new KBNumericValue(10))}));
+        kb->addRule(new KBRule("ТЕПЛО", new KBOperation("&", is("температура", "тепло"), new KBOperation("!", is("влажность", "высокая"))),
+                               {new KBAssign(reference("Котел", "мощность"), new KBSymbolicValue("средняя")),
+                                new KBAssign(reference("Котел", "расход"), new KBNumericValue(5))}));
+        kb->addRule(new KBRule("ЖАРКО", new KBOperation("|", is("температура", "жарко"), is("влажность", "высокая")),
+                               {new KBAssign(reference("Котел", "мощность"), new KBSymbolicValue("низкая")),
+                                new KBAssign(reference("Котел", "расход"),
+                                             new KBOperation("*", reference("Котел", "температура"), new KBNumericValue(0.1)))}));
+        // Четкое правило в нечеткий вывод не входит
+        kb->addRule(new KBRule("АВАРИЯ", new KBOperation(">", reference("Котел", "расход"), new KBNumericValue(100)),
+                               {new KBAssign(reference("Котел", "режим"), new KBSymbolicValue("авария"))}));
+    }
+};
+
+// Проверяет отбор нечетких правил, входов и выходов.
+TEST_F(KBFuzzyInferenceTest, Structure)
+{
+    KBFuzzyInference inference(*kb);
+    ASSERT_EQ(inference.getRuleCount(), 3);
+    EXPECT_EQ(inference.getRule(2)->getId(), "ЖАРКО");
+    ASSERT_EQ(inference.getInputCount(), 2);
+    EXPECT_EQ(inference.getInputIndex("Котел.температура"), 0);
+    EXPECT_EQ(inference.getInputIndex("Котел.влажность"), 1);
+    EXPECT_EQ(inference.getInputIndex("Котел.расход"), KBFuzzyInference::NONE);
+    ASSERT_EQ(inference.getOutputCount(), 2);
+    EXPECT_EQ(inference.getOutputIndex("Котел.мощность"), 0);
+    EXPECT_FALSE(inference.isSugeno(0));
+    EXPECT_TRUE(inference.isSugeno(1));
+}
+
+// Проверяет активации правил для обеих пар операций И/ИЛИ.
+TEST_F(KBFuzzyInferenceTest, Activations)
+{
+    const double input[] = {15, 70};
+    double activations[3];
+
+    KBFuzzyInference minMax(*kb);
+    minMax.activate(input, 1, activations);
+    EXPECT_DOUBLE_EQ(activations[0], 0.5);
+    EXPECT_DOUBLE_EQ(activations[1], 0.5);
+    EXPECT_DOUBLE_EQ(activations[2], 0.4);
+
+    KBFuzzyInference::Options options;
+    options.norm = KBFuzzyInference::PRODUCT;
+    KBFuzzyInference product(*kb, options);
+    product.activate(input, 1, activations);
+    EXPECT_DOUBLE_EQ(activations[0], 0.5);
+    EXPECT_DOUBLE_EQ(activations[1], 0.5 * 0.6);
+    EXPECT_DOUBLE_EQ(activations[2], 0.4);
+}
+
+// Проверяет выходы Мамдани и Сугено для одного вектора входов.
+TEST_F(KBFuzzyInferenceTest, MamdaniAndSugeno)
+{
+    const KBFuzzyType *power = static_cast<const KBFuzzyType *>(kb->getType("Мощность"));
+    for (KBDefuzzifier::Method method : {KBDefuzzifier::CENTROID, KBDefuzzifier::BISECTOR, KBDefuzzifier::MEAN_OF_MAX})
+    {
+        KBFuzzyInference::Options options;
+        options.method = method;
+        KBFuzzyInference inference(*kb, options);
+        vector<double> result = inference.infer({15, 70});
+        ASSERT_EQ(result.size(), 2);
+        // Термы мощности: низкая - ЖАРКО, средняя - ТЕПЛО, высокая - ХОЛОДНО
+        EXPECT_DOUBLE_EQ(result[0], KBDefuzzifier(*power).defuzzify({0.4, 0.5, 0.5}, method));
+        EXPECT_DOUBLE_EQ(result[1], (0.5 * 10 + 0.5 * 5 + 0.4 * 1.5) / 1.4);
+    }
+}
+
+// Проверяет, что пакетный вывод совпадает с выводом по одному вектору.
+TEST_F(KBFuzzyInferenceTest, BatchMatchesSingle)
+{
+    KBFuzzyInference::Options options;
+    options.norm = KBFuzzyInference::PRODUCT;
+    options.implication = KBDefuzzifier::SCALE;
+    KBFuzzyInference inference(*kb, options);
+    const size_t rows = KBFuzzifier::BLOCK_SIZE * 2 + 31;
+    mt19937 random(7);
+    uniform_real_distribution<double> temperature(-5, 45);
+    uniform_real_distribution<double> humidity(0, 100);
+    vector<double> input(2 * rows);
+    for (size_t i = 0; i < rows; ++i)
+    {
+        input[i] = temperature(random);
+        input[rows + i] = i % 10 == 0 ? numeric_limits<double>::quiet_NaN() : humidity(random);
+    }
+    vector<double> output(2 * rows);
+    inference.run(input.data(), rows, output.data());
+    for (size_t i = 0; i < rows; ++i)
+    {
+        vector<double> single = inference.infer({input[i], input[rows + i]});
+        ASSERT_DOUBLE_EQ(output[i], single[0]) << i;
+        ASSERT_DOUBLE_EQ(output[rows + i], single[1]) << i;
+    }
+}
+
+// Проверяет неопределенный выход без сработавших правил и ошибку в имени терма.
+TEST_F(KBFuzzyInferenceTest, UndefinedAndErrors)
+{
+    KBFuzzyInference inference(*kb);
+    vector<double> result = inference.infer({numeric_limits<double>::quiet_NaN(), 10});
+    EXPECT_TRUE(std::isnan(result[0]));
+    EXPECT_TRUE(std::isnan(result[1]));
+    EXPECT_THROW(inference.infer({1}), invalid_argument);
+
+    kb->addRule(new KBRule("ОШИБКА", is("температура", "морозно"), {}));
+    EXPECT_THROW(KBFuzzyInference broken(*kb), invalid_argument);
+    // Добавленное правило не скомпилировано: вывод по устаревшему набору правил запрещен
+    EXPECT_THROW(inference.infer({15, 70}), logic_error);
+
+    kb->schemaChanged();
+    EXPECT_THROW(inference.infer({15, 70}), logic_error);
+}
@@ -0,0 +1,91 @@
+#include <gtest/gtest.h>
+#include "kb_incremental.h"
+#include "kb_operation.h"
+#include "kb_test_helpers.h"
+#include <memory>
+
+using namespace std;
+
+static const KBNonFactorValue CERTAIN = {100, 100, 0};
+
+class KBIncrementalEvaluatorTest : public ::testing::Test
+{
+protected:
+    unique_ptr<KnowledgeBase> kb;
+
+    void SetUp() override
+    {
+        kb.reset(new KnowledgeBase());
+        kb->addType(new KBNumericType("Давление", 0, 100));
+        kb->addObject(new KBObject("Насос", {new KBProperty("давление", "Давление"), new KBProperty("уставка", "Давление")}));
+        kb->addObject(new KBObject("Клапан", {new KBProperty("давление", "Давление")}));
+        // (Насос.давление > Насос.уставка) & (Клапан.давление < 5)
+        kb->addRule(new KBRule("ПРАВИЛО1",
+                               new KBOperation("&",
+                                               new KBOperation(">", reference("Насос", "давление"), reference("Насос", "уставка")),
+                                               new KBOperation("<", reference("Клапан", "давление"), new KBNumericValue(5))),
+                               {}));
+        kb->addRule(new KBRule("ПРАВИЛО2", new KBOperation("==", reference("Клапан", "давление"), new KBNumericValue(0)), {}));
+    }
+};
+
+// Проверяет, что результат совпадает с полным вычислением стековой машиной.
+TEST_F(KBIncrementalEvaluatorTest, MatchesFullEvaluation)
+{
+    KBIncrementalEvaluator evaluator(*kb);
+    evaluator.set("Насос.давление", KBEvalValue::fromNumber(20, CERTAIN));
+    evaluator.set("Насос.уставка", KBEvalValue::fromNumber(10, {80, 90, 0}));
+    evaluator.set("Клапан.давление", KBEvalValue::fromNumber(1, CERTAIN));
+
+    for (uint32_t i = 0; i < kb->getRules().size(); ++i)
+    {
+        KBProgram program = KBProgram::compile(kb->getRules()[i]->getCondition(), evaluator.getLayout());
+        KBVirtualMachine vm;
+        KBEvalValue expected = vm.run(program, evaluator.getMemory());
+        KBEvalValue actual = evaluator.evaluateCondition(i);
+        ASSERT_EQ(actual.kind, expected.kind);
+        EXPECT_EQ(actual.boolean, expected.boolean);
+        EXPECT_DOUBLE_EQ(actual.nonFactor.belief, expected.nonFactor.belief);
+        EXPECT_DOUBLE_EQ(actual.nonFactor.probability, expected.nonFactor.probability);
+    }
+    EXPECT_TRUE(evaluator.evaluateCondition(kb->getRule("ПРАВИЛО1")).boolean);
+    EXPECT_FALSE(evaluator.evaluateCondition(kb->getRule("ПРАВИЛО2")).boolean);
+}
+
+// Проверяет, что после изменения факта пересчитываются только предки его ссылок.
+TEST_F(KBIncrementalEvaluatorTest, RecomputesOnlyDirtyNodes)
+{
+    KBIncrementalEvaluator evaluator(*kb);
+    evaluator.set("Насос.давление", KBEvalValue::fromNumber(20, CERTAIN));
+    evaluator.set("Насос.уставка", KBEvalValue::fromNumber(10, CERTAIN));
+    evaluator.set("Клапан.давление", KBEvalValue::fromNumber(1, CERTAIN));
+    evaluator.evaluateCondition(0u);
+    evaluator.evaluateCondition(1u);
+    // Все узлы, кроме литералов: 6 узлов первого правила и 2 второго
+    EXPECT_EQ(evaluator.getRecomputedCount(), 8);
+
+    // Повторный запрос без изменений берет результат из кэша
+    evaluator.evaluateCondition(0u);
+    EXPECT_EQ(evaluator.getRecomputedCount(), 8);
+
+    // Неизменившееся значение не делает узлы устаревшими
+    EXPECT_FALSE(evaluator.set("Насос.уставка", KBEvalValue::fromNumber(10, CERTAIN)));
+
+    // Ссылка, сравнение и конъюнкция первого правила; второе правило не затронуто
+    EXPECT_TRUE(evaluator.set("Насос.уставка", KBEvalValue::fromNumber(30, CERTAIN)));
+    EXPECT_FALSE(evaluator.evaluateCondition(0u).boolean);
+    evaluator.evaluateCondition(1u);
+    EXPECT_EQ(evaluator.getRecomputedCount(), 11);
+}
+
+// Проверяет обработку неизвестных атрибутов и изменения схемы.
+TEST_F(KBIncrementalEvaluatorTest, Errors)
+{
+    KBIncrementalEvaluator evaluator(*kb);
+    EXPECT_THROW(evaluator.set("Котел.давление", KBEvalValue::fromNumber(1)), invalid_argument);
+    EXPECT_THROW(evaluator.set("Котел", KBEvalValue::fromNumber(1)), invalid_argument);
+    EXPECT_FALSE(evaluator.evaluateCondition(0u).isDefined());
+
+    kb->getObject("Клапан")->addProperty(new KBProperty("режим", "Давление"));
+    EXPECT_THROW(evaluator.evaluateCondition(0u), logic_error);
+}
@@ -0,0 +1,122 @@
+#include <gtest/gtest.h>
+#include "kb_json_reader.h"
+#include "kb_json_writer.h"
+#include <cstdio>
+#include <fstream>
+#include <memory>
+
+using namespace std;
+
+// Проверяет чтение типов всех видов из JSON, записанного KBJSONWriter.
+TEST(KBJSONReaderTest, ReadTypes)
+{
+    MFPoint p1(0, 0), p2(5.5, 1), p3(10, 0);
+    MembershipFunction low("низкий", 0, 10, {&p1, &p2, &p3});
+    vector<KBType *> types = {
+        new KBNumericType("Температура", -10.5, 100, "Температура воздуха"),
+        new KBSymbolicType("Цвет", {"красный", "синий"}),
+        new KBFuzzyType("Уровень", {&low}, "уровень воды"),
+        new KBType("abstract"),
+    };
+    KBJSONWriter writer;
+    writer.startArray();
+    for (KBType *type : types)
+    {
+        writer.write(*type);
+    }
+    writer.endArray();
+
+    KBJSONReader reader(writer.str());
+    size_t index = 0;
+    reader.forEachElement([&](KBJSONReader &r)
+                          {
+        unique_ptr<KBType> type(r.readType());
+        ASSERT_LT(index, types.size());
+        EXPECT_EQ(type->getMeta(), types[index]->getMeta());
+        EXPECT_EQ(type->KRL(), types[index]->KRL());
+        EXPECT_EQ(type->toJSON(), types[index]->toJSON());
+        ++index; });
+    reader.expectEnd();
+    EXPECT_EQ(index, types.size());
+    for (KBType *type : types)
+    {
+        delete type;
+    }
+}
+
+// Проверяет чтение выражения и сохранение коэффициентов уверенности.
+TEST(KBJSONReaderTest, ReadExpression)
+{
+    NonFactor nf(80, 90, 5);
+    KBOperation expr("&&",
+                     new KBOperation(">", new KBReference("obj", new KBReference("attr")), new KBNumericValue(-3.25)),
+                     new KBOperation("!", new KBOperation("==", new KBSymbolicValue("красный", &nf), new KBBooleanValue(false))),
+                     &nf);
+    KBJSONWriter writer;
+    writer.write(expr);
+
+    KBJSONReader reader(writer.str());
+    unique_ptr<Evaluatable> loaded(reader.readEvaluatable());
+    reader.expectEnd();
+    ASSERT_NE(dynamic_cast<KBOperation *>(loaded.get()), nullptr);
+    EXPECT_EQ(loaded->KRL(), expr.KRL());
+    EXPECT_EQ(loaded->toJSON(), expr.toJSON());
+    // Коэффициент значения записан строкой; ее читает и разбор через Json::Value
+    unique_ptr<Evaluatable> parsed(Evaluatable::fromJSON(expr.toJSON()));
+    EXPECT_EQ(parsed->KRL(), expr.KRL());
+}
+
+// Проверяет, что порядок ключей, пробелы, неизвестные поля и escape-последовательности не мешают чтению.
+TEST(KBJSONReaderTest, FlexibleInput)
+{
+    KBJSONReader reader(" { \"extra\" : [1, {\"a\": null}, \"x\"], \"content\" : \"\\u043a\\u0442\\n\\ud83d\\ude00\",\n"
+                        " \"non_factor\": {\"probability\": 60, \"belief\": 40}, \"tag\": \"value\" } ");
+    unique_ptr<KBValue> value(reader.readValue());
+    reader.expectEnd();
+    KBSymbolicValue *symbolic = dynamic_cast<KBSymbolicValue *>(value.get());
+    ASSERT_NE(symbolic, nullptr);
+    EXPECT_EQ(symbolic->getContentAsString(), "кт\n😀");
+    EXPECT_EQ(value->getNonFactor()->getBelief(), 40);
+    EXPECT_EQ(value->getNonFactor()->getProbability(), 60);
+    EXPECT_EQ(value->getNonFactor()->getAccuracy(), 0);
+
+    KBJSONReader ref("{\"ref\": {\"id\": \"b\"}, \"id\": \"a\"}");
+    unique_ptr<KBReference> reference(ref.readReference());
+    EXPECT_EQ(reference->KRL(), "a.b");
+}
+
+// Проверяет сообщения об ошибках для некорректного JSON.
+TEST(KBJSONReaderTest, RejectsInvalidInput)
+{
+    EXPECT_THROW(KBJSONReader("{\"content\": 1").readValue(), runtime_error);
+    EXPECT_THROW(KBJSONReader("{\"content\": \"a}").readValue(), runtime_error);
+    EXPECT_THROW(KBJSONReader("{\"content\": 1x}").readValue(), runtime_error);
+    EXPECT_THROW(KBJSONReader("{\"content\": \"\\ud83d\"}").readValue(), runtime_error);
+    EXPECT_THROW(KBJSONReader("{\"tag\": \"value\"}").readEvaluatable(), runtime_error);
+    EXPECT_THROW(KBJSONReader("{\"id\": \"a\"}").readOperation(), runtime_error);
+    EXPECT_THROW(KBJSONReader("{\"sign\": \"??\", \"left\": {\"id\": \"a\"}}").readOperation(), invalid_argument);
+    EXPECT_THROW(KBJSONReader("{\"meta\": \"unknown\"}").readType(), runtime_error);
+    KBJSONReader trailing("{\"id\": \"a\"} x");
+    delete trailing.readEvaluatable();
+    EXPECT_THROW(trailing.expectEnd(), runtime_error);
+}
+
+// Проверяет чтение из файла через mmap.
+TEST(KBJSONReaderTest, ReadFromFile)
+{
+    string path = "kb_json_reader_test.json";
+    {
+        ofstream file(path);
+        file << "[{\"id\": \"num\", \"meta\": \"number\", \"from\": 0, \"to\": 1e+2}]";
+    }
+    unique_ptr<KBJSONReader> reader(KBJSONReader::fromFile(path));
+    remove(path.c_str());
+    vector<unique_ptr<KBType>> types;
+    reader->forEachElement([&](KBJSONReader &r)
+                           { types.emplace_back(r.readType()); });
+    ASSERT_EQ(types.size(), 1);
+    KBNumericType *numeric = dynamic_cast<KBNumericType *>(types[0].get());
+    ASSERT_NE(numeric, nullptr);
+    EXPECT_EQ(numeric->getTo(), 100);
+    EXPECT_THROW(KBJSONReader::fromFile("missing.json"), runtime_error);
+}
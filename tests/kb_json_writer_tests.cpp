@@ -0,0 +1,146 @@
+#include <gtest/gtest.h>
+#include "kb_json_writer.h"
+#include "kb_type.h"
+#include "kb_operation.h"
+#include "kb_reference.h"
+#include "kb_value.h"
+#include "non_factor.h"
+#include <json/reader.h>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace std;
+
+static Json::Value parse(const string &text)
+{
+    Json::Value result;
+    Json::Reader reader;
+    EXPECT_TRUE(reader.parse(text, result)) << text;
+    return result;
+}
+
+static string dumpWithWriter(const KBEntity &entity)
+{
+    KBJSONWriter writer;
+    writer.write(entity);
+    return writer.str();
+}
+
+// Проверяет запись вложенных объектов, массивов и экранирование строк.
+TEST(KBJSONWriterTest, Structure)
+{
+    KBJSONWriter writer;
+    writer.startObject();
+    writer.member("text", "кавычка \" слэш \\ перевод\nстроки\x01");
+    writer.key("list");
+    writer.startArray();
+    writer.value(1.0);
+    writer.value(0.5);
+    writer.value(true);
+    writer.null();
+    writer.startObject();
+    writer.endObject();
+    writer.endArray();
+    writer.endObject();
+    EXPECT_EQ(writer.str(), "{\"text\":\"кавычка \\\" слэш \\\\ перевод\\nстроки\\u0001\","
+                            "\"list\":[1.0,0.5,true,null,{}]}");
+    EXPECT_EQ(parse(writer.str())["text"].asString(), "кавычка \" слэш \\ перевод\nстроки\x01");
+}
+
+// Проверяет запись особых вещественных чисел.
+TEST(KBJSONWriterTest, Numbers)
+{
+    KBJSONWriter writer;
+    writer.startArray();
+    writer.value(-3.0);
+    writer.value(1e300);
+    writer.value(0.1);
+    writer.value(INFINITY);
+    writer.value(NAN);
+    writer.endArray();
+    EXPECT_EQ(writer.str(), "[-3.0,1e+300,0.1,1e+9999,null]");
+}
+
+// Проверяет, что потоковая запись дает тот же JSON, что и toJSON().
+TEST(KBJSONWriterTest, MatchesToJSON)
+{
+    MFPoint p1(0, 0), p2(5.5, 1), p3(10, 0);
+    MembershipFunction low("низкий", 0, 10, {&p1, &p2, &p3});
+    MembershipFunction empty("пустой", 1, 2, {});
+    NonFactor nf(80, 90, 5);
+    vector<KBEntity *> entities = {
+        new KBNumericType("Температура", -10.5, 100, "Температура воздуха"),
+        new KBSymbolicType("Цвет", {"красный", "синий"}),
+        new KBFuzzyType("Уровень", {&low, &empty}, "уровень воды"),
+        new KBType("abstract"),
+        new NonFactor(nf),
+        new KBOperation("&&",
+                        new KBOperation(">", new KBReference("obj", new KBReference("attr")), new KBNumericValue(-3.25)),
+                        new KBOperation("!", new KBOperation("==", new KBSymbolicValue("красный", &nf), new KBBooleanValue(false))),
+                        &nf),
+        new KBNumericValue(7),
+    };
+    for (KBEntity *entity : entities)
+    {
+        EXPECT_EQ(parse(dumpWithWriter(*entity)), entity->toJSON()) << dumpWithWriter(*entity);
+        delete entity;
+    }
+}
+
+// Проверяет, что коэффициент значения записывается строкой атрибута non_factor, как в XML.
+TEST(KBJSONWriterTest, ValueNonFactor)
+{
+    NonFactor nf(70, 80, 10);
+    KBSymbolicValue value("да", &nf);
+    Json::Value json = parse(dumpWithWriter(value));
+    EXPECT_EQ(json, value.toJSON());
+    EXPECT_EQ(json["non_factor"].asString(), nf.toJSON().toStyledString());
+    KBBooleanValue flag(true);
+    EXPECT_FALSE(parse(dumpWithWriter(flag)).isMember("non_factor"));
+}
+
+// Проверяет форму значения: атрибуты сущности и добавленный к ним ключ content.
+TEST(KBJSONWriterTest, ValueContent)
+{
+    NonFactor nf(70, 80, 10);
+    KBSymbolicValue symbol("да", &nf);
+    Json::Value expected;
+    expected["content"] = "да";
+    expected["non_factor"] = nf.toJSON().toStyledString();
+    expected["tag"] = "value";
+    EXPECT_EQ(parse(dumpWithWriter(symbol)), expected);
+    EXPECT_EQ(symbol.toJSON(), expected);
+    EXPECT_EQ(dumpWithWriter(KBNumericValue(2.5)), "{\"content\":2.5,\"tag\":\"value\"}");
+    EXPECT_EQ(dumpWithWriter(KBBooleanValue(true)), "{\"content\":true,\"tag\":\"value\"}");
+}
+
+// Проверяет запись в файловый дескриптор со сбросом буфера.
+TEST(KBJSONWriterTest, WritesToFile)
+{
+    string path = "kb_json_writer_test.json";
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    ASSERT_GE(fd, 0);
+    KBNumericType type("num", 0, 10);
+    {
+        KBJSONWriter writer(fd, 16);
+        writer.startArray();
+        for (int i = 0; i < 10; ++i)
+        {
+            writer.write(type);
+        }
+        writer.endArray();
+    }
+    ::close(fd);
+
+    ifstream file(path);
+    stringstream content;
+    content << file.rdbuf();
+    remove(path.c_str());
+    Json::Value json = parse(content.str());
+    ASSERT_EQ(json.size(), 10);
+    EXPECT_EQ(json[9], type.toJSON());
+}
@@ -0,0 +1,101 @@
+#include <gtest/gtest.h>
+#include "kb_krl_parser.h"
+#include <memory>
+
+using namespace std;
+
+// Проверяет, что типы всех видов восстанавливаются из собственного KRL без изменений.
+TEST(KBKRLParserTest, TypesRoundTrip)
+{
+    MFPoint p1(0, 0), p2(5.5, 1), p3(10, 0);
+    MembershipFunction low("низкий", 0, 10, {&p1, &p2, &p3});
+    MembershipFunction high("высокий", 5, 20, {&p2, &p3});
+    vector<KBType *> originals = {
+        new KBNumericType("Температура", -10.5, 100, "Температура воздуха"),
+        new KBSymbolicType("Цвет", {"красный", "синий темный"}),
+        new KBFuzzyType("Уровень", {&low, &high}, "уровень воды"),
+        new KBType("abstract"),
+    };
+
+    string krl;
+    for (KBType *type : originals)
+    {
+        type->writeKRL(krl);
+    }
+
+    KBKRLParser parser(krl);
+    vector<KBType *> parsed = parser.parseTypes();
+    ASSERT_EQ(parsed.size(), originals.size());
+    for (size_t i = 0; i < parsed.size(); ++i)
+    {
+        EXPECT_EQ(parsed[i]->KRL(), originals[i]->KRL());
+        EXPECT_EQ(parsed[i]->getMeta(), originals[i]->getMeta());
+        delete parsed[i];
+        delete originals[i];
+    }
+}
+
+// Проверяет разбор отдельного типа через KBType::fromKRL.
+TEST(KBKRLParserTest, NumericTypeFromKRL)
+{
+    unique_ptr<KBType> type(KBType::fromKRL("ТИП t1\nЧИСЛО\nОТ -1.5\nДО 1e3\nКОММЕНТАРИЙ  какой-то тип \n"));
+    KBNumericType *numeric = dynamic_cast<KBNumericType *>(type.get());
+    ASSERT_NE(numeric, nullptr);
+    EXPECT_EQ(numeric->getId(), "t1");
+    EXPECT_DOUBLE_EQ(numeric->getFrom(), -1.5);
+    EXPECT_DOUBLE_EQ(numeric->getTo(), 1000);
+    EXPECT_STREQ(numeric->getDesc(), "какой-то тип");
+}
+
+// Проверяет, что выражения с коэффициентами уверенности восстанавливаются из своего KRL.
+TEST(KBKRLParserTest, ExpressionsRoundTrip)
+{
+    NonFactor nf(80, 90, 5);
+    KBOperation expr("&&",
+                     new KBOperation(">", new KBReference("obj", new KBReference("attr")), new KBNumericValue(-3.25)),
+                     new KBOperation("!", new KBOperation("==", new KBSymbolicValue("a b", &nf), new KBBooleanValue(false))),
+                     &nf);
+    KBOperation neg("-", new KBOperation("^", new KBReference("x"), new KBNumericValue(2)));
+
+    for (const Evaluatable *original : {(const Evaluatable *)&expr, (const Evaluatable *)&neg})
+    {
+        unique_ptr<Evaluatable> parsed(Evaluatable::fromKRL(original->KRL()));
+        EXPECT_EQ(parsed->KRL(), original->KRL());
+    }
+
+    unique_ptr<Evaluatable> parsed(Evaluatable::fromKRL(expr.KRL()));
+    EXPECT_EQ(parsed->getNonFactorValue().belief, 80);
+    const KBOperation *gt = dynamic_cast<const KBOperation *>(dynamic_cast<KBOperation *>(parsed.get())->getLeft());
+    ASSERT_NE(gt, nullptr);
+    EXPECT_EQ(gt->getOperator(), KBOperator::GT);
+    EXPECT_EQ(dynamic_cast<const KBNumericValue *>(gt->getRight())->getContent(), -3.25);
+}
+
+// Проверяет приоритеты и ассоциативность операций без скобок.
+TEST(KBKRLParserTest, Precedence)
+{
+    unique_ptr<Evaluatable> expr(Evaluatable::fromKRL("a.b + 2 * c > 3 or not (d) and e ^ 2 ^ 3 == 1"));
+    EXPECT_EQ(expr->KRL(), "(((a.b) + ((2) * (c))) > (3)) || ((! (d)) && (((e) ^ ((2) ^ (3))) == (1)))");
+
+    unique_ptr<Evaluatable> sub(Evaluatable::fromKRL("10 - 4 - 3"));
+    EXPECT_EQ(sub->KRL(), "((10) - (4)) - (3)");
+}
+
+// Проверяет сообщения об ошибках с позицией в тексте.
+TEST(KBKRLParserTest, SyntaxErrors)
+{
+    try
+    {
+        delete Evaluatable::fromKRL("(a +\n  )");
+        FAIL() << "Expected KRLSyntaxError";
+    }
+    catch (const KRLSyntaxError &e)
+    {
+        EXPECT_EQ(e.getLine(), 2);
+        EXPECT_EQ(e.getColumn(), 3);
+    }
+    EXPECT_THROW(delete Evaluatable::fromKRL("\"unterminated"), KRLSyntaxError);
+    EXPECT_THROW(delete Evaluatable::fromKRL("(a) (b)"), KRLSyntaxError);
+    EXPECT_THROW(delete KBType::fromKRL("ТИП t\nСТРОКА\n"), KRLSyntaxError);
+    EXPECT_THROW(delete KBType::fromKRL("ТИП t\nНЕЧЕТКИЙ\n1\n\"a\" 0 1 2 ={0|0; 1}"), KRLSyntaxError);
+}
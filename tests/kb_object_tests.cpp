@@ -0,0 +1,52 @@
+#include <gtest/gtest.h>
+#include "kb_object.h"
+#include "utils.h"
+#include <memory>
+
+using namespace std;
+
+static KBObject *makeObject()
+{
+    return new KBObject("Насос", {new KBProperty("давление", "Давление", "давление на выходе"), new KBProperty("режим", "Режим")}, "Оборудование");
+}
+
+// Проверяет поиск атрибутов по имени и запрет повторных имен.
+TEST(KBObjectTest, Properties)
+{
+    unique_ptr<KBObject> object(makeObject());
+    ASSERT_EQ(object->getProperties().size(), 2);
+    EXPECT_EQ(object->getPropertyIndex("режим"), 1);
+    EXPECT_EQ(object->getProperty("давление")->getType(), "Давление");
+    EXPECT_EQ(object->getProperty("давление")->owner, object.get());
+    EXPECT_EQ(object->getProperty("нет"), nullptr);
+    EXPECT_THROW(object->addProperty(new KBProperty("режим", "Другой")), invalid_argument);
+}
+
+// Проверяет представление объекта на KRL.
+TEST(KBObjectTest, KRL)
+{
+    unique_ptr<KBObject> object(makeObject());
+    EXPECT_EQ(object->KRL(),
+              "ОБЪЕКТ Насос\n"
+              "ГРУППА Оборудование\n"
+              "АТРИБУТЫ\n"
+              "АТРИБУТ давление\nТИП Давление\nКОММЕНТАРИЙ давление на выходе\n"
+              "АТРИБУТ режим\nТИП Режим\nКОММЕНТАРИЙ режим\n"
+              "КОММЕНТАРИЙ Насос\n");
+}
+
+// Проверяет восстановление объекта из XML и JSON.
+TEST(KBObjectTest, RoundTrip)
+{
+    unique_ptr<KBObject> object(makeObject());
+    xmlNodePtr xml = object->toXML();
+    unique_ptr<KBObject> fromXML(KBObject::fromXML(xml));
+    xmlFreeNode(xml);
+    EXPECT_EQ(fromXML->KRL(), object->KRL());
+
+    Json::Value json = object->toJSON();
+    EXPECT_EQ(json["properties"][0]["type"].asString(), "Давление");
+    unique_ptr<KBObject> fromJSON(KBObject::fromJSON(json));
+    EXPECT_EQ(fromJSON->KRL(), object->KRL());
+    EXPECT_EQ(fromJSON->toJSON(), json);
+}
@@ -192,4 +192,71 @@ TEST_F(KBOperationTest, TestKBOperationKRL)
     string krl2 = op2.KRL();
 
     EXPECT_EQ(krl2, "! (left) " + expectedNonFactorKRL);
-}
\ No newline at end of file
+}
+
+// Проверяет точное сопоставление знаков операций с учетом арности.
+TEST(KBOperatorTest, ExactSignMatching)
+{
+    KBOperator op;
+    EXPECT_TRUE(parseOperatorSign("-", false, op));
+    EXPECT_EQ(op, KBOperator::NEG);
+    EXPECT_TRUE(parseOperatorSign("-", true, op));
+    EXPECT_EQ(op, KBOperator::SUB);
+    EXPECT_TRUE(parseOperatorSign("=", true, op));
+    EXPECT_EQ(op, KBOperator::EQ);
+    EXPECT_TRUE(parseOperatorSign("<", true, op));
+    EXPECT_EQ(op, KBOperator::LT);
+    EXPECT_TRUE(parseOperatorSign(">", true, op));
+    EXPECT_EQ(op, KBOperator::GT);
+    EXPECT_TRUE(parseOperatorSign("<>", true, op));
+    EXPECT_EQ(op, KBOperator::NE);
+    EXPECT_TRUE(parseOperatorSign("**", true, op));
+    EXPECT_EQ(op, KBOperator::POW);
+    EXPECT_FALSE(parseOperatorSign("===", true, op));
+    EXPECT_FALSE(parseOperatorSign("q", true, op));
+    EXPECT_FALSE(parseOperatorSign("+", false, op));
+}
+
+// Проверяет, что KBOperation хранит операцию и отдает ее свойства из таблицы.
+TEST(KBOperatorTest, OperationUsesDescriptorTable)
+{
+    KBOperation lt("<", new KBReference("a"), new KBNumericValue(1.0));
+    EXPECT_EQ(lt.getOperator(), KBOperator::LT);
+    EXPECT_EQ(lt.getOp(), "lt");
+    EXPECT_EQ(lt.getTag(), "lt");
+    EXPECT_EQ(lt.getSign(), "<");
+    EXPECT_EQ(lt.getMeta(), "eq");
+    EXPECT_TRUE(lt.isBinary());
+
+    KBOperation neg("-", new KBReference("a"));
+    EXPECT_EQ(neg.getOperator(), KBOperator::NEG);
+    EXPECT_FALSE(neg.isBinary());
+    EXPECT_EQ(neg.KRL(), "- (a)");
+
+    lt.setOp("ge");
+    EXPECT_EQ(lt.getSign(), ">=");
+    EXPECT_EQ(lt.getTag(), "ge");
+    EXPECT_THROW(lt.setOp(">="), invalid_argument);
+    EXPECT_THROW(KBOperation("<=>", new KBReference("a"), new KBReference("b")), invalid_argument);
+}
+
+// Проверяет, что KRL глубокого дерева дописывается в общий буфер без изменения формата.
+TEST(KBOperatorTest, WriteKRLAppendsToBuffer)
+{
+    NonFactor nf(70, 80, 1.5);
+    Evaluatable *expr = new KBReference("x");
+    string expected = "x";
+    for (int i = 0; i < 200; ++i)
+    {
+        expr = new KBOperation("+", expr, new KBNumericValue(i));
+        expected = "(" + expected + ") + (" + to_string(i) + ")";
+    }
+    KBOperation root("!", expr, nullptr, &nf);
+    expected = "! (" + expected + ") УВЕРЕННОСТЬ [70; 80] ТОЧНОСТЬ 1.5";
+
+    string out = "ПРАВИЛО ";
+    root.writeKRL(out);
+    EXPECT_EQ(out, "ПРАВИЛО " + expected);
+    EXPECT_EQ(root.KRL(), expected);
+    EXPECT_EQ(root.getInnerKRL() + " " + nf.KRL(), expected);
+}
@@ -0,0 +1,64 @@
+#include <gtest/gtest.h>
+#include "kb_parallel.h"
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+// Проверяет, что каждый элемент обрабатывается ровно один раз при неравной стоимости элементов.
+TEST(KBParallelTest, CoversRangeOnce)
+{
+    const size_t count = 10007;
+    vector<atomic<int>> visits(count);
+    atomic<size_t> maxWorker{0};
+    kbParallelFor(count, 8, 16, [&](size_t worker, size_t begin, size_t end)
+                  {
+        size_t seen = maxWorker.load();
+        while (worker > seen && !maxWorker.compare_exchange_weak(seen, worker))
+        {
+        }
+        for (size_t i = begin; i < end; ++i)
+        {
+            // Первые элементы заметно дороже остальных
+            if (i < 64)
+            {
+                this_thread::sleep_for(chrono::microseconds(200));
+            }
+            visits[i].fetch_add(1);
+        } });
+    for (size_t i = 0; i < count; ++i)
+    {
+        ASSERT_EQ(visits[i].load(), 1) << i;
+    }
+    EXPECT_LT(maxWorker.load(), 8);
+}
+
+// Проверяет последовательный режим и пустой диапазон.
+TEST(KBParallelTest, SingleThread)
+{
+    vector<size_t> order;
+    kbParallelFor(10, 1, 3, [&](size_t worker, size_t begin, size_t end)
+                  {
+        EXPECT_EQ(worker, 0);
+        for (size_t i = begin; i < end; ++i)
+        {
+            order.push_back(i);
+        } });
+    EXPECT_EQ(order, vector<size_t>({0, 1, 2, 3, 4, 5, 6, 7, 8, 9}));
+    kbParallelFor(0, 4, 1, [](size_t, size_t, size_t)
+                  { FAIL(); });
+}
+
+// Проверяет, что исключение из обработчика пробрасывается вызывающему.
+TEST(KBParallelTest, PropagatesException)
+{
+    EXPECT_THROW(kbParallelFor(1000, 4, 1, [](size_t, size_t begin, size_t)
+                               {
+        if (begin == 500)
+        {
+            throw runtime_error("failure");
+        } }),
+                 runtime_error);
+}
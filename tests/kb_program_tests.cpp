@@ -0,0 +1,111 @@
+#include <gtest/gtest.h>
+#include "kb_program.h"
+#include "kb_operation.h"
+#include "kb_reference.h"
+#include "non_factor.h"
+#include <map>
+
+using namespace std;
+
+// Проверяет, что арифметическое выражение компилируется в постфиксную последовательность инструкций.
+TEST(KBProgramTest, CompileArithmetic)
+{
+    KBOperation op("add", new KBReference("a"), new KBOperation("mul", new KBNumericValue(2.0), new KBReference("b")));
+    KBProgram program = KBProgram::compile(&op);
+
+    const vector<KBInstruction> &code = program.getCode();
+    ASSERT_EQ(code.size(), 5);
+    EXPECT_EQ(code[0].code, KBOpCode::LOAD_REF);
+    EXPECT_EQ(code[1].code, KBOpCode::PUSH_CONST);
+    EXPECT_EQ(code[2].code, KBOpCode::LOAD_REF);
+    EXPECT_EQ(code[3].code, KBOpCode::MUL);
+    EXPECT_EQ(code[4].code, KBOpCode::ADD);
+    EXPECT_EQ(program.getReferences(), vector<string>({"a", "b"}));
+    EXPECT_EQ(program.getMaxStack(), 3);
+
+    KBVirtualMachine vm;
+    vector<KBEvalValue> slots = {KBEvalValue::fromNumber(1.0), KBEvalValue::fromNumber(4.0)};
+    KBEvalValue result = vm.run(program, slots);
+    ASSERT_EQ(result.kind, KBEvalValue::NUMBER);
+    EXPECT_EQ(result.number, 9.0);
+}
+
+// Проверяет вычисление сравнений по фактам, связанным по пути ссылки.
+TEST(KBProgramTest, RunComparisonWithFacts)
+{
+    KBOperation op("and",
+                   new KBOperation("gt", new KBReference("obj", new KBReference("x")), new KBNumericValue(10.0)),
+                   new KBOperation("eq", new KBReference("obj", new KBReference("color")), new KBSymbolicValue("red")));
+    KBProgram program = KBProgram::compile(&op);
+    EXPECT_EQ(program.getReferences(), vector<string>({"obj.x", "obj.color"}));
+
+    map<string, KBEvalValue> facts = {
+        {"obj.x", KBEvalValue::fromNumber(12.0)},
+        {"obj.color", program.symbol("red")},
+    };
+    KBVirtualMachine vm;
+    KBEvalValue result = vm.run(program, program.bind(facts));
+    ASSERT_EQ(result.kind, KBEvalValue::BOOLEAN);
+    EXPECT_TRUE(result.boolean);
+
+    facts["obj.color"] = program.symbol("blue");
+    result = vm.run(program, program.bind(facts));
+    ASSERT_EQ(result.kind, KBEvalValue::BOOLEAN);
+    EXPECT_FALSE(result.boolean);
+}
+
+// Проверяет трехзначную логику для неопределенных фактов.
+TEST(KBProgramTest, UndefinedFacts)
+{
+    KBOperation op("or", new KBOperation("gt", new KBReference("x"), new KBNumericValue(0.0)), new KBBooleanValue(true));
+    KBProgram program = KBProgram::compile(&op);
+    KBVirtualMachine vm;
+
+    KBEvalValue result = vm.run(program, program.bind({}));
+    ASSERT_EQ(result.kind, KBEvalValue::BOOLEAN);
+    EXPECT_TRUE(result.boolean);
+
+    KBOperation div("div", new KBNumericValue(1.0), new KBReference("x"));
+    KBProgram divProgram = KBProgram::compile(&div);
+    EXPECT_FALSE(vm.run(divProgram, {KBEvalValue::fromNumber(0.0)}).isDefined());
+}
+
+// Проверяет все операции из TAGS_SIGNS на числовых операндах.
+TEST(KBProgramTest, AllOperations)
+{
+    KBEvalValue a = KBEvalValue::fromNumber(7.0), b = KBEvalValue::fromNumber(2.0);
+    EXPECT_EQ(evalBinary(KBOpCode::ADD, a, b).number, 9.0);
+    EXPECT_EQ(evalBinary(KBOpCode::SUB, a, b).number, 5.0);
+    EXPECT_EQ(evalBinary(KBOpCode::MUL, a, b).number, 14.0);
+    EXPECT_EQ(evalBinary(KBOpCode::DIV, a, b).number, 3.5);
+    EXPECT_EQ(evalBinary(KBOpCode::MOD, a, b).number, 1.0);
+    EXPECT_EQ(evalBinary(KBOpCode::POW, a, b).number, 49.0);
+    EXPECT_EQ(evalUnary(KBOpCode::NEG, a).number, -7.0);
+    EXPECT_FALSE(evalBinary(KBOpCode::EQ, a, b).boolean);
+    EXPECT_TRUE(evalBinary(KBOpCode::NE, a, b).boolean);
+    EXPECT_TRUE(evalBinary(KBOpCode::GT, a, b).boolean);
+    EXPECT_TRUE(evalBinary(KBOpCode::GE, a, a).boolean);
+    EXPECT_FALSE(evalBinary(KBOpCode::LT, a, b).boolean);
+    EXPECT_TRUE(evalBinary(KBOpCode::LE, b, a).boolean);
+    EXPECT_TRUE(evalBinary(KBOpCode::AND, a, b).boolean);
+    EXPECT_TRUE(evalBinary(KBOpCode::OR, a, KBEvalValue::fromBoolean(false)).boolean);
+    EXPECT_FALSE(evalBinary(KBOpCode::XOR, a, b).boolean);
+    EXPECT_FALSE(evalUnary(KBOpCode::NOT, a).boolean);
+}
+
+// Проверяет распространение коэффициентов уверенности через операции.
+TEST(KBProgramTest, NonFactorPropagation)
+{
+    NonFactor *nonFactor = new NonFactor(80.0, 90.0, 1.0);
+    KBOperation op("eq", new KBReference("x", nullptr, nonFactor), new KBNumericValue(1.0), new NonFactor(70.0, 100.0, 0.0));
+    delete nonFactor;
+    KBProgram program = KBProgram::compile(&op);
+    ASSERT_EQ(program.getNonFactors().size(), 2);
+
+    KBVirtualMachine vm;
+    KBEvalValue result = vm.run(program, {KBEvalValue::fromNumber(1.0, {90.0, 95.0, 0.5})});
+    EXPECT_TRUE(result.boolean);
+    EXPECT_EQ(result.nonFactor.belief, 70.0);
+    EXPECT_EQ(result.nonFactor.probability, 90.0);
+    EXPECT_EQ(result.nonFactor.accuracy, 1.0);
+}
@@ -0,0 +1,112 @@
+#include <gtest/gtest.h>
+#include "kb_rete.h"
+#include "kb_operation.h"
+#include "kb_test_helpers.h"
+#include <memory>
+
+using namespace std;
+
+static const KBNonFactorValue CERTAIN = {100, 100, 0};
+
+class KBReteEngineTest : public ::testing::Test
+{
+protected:
+    unique_ptr<KnowledgeBase> kb;
+
+    void SetUp() override
+    {
+        kb.reset(new KnowledgeBase());
+        kb->addType(new KBNumericType("Давление", 0, 100));
+        kb->addType(new KBSymbolicType("Режим", {"норма", "авария"}));
+        kb->addObject(new KBObject("Насос", {new KBProperty("давление", "Давление"), new KBProperty("режим", "Режим")}));
+        kb->addObject(new KBObject("Клапан", {new KBProperty("давление", "Давление")}));
+        kb->addRule(new KBRule("ПРАВИЛО1",
+                               new KBOperation(">", reference("Насос", "давление"), new KBNumericValue(10)),
+                               {new KBAssign(reference("Насос", "режим"), new KBSymbolicValue("авария"))},
+                               {new KBAssign(reference("Насос", "режим"), new KBSymbolicValue("норма"))}));
+        kb->addRule(new KBRule("ПРАВИЛО2",
+                               new KBOperation("&",
+                                               new KBOperation("==", reference("Насос", "режим"), new KBSymbolicValue("авария")),
+                                               new KBOperation(">", reference("Клапан", "давление"), new KBNumericValue(10))),
+                               {new KBAssign(reference("Клапан", "давление"), new KBNumericValue(0))}));
+        kb->addRule(new KBRule("ПРАВИЛО3",
+                               new KBOperation("|",
+                                               new KBOperation(">", reference("Насос", "давление"), new KBNumericValue(10)),
+                                               new KBOperation("<", reference("Клапан", "давление"), new KBNumericValue(0))),
+                               {}));
+    }
+};
+
+// Проверяет, что одинаковые подвыражения разных правил компилируются в общий узел.
+TEST_F(KBReteEngineTest, SharedNodes)
+{
+    KBReteEngine engine(*kb);
+    // Насос.давление > 10 - общий альфа-узел первого и третьего правил
+    EXPECT_EQ(engine.getAlphaCount(), 4);
+    EXPECT_EQ(engine.getBetaCount(), 2);
+    EXPECT_EQ(engine.getNodeCount(), 6);
+    EXPECT_EQ(engine.getAgendaSize(), 0);
+}
+
+// Проверяет цепочку срабатываний: вывод одного правила активирует следующее.
+TEST_F(KBReteEngineTest, ForwardChaining)
+{
+    KBReteEngine engine(*kb);
+    engine.set("Насос.давление", KBEvalValue::fromNumber(20, CERTAIN));
+    engine.set("Клапан.давление", KBEvalValue::fromNumber(50, CERTAIN));
+    EXPECT_EQ(engine.getAgendaSize(), 2);
+
+    EXPECT_EQ(engine.run(), 3);
+    EXPECT_EQ(engine.getFired(), vector<uint32_t>({0, 1, 2}));
+    EXPECT_EQ(engine.get("Насос.режим").symbol, KBProgram::internSymbol("авария"));
+    EXPECT_EQ(engine.get("Клапан.давление").number, 0);
+    EXPECT_EQ(engine.getAgendaSize(), 0);
+
+    // Переход условия в ложь выполняет ветку ИНАЧЕ
+    engine.set("Насос.давление", KBEvalValue::fromNumber(5, CERTAIN));
+    EXPECT_EQ(engine.run(), 1);
+    EXPECT_EQ(engine.get("Насос.режим").symbol, KBProgram::internSymbol("норма"));
+
+    // Повторная запись того же значения не меняет сеть
+    EXPECT_FALSE(engine.set("Насос.давление", KBEvalValue::fromNumber(5, CERTAIN)));
+    EXPECT_EQ(engine.run(), 0);
+}
+
+// Проверяет, что изменение факта вычисляет только узлы, зависящие от него.
+TEST_F(KBReteEngineTest, CostScalesWithChanges)
+{
+    kb.reset(new KnowledgeBase());
+    kb->addType(new KBNumericType("Число", 0, 1000));
+    const int count = 200;
+    for (int i = 0; i < count; ++i)
+    {
+        string object = "Датчик" + to_string(i);
+        kb->addObject(new KBObject(object, {new KBProperty("значение", "Число"), new KBProperty("тревога", "Число")}));
+        kb->addRule(new KBRule("ПРАВИЛО" + to_string(i),
+                               new KBOperation("&",
+                                               new KBOperation(">", reference(object, "значение"), new KBNumericValue(100)),
+                                               new KBOperation("<", reference(object, "тревога"), new KBNumericValue(1))),
+                               {new KBAssign(reference(object, "тревога"), new KBNumericValue(1))}));
+    }
+    KBReteEngine engine(*kb);
+    ASSERT_EQ(engine.getNodeCount(), count * 3);
+
+    size_t before = engine.getEvaluatedCount();
+    engine.set("Датчик7.тревога", KBEvalValue::fromNumber(0, CERTAIN));
+    engine.set("Датчик7.значение", KBEvalValue::fromNumber(500, CERTAIN));
+    EXPECT_EQ(engine.run(), 1);
+    EXPECT_EQ(engine.getFired(), vector<uint32_t>({7}));
+    EXPECT_LE(engine.getEvaluatedCount() - before, 8);
+}
+
+// Проверяет обработку неизвестных атрибутов и изменения базы.
+TEST_F(KBReteEngineTest, Errors)
+{
+    KBReteEngine engine(*kb);
+    EXPECT_THROW(engine.set("Котел.давление", KBEvalValue::fromNumber(1)), invalid_argument);
+    EXPECT_THROW(engine.get("Насос"), invalid_argument);
+
+    kb->addRule(new KBRule("ПРАВИЛО4", new KBOperation(">", reference("Котел", "давление"), new KBNumericValue(1)), {}));
+    EXPECT_THROW(engine.run(), logic_error);
+    EXPECT_THROW(KBReteEngine rebuilt(*kb), invalid_argument);
+}
@@ -0,0 +1,55 @@
+#include <gtest/gtest.h>
+#include "kb_rule.h"
+#include "kb_operation.h"
+#include <memory>
+
+using namespace std;
+
+static KBRule *makeRule()
+{
+    NonFactor nf(80, 100, 0);
+    return new KBRule("ПРАВИЛО1",
+                      new KBOperation(">", new KBReference("Насос", new KBReference("давление")), new KBNumericValue(10)),
+                      {new KBAssign(new KBReference("Насос", new KBReference("режим")), new KBSymbolicValue("авария", &nf))},
+                      {new KBAssign(new KBReference("Насос", new KBReference("режим")), new KBSymbolicValue("норма"))});
+}
+
+// Проверяет представление правила на KRL.
+TEST(KBRuleTest, KRL)
+{
+    unique_ptr<KBRule> rule(makeRule());
+    EXPECT_EQ(rule->KRL(),
+              "ПРАВИЛО ПРАВИЛО1\n"
+              "ЕСЛИ\n"
+              "    (Насос.давление) > (10)\n"
+              "ТО\n"
+              "    Насос.режим = \"авария\" УВЕРЕННОСТЬ [80; 100] ТОЧНОСТЬ 0\n"
+              "ИНАЧЕ\n"
+              "    Насос.режим = \"норма\"\n"
+              "КОММЕНТАРИЙ ПРАВИЛО1\n");
+    EXPECT_EQ(rule->getCondition()->owner, rule.get());
+    EXPECT_EQ(rule->getInstructions()[0]->owner, rule.get());
+}
+
+// Проверяет восстановление правила из XML и JSON.
+TEST(KBRuleTest, RoundTrip)
+{
+    unique_ptr<KBRule> rule(makeRule());
+    xmlNodePtr xml = rule->toXML();
+    unique_ptr<KBRule> fromXML(KBRule::fromXML(xml));
+    xmlFreeNode(xml);
+    EXPECT_EQ(fromXML->KRL(), rule->KRL());
+
+    unique_ptr<KBRule> fromJSON(KBRule::fromJSON(rule->toJSON()));
+    EXPECT_EQ(fromJSON->KRL(), rule->KRL());
+    EXPECT_EQ(fromJSON->toJSON(), rule->toJSON());
+}
+
+// Проверяет, что присваивание без значения отвергается.
+TEST(KBRuleTest, InvalidAssign)
+{
+    EXPECT_THROW(KBAssign(new KBReference("a"), nullptr), invalid_argument);
+    Json::Value json;
+    json["ref"]["id"] = "a";
+    EXPECT_THROW(delete KBAssign::fromJSON(json), runtime_error);
+}
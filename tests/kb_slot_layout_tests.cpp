@@ -0,0 +1,132 @@
+#include <gtest/gtest.h>
+#include "knowledge_base.h"
+#include "kb_operation.h"
+#include "kb_test_helpers.h"
+#include <memory>
+
+using namespace std;
+
+class KBSlotLayoutTest : public ::testing::Test
+{
+protected:
+    unique_ptr<KnowledgeBase> kb;
+
+    void SetUp() override
+    {
+        kb.reset(new KnowledgeBase());
+        kb->addType(new KBNumericType("Давление", 0, 100));
+        kb->addType(new KBSymbolicType("Режим", {"норма", "авария"}));
+        kb->addObject(new KBObject("Насос", {new KBProperty("давление", "Давление"), new KBProperty("режим", "Режим")}));
+        kb->addObject(new KBObject("Клапан", {new KBProperty("давление", "Давление")}));
+        kb->addRule(new KBRule("ПРАВИЛО1",
+                               new KBOperation(">", reference("Клапан", "давление"), new KBNumericValue(10)),
+                               {new KBAssign(reference("Насос", "режим"), new KBSymbolicValue("авария"))}));
+    }
+};
+
+// Проверяет, что атрибуты объекта занимают подряд идущие слоты в порядке объявления.
+TEST_F(KBSlotLayoutTest, FixedLayout)
+{
+    KBSlotLayout layout(*kb);
+    EXPECT_TRUE(layout.isCurrent());
+    ASSERT_EQ(layout.getSlotCount(), 3);
+    EXPECT_EQ(layout.slot("Насос", "давление"), 0);
+    EXPECT_EQ(layout.slot("Насос", "режим"), 1);
+    EXPECT_EQ(layout.slot("Клапан", "давление"), 2);
+    EXPECT_EQ(layout.getSlotPath(2), "Клапан.давление");
+    EXPECT_EQ(layout.slot("Насос", "температура"), KBSlotLayout::NONE);
+    EXPECT_EQ(layout.slot("Котел", "давление"), KBSlotLayout::NONE);
+
+    unique_ptr<KBReference> ref(reference("Клапан", "давление"));
+    EXPECT_EQ(layout.resolve(ref.get()), 2);
+    unique_ptr<KBReference> bare(new KBReference("Насос"));
+    EXPECT_EQ(layout.resolve(bare.get()), KBSlotLayout::NONE);
+}
+
+// Проверяет, что изменение схемы делает раскладку устаревшей.
+TEST_F(KBSlotLayoutTest, InvalidatedBySchemaChange)
+{
+    KBSlotLayout layout(*kb);
+    kb->getObject("Насос")->addProperty(new KBProperty("температура", "Давление"));
+    EXPECT_FALSE(layout.isCurrent());
+    EXPECT_THROW(layout.slot("Насос", "давление"), logic_error);
+
+    layout.rebuild(*kb);
+    EXPECT_EQ(layout.slot("Насос", "температура"), 2);
+    EXPECT_EQ(layout.slot("Клапан", "давление"), 3);
+}
+
+// Проверяет привязку ссылок правил и ее перестроение только при изменении схемы.
+TEST_F(KBSlotLayoutTest, BindRuleReferences)
+{
+    const KBRule *rule = kb->getRule("ПРАВИЛО1");
+    const KBOperation *op = dynamic_cast<const KBOperation *>(rule->getCondition());
+    const KBReference *condition = dynamic_cast<const KBReference *>(op->getLeft());
+    ASSERT_NE(condition, nullptr);
+    EXPECT_EQ(condition->getSlot(kb.get(), kb->getSchemaVersion()), KBReference::NO_SLOT);
+
+    const KBSlotLayout &layout = kb->bindReferences();
+    uint64_t version = layout.getSchemaVersion();
+    EXPECT_EQ(condition->getSlot(kb.get(), version), 2);
+    EXPECT_EQ(rule->getInstructions()[0]->getRef()->getSlot(kb.get(), version), 1);
+
+    kb->addRule(new KBRule("ПРАВИЛО2", new KBOperation("==", reference("Насос", "режим"), new KBSymbolicValue("норма")), {}));
+    kb->bindReferences();
+    EXPECT_EQ(layout.getSchemaVersion(), version);
+    const KBOperation *second = dynamic_cast<const KBOperation *>(kb->getRule("ПРАВИЛО2")->getCondition());
+    EXPECT_EQ(dynamic_cast<const KBReference *>(second->getLeft())->getSlot(kb.get(), version), 1);
+
+    kb->getObject("Насос")->addProperty(new KBProperty("температура", "Давление"));
+    EXPECT_EQ(condition->getSlot(kb.get(), kb->getSchemaVersion()), KBReference::NO_SLOT);
+    kb->bindReferences();
+    EXPECT_NE(layout.getSchemaVersion(), version);
+    EXPECT_EQ(condition->getSlot(kb.get(), layout.getSchemaVersion()), 3);
+}
+
+// Проверяет, что слот, привязанный до изменения схемы, не используется новой раскладкой.
+TEST_F(KBSlotLayoutTest, StaleBindingAfterSchemaChange)
+{
+    kb->bindReferences();
+    const Evaluatable *condition = kb->getRule("ПРАВИЛО1")->getCondition();
+    kb->getObject("Насос")->addProperty(new KBProperty("температура", "Давление"));
+
+    KBSlotLayout layout(*kb);
+    KBProgram program = KBProgram::compile(condition, layout);
+    ASSERT_EQ(program.getCode()[0].code, KBOpCode::LOAD_REF);
+    EXPECT_EQ(program.getCode()[0].arg, layout.slot("Клапан", "давление"));
+    EXPECT_EQ(program.getCode()[0].arg, 3);
+
+    vector<KBEvalValue> memory = layout.bind({{"Насос.температура", KBEvalValue::fromNumber(50)},
+                                              {"Клапан.давление", KBEvalValue::fromNumber(5)}});
+    KBVirtualMachine vm;
+    EXPECT_FALSE(vm.run(program, memory).boolean);
+
+    // Устаревшая раскладка не отдает слоты, в том числе привязанные
+    kb->bindReferences();
+    kb->getObject("Клапан")->addProperty(new KBProperty("температура", "Давление"));
+    const KBReference *ref = dynamic_cast<const KBReference *>(dynamic_cast<const KBOperation *>(condition)->getLeft());
+    EXPECT_THROW(layout.resolve(ref), logic_error);
+}
+
+// Проверяет выполнение программы, скомпилированной по раскладке, над рабочей памятью.
+TEST_F(KBSlotLayoutTest, CompileAgainstLayout)
+{
+    const KBSlotLayout &layout = kb->bindReferences();
+    KBProgram program = KBProgram::compile(kb->getRule("ПРАВИЛО1")->getCondition(), layout);
+    EXPECT_EQ(program.getLayout(), &layout);
+    EXPECT_EQ(program.getSlotCount(), 3);
+    ASSERT_EQ(program.getCode()[0].code, KBOpCode::LOAD_REF);
+    EXPECT_EQ(program.getCode()[0].arg, 2);
+    EXPECT_EQ(program.getReferences(), vector<string>({"Клапан.давление"}));
+
+    vector<KBEvalValue> memory = layout.bind({{"Клапан.давление", KBEvalValue::fromNumber(25, {100, 100, 0})}});
+    ASSERT_EQ(memory.size(), 3);
+    EXPECT_FALSE(memory[0].isDefined());
+    KBVirtualMachine vm;
+    KBEvalValue result = vm.run(program, memory);
+    ASSERT_EQ(result.kind, KBEvalValue::BOOLEAN);
+    EXPECT_TRUE(result.boolean);
+
+    unique_ptr<KBOperation> unknown(new KBOperation(">", reference("Котел", "давление"), new KBNumericValue(10)));
+    EXPECT_THROW(KBProgram::compile(unknown.get(), layout), invalid_argument);
+}
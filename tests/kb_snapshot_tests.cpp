@@ -0,0 +1,128 @@
+#include <gtest/gtest.h>
+#include "kb_snapshot.h"
+#include <cstdio>
+#include <memory>
+#include <thread>
+
+using namespace std;
+
+// Проверяет, что типы и выражения восстанавливаются из снимка в прежнем виде.
+TEST(KBSnapshotTest, RoundTrip)
+{
+    MFPoint p1(0, 0), p2(5.5, 1), p3(10, 0);
+    MembershipFunction low("низкий", 0, 10, {&p1, &p2, &p3});
+    MembershipFunction high("высокий", 5, 20, {&p2, &p3});
+    vector<KBType *> types = {
+        new KBNumericType("Температура", -10.5, 100, "Температура воздуха"),
+        new KBSymbolicType("Цвет", {"красный", "синий"}),
+        new KBFuzzyType("Уровень", {&low, &high}, "уровень воды"),
+        new KBType("abstract"),
+    };
+    NonFactor nf(80, 90, 5);
+    KBOperation expr("&&",
+                     new KBOperation(">", new KBReference("obj", new KBReference("attr")), new KBNumericValue(-3.25)),
+                     new KBOperation("!", new KBOperation("==", new KBSymbolicValue("красный", &nf), new KBBooleanValue(false))),
+                     &nf);
+
+    KBSnapshotWriter writer;
+    for (KBType *type : types)
+    {
+        writer.addType(type);
+    }
+    writer.addExpression(&expr);
+
+    KBSnapshot snapshot(writer.serialize());
+    ASSERT_EQ(snapshot.getTypeCount(), types.size());
+    ASSERT_EQ(snapshot.getExpressionCount(), 1);
+    EXPECT_EQ(snapshot.getCount(KBSnapshotSection::POINTS), 5);
+    EXPECT_EQ(snapshot.getString(snapshot.getTypes()[1].id), "Цвет");
+
+    vector<KBType *> loaded = snapshot.materializeTypes();
+    for (size_t i = 0; i < types.size(); ++i)
+    {
+        EXPECT_EQ(loaded[i]->KRL(), types[i]->KRL());
+        EXPECT_EQ(loaded[i]->getMeta(), types[i]->getMeta());
+        delete loaded[i];
+        delete types[i];
+    }
+
+    unique_ptr<Evaluatable> loadedExpr(snapshot.materializeExpression(0));
+    EXPECT_EQ(loadedExpr->KRL(), expr.KRL());
+    KBXMLWriter expected, actual;
+    expected.write(expr);
+    actual.write(*loadedExpr);
+    EXPECT_EQ(actual.str(), expected.str());
+}
+
+// Проверяет загрузку снимка из файла через mmap.
+TEST(KBSnapshotTest, FromFile)
+{
+    KBNumericType numeric("num", 0, 10);
+    KBSnapshotWriter writer;
+    writer.addType(&numeric);
+    string path = "kb_snapshot_test.bin";
+    writer.writeToFile(path);
+
+    unique_ptr<KBSnapshot> snapshot(KBSnapshot::fromFile(path));
+    remove(path.c_str());
+    ASSERT_EQ(snapshot->getTypeCount(), 1);
+    EXPECT_EQ(snapshot->getTypes()[0].kind, KBSnapshotTypeKind::NUMERIC);
+    EXPECT_EQ(snapshot->getTypes()[0].to, 10);
+    unique_ptr<KBType> type(snapshot->materializeType(0));
+    EXPECT_EQ(type->KRL(), numeric.KRL());
+}
+
+// Проверяет, что поврежденный или несовместимый снимок отвергается.
+TEST(KBSnapshotTest, RejectsInvalidData)
+{
+    KBSnapshotWriter writer;
+    KBOperation expr("+", new KBReference("a"), new KBNumericValue(1));
+    writer.addExpression(&expr);
+    string data = writer.serialize();
+
+    EXPECT_THROW(KBSnapshot(data.substr(0, data.size() - 8)), runtime_error);
+    string badMagic = data;
+    badMagic[0] = 'X';
+    EXPECT_THROW(KBSnapshot{badMagic}, runtime_error);
+    string badVersion = data;
+    reinterpret_cast<KBSnapshotHeader *>(&badVersion[0])->version = KB_SNAPSHOT_VERSION + 1;
+    EXPECT_THROW(KBSnapshot{badVersion}, runtime_error);
+
+    // Операнд, ссылающийся на сам узел, не должен приводить к бесконечной рекурсии
+    string cyclic = data;
+    KBSnapshotHeader *header = reinterpret_cast<KBSnapshotHeader *>(&cyclic[0]);
+    KBSnapshotNode *nodes = reinterpret_cast<KBSnapshotNode *>(&cyclic[header->sections[static_cast<size_t>(KBSnapshotSection::NODES)].offset]);
+    nodes[2].left = 2;
+    KBSnapshot snapshot(cyclic);
+    EXPECT_THROW(delete snapshot.materializeExpression(0), runtime_error);
+}
+
+// Проверяет, что открытый снимок материализуется из нескольких потоков одновременно.
+TEST(KBSnapshotTest, ConcurrentMaterialize)
+{
+    KBSymbolicType colors("Цвет", {"красный", "синий", "зеленый"});
+    KBOperation expr("==", new KBReference("obj", new KBReference("attr")), new KBSymbolicValue("синий"));
+    KBSnapshotWriter writer;
+    writer.addType(&colors);
+    writer.addExpression(&expr);
+    const KBSnapshot snapshot(writer.serialize());
+
+    vector<string> results(4);
+    vector<thread> threads;
+    for (size_t t = 0; t < results.size(); ++t)
+    {
+        threads.emplace_back([&, t]()
+                             {
+            unique_ptr<KBType> type(snapshot.materializeType(0));
+            unique_ptr<Evaluatable> loaded(snapshot.materializeExpression(0));
+            results[t] = type->KRL() + loaded->KRL(); });
+    }
+    for (thread &worker : threads)
+    {
+        worker.join();
+    }
+    for (const string &result : results)
+    {
+        EXPECT_EQ(result, colors.KRL() + expr.KRL());
+    }
+}
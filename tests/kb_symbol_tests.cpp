@@ -0,0 +1,75 @@
+#include <gtest/gtest.h>
+#include "kb_symbol.h"
+#include "kb_reference.h"
+#include "kb_type.h"
+#include "kb_program.h"
+#include <thread>
+#include <vector>
+#include <unordered_set>
+
+using namespace std;
+
+// Проверяет, что одинаковые строки получают один и тот же дескриптор.
+TEST(KBSymbolTest, InternIsStable)
+{
+    KBSymbol a("ОБЪЕКТ1");
+    KBSymbol b(string("ОБЪЕКТ1"));
+    KBSymbol c("ОБЪЕКТ2");
+    EXPECT_EQ(a, b);
+    EXPECT_NE(a, c);
+    EXPECT_EQ(a.getId(), b.getId());
+    EXPECT_EQ(a.str(), "ОБЪЕКТ1");
+    EXPECT_EQ(KBSymbol::fromId(c.getId()), c);
+
+    KBSymbol empty;
+    EXPECT_TRUE(empty.empty());
+    EXPECT_EQ(KBSymbol(""), empty);
+    EXPECT_EQ(empty.str(), "");
+    EXPECT_THROW(KBSymbol::fromId(0xFFFFFFF0u), out_of_range);
+
+    unordered_set<KBSymbol> set = {a, b, c};
+    EXPECT_EQ(set.size(), 2);
+}
+
+// Проверяет интернирование из нескольких потоков.
+TEST(KBSymbolTest, ConcurrentIntern)
+{
+    vector<vector<uint32_t>> ids(4);
+    vector<thread> threads;
+    for (size_t t = 0; t < ids.size(); ++t)
+    {
+        threads.emplace_back([&ids, t]
+                             {
+            for (int i = 0; i < 2000; ++i)
+            {
+                ids[t].push_back(KBSymbol("concurrent_" + to_string(i)).getId());
+            } });
+    }
+    for (thread &t : threads)
+    {
+        t.join();
+    }
+    for (size_t t = 1; t < ids.size(); ++t)
+    {
+        EXPECT_EQ(ids[t], ids[0]);
+    }
+    EXPECT_EQ(KBSymbol::fromId(ids[0][42]).str(), "concurrent_42");
+}
+
+// Проверяет, что сущности хранят идентификаторы и значения как символы.
+TEST(KBSymbolTest, EntitiesUseSymbols)
+{
+    KBReference ref("obj", new KBReference("attr"));
+    EXPECT_EQ(ref.getIdSymbol(), KBSymbol("obj"));
+    EXPECT_EQ(ref.getTagSymbol(), KBSymbol("ref"));
+    EXPECT_EQ(ref.getId(), "obj");
+
+    KBSymbolicType type("colors", {"red", "green"});
+    EXPECT_TRUE(type.hasValue(KBSymbol("green")));
+    EXPECT_FALSE(type.hasValue(KBSymbol("blue")));
+    EXPECT_EQ(type.getValues(), vector<string>({"red", "green"}));
+
+    KBSymbolicValue value("red");
+    EXPECT_EQ(value.getSymbol(), type.getValueSymbols()[0]);
+    EXPECT_EQ(KBProgram::symbol("red").symbol, value.getSymbol().getId());
+}
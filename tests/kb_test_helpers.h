@@ -0,0 +1,15 @@
+#ifndef KB_TEST_HELPERS_H
+#define KB_TEST_HELPERS_H
+
+#include "kb_reference.h"
+#include <string>
+
+using namespace std;
+
+// Ссылка ОБЪЕКТ.АТРИБУТ для правил тестовых баз знаний
+inline KBReference *reference(const string &object, const string &property)
+{
+    return new KBReference(object, new KBReference(property));
+}
+
+#endif // KB_TEST_HELPERS_H
@@ -1,6 +1,7 @@
 #include "kb_entity.h"
 #include "kb_type.h"
 #include "membership_function.h"
+#include "utils.h"
 #include <gtest/gtest.h>
 #include <string>
 #include <vector>
@@ -31,6 +32,16 @@ TEST(KBNumericTypeTest, Initialization) {
     EXPECT_EQ(numericType.KRL(), "ТИП numType\nЧИСЛО\nОТ 0\nДО 10\nКОММЕНТАРИЙ numeric description\n");
 }
 
+// Test KRL precision and invalid bounds of KBNumericType
+TEST(KBNumericTypeTest, KRLPrecisionAndInvalidBounds) {
+    KBNumericType precise("numType", 0.1234567, 1e20);
+    EXPECT_EQ(precise.KRL(), "ТИП numType\nЧИСЛО\nОТ 0.1234567\nДО 1e+20\nКОММЕНТАРИЙ numType\n");
+
+    xmlNodePtr xml = parseXmlString("<type id=\"numType\" meta=\"number\"><from>0</from><to>abc</to></type>");
+    EXPECT_THROW(KBNumericType::fromXML(xml), invalid_argument);
+    xmlFreeDoc(xml->doc);
+}
+
 // Test KBSymbolicType class
 TEST(KBSymbolicTypeTest, Initialization) {
     vector<string> values = {"val1", "val2", "val3"};
@@ -0,0 +1,107 @@
+#include <gtest/gtest.h>
+#include "kb_validator.h"
+#include "kb_operation.h"
+#include "kb_test_helpers.h"
+#include <memory>
+
+using namespace std;
+
+static KBAssign *assign(const char *object, const char *property, KBValue *value)
+{
+    return new KBAssign(reference(object, property), value);
+}
+
+class KBValidatorTest : public ::testing::Test
+{
+protected:
+    unique_ptr<KnowledgeBase> kb;
+
+    void SetUp() override
+    {
+        kb.reset(new KnowledgeBase());
+        kb->addType(new KBNumericType("Давление", 0, 100));
+        kb->addType(new KBSymbolicType("Режим", {"норма", "авария"}));
+        kb->addObject(new KBObject("Насос", {new KBProperty("давление", "Давление"), new KBProperty("режим", "Режим")}));
+        kb->addRule(new KBRule("ПРАВИЛО1",
+                               new KBOperation(">", reference("Насос", "давление"), new KBNumericValue(10)),
+                               {assign("Насос", "режим", new KBSymbolicValue("авария"))}));
+    }
+};
+
+static vector<string> diagnosticMessages(const vector<KBDiagnostic> &diagnostics)
+{
+    vector<string> result;
+    for (const KBDiagnostic &diagnostic : diagnostics)
+    {
+        result.push_back(diagnostic.message);
+    }
+    return result;
+}
+
+// Проверяет, что корректная база проходит проверку и сущности отмечаются проверенными.
+TEST_F(KBValidatorTest, ValidKnowledgeBase)
+{
+    EXPECT_FALSE(kb->getRule("ПРАВИЛО1")->isValidated());
+    EXPECT_TRUE(KBValidator(4, 1).validate(*kb).empty());
+    EXPECT_TRUE(kb->getType("Давление")->isValidated());
+    EXPECT_TRUE(kb->getObject("Насос")->isValidated());
+    EXPECT_TRUE(kb->getRule("ПРАВИЛО1")->isValidated());
+    EXPECT_TRUE(kb->getRule("ПРАВИЛО1")->getCondition()->isValidated());
+    EXPECT_TRUE(kb->validate(*kb));
+}
+
+// Проверяет обнаружение ошибок всех видов.
+TEST_F(KBValidatorTest, Diagnostics)
+{
+    kb->addType(new KBNumericType("Плохой", 10, 0));
+    kb->addType(new KBSymbolicType("Пустой", {}));
+    kb->addObject(new KBObject("Клапан", {new KBProperty("положение", "Нет")}));
+    NonFactor badNonFactor(90, 80, 0);
+    KBOperation *unary = new KBOperation("!", reference("Насос", "режим"));
+    unary->setRight(new KBNumericValue(1));
+    kb->addRule(new KBRule("ПРАВИЛО2",
+                           new KBOperation("&&",
+                                           new KBOperation("==", reference("Насос", "режим"), new KBSymbolicValue("пожар")),
+                                           new KBOperation("==", reference("Котел", "t"), new KBNumericValue(1), &badNonFactor)),
+                           {assign("Насос", "давление", new KBNumericValue(500)), assign("Насос", "скорость", new KBNumericValue(1))}));
+    kb->addRule(new KBRule("ПРАВИЛО3", unary, {}));
+
+    vector<KBDiagnostic> diagnostics = KBValidator(4, 1).validate(*kb);
+    EXPECT_EQ(diagnosticMessages(diagnostics), vector<string>({
+                                         "Invalid range of type Плохой: from 10 to 0",
+                                         "Symbolic type Пустой has no values",
+                                         "Unknown type Нет of attribute положение",
+                                         "Value \"пожар\" is not valid for type Режим of Насос.режим",
+                                         "Invalid confidence interval [90; 80]",
+                                         "Unknown object Котел",
+                                         "Value 500 is not valid for type Давление of Насос.давление",
+                                         "Unknown attribute Насос.скорость",
+                                         "Wrong number of operands for operation not",
+                                     }));
+    EXPECT_EQ(diagnostics[2].entity, kb->getObject("Клапан")->getProperties()[0]);
+    EXPECT_FALSE(kb->getObject("Клапан")->isValidated());
+    EXPECT_FALSE(kb->getRule("ПРАВИЛО2")->isValidated());
+    EXPECT_TRUE(kb->getRule("ПРАВИЛО1")->isValidated());
+
+    // Последовательная проверка дает тот же результат
+    EXPECT_EQ(diagnosticMessages(KBValidator(1).validate(*kb)), diagnosticMessages(diagnostics));
+    EXPECT_FALSE(kb->validate(*kb));
+}
+
+// Проверяет параллельную проверку большой базы.
+TEST_F(KBValidatorTest, LargeKnowledgeBase)
+{
+    KnowledgeBase large;
+    large.addType(new KBNumericType("Число", 0, 100));
+    for (int i = 0; i < 2000; ++i)
+    {
+        string id = "Объект" + to_string(i);
+        large.addObject(new KBObject(id, {new KBProperty("x", i % 500 == 0 ? "Нет" : "Число")}));
+        large.addRule(new KBRule("Правило" + to_string(i),
+                                 new KBOperation(">", reference(id, "x"), new KBNumericValue(i)),
+                                 {assign(id.c_str(), "x", new KBNumericValue(i % 100))}));
+    }
+    vector<KBDiagnostic> diagnostics = KBValidator(8, 16).validate(large);
+    ASSERT_EQ(diagnostics.size(), 4);
+    EXPECT_EQ(diagnostics[1].entity, large.getObject("Объект500")->getProperties()[0]);
+}
@@ -145,3 +145,81 @@ TEST(KBValueTest, TestBadCastFromSymbolicToBoolean) {
 
     delete value;
 }
+
+// Проверяет, что узлы без явного коэффициента используют общий экземпляр по умолчанию.
+TEST(KBValueTest, TestSharedDefaultNonFactor) {
+    KBNumericValue a(1.0);
+    KBSymbolicValue b("x");
+    EXPECT_FALSE(a.hasOwnNonFactor());
+    EXPECT_EQ(a.getNonFactor(), NonFactor::getDefault());
+    EXPECT_EQ(a.getNonFactor(), b.getNonFactor());
+    EXPECT_TRUE(a.getNonFactorValue().isDefault());
+
+    NonFactor custom(70.0, 90.0, 1.0);
+    KBNumericValue c(2.0, &custom);
+    EXPECT_TRUE(c.hasOwnNonFactor());
+    EXPECT_NE(c.getNonFactor(), &custom);
+    EXPECT_EQ(c.getNonFactor()->getBelief(), 70.0);
+    EXPECT_EQ(c.getNonFactor()->owner, &c);
+
+    c.setNonFactor(NonFactor::getDefault());
+    EXPECT_FALSE(c.hasOwnNonFactor());
+    EXPECT_EQ(c.getNonFactor()->getBelief(), 50.0);
+}
+
+// Проверяет путь в XML общего коэффициента по умолчанию, у которого нет владельца.
+TEST(KBValueTest, TestDefaultNonFactorOwnerPath) {
+    KBNumericValue value(1.0);
+    EXPECT_EQ(value.getNonFactor()->owner, nullptr);
+    EXPECT_EQ(value.getNonFactor()->getXMLOwnerPath(), "/with");
+}
+
+// Проверяет, что явно заданный коэффициент по умолчанию по-прежнему выводится в XML.
+TEST(KBValueTest, TestExplicitDefaultNonFactorXML) {
+    NonFactor defaults;
+    KBNumericValue value(1.0, &defaults);
+    EXPECT_FALSE(value.hasOwnNonFactor());
+
+    xmlNodePtr node = value.toXML();
+    xmlNodePtr with = xmlFirstElementChild(node);
+    ASSERT_NE(with, nullptr);
+    EXPECT_STREQ((const char*)with->name, "with");
+    EXPECT_STREQ((const char*)xmlGetProp(with, BAD_CAST "belief"), "50");
+    xmlFreeNode(node);
+
+    EXPECT_EQ(value.KRL(), "1");
+}
+
+// Проверяет кратчайшую запись чисел и определение числового содержимого без регулярных выражений.
+TEST(KBValueTest, NumericCodec)
+{
+    EXPECT_EQ(doubleToString(0.1), "0.1");
+    EXPECT_EQ(doubleToString(-2.5), "-2.5");
+    EXPECT_EQ(doubleToString(1e20), "1e+20");
+    double values[] = {0.1, 1.0 / 3.0, 123456.789e-12, -0.0, 5e-324};
+    for (double value : values)
+    {
+        EXPECT_EQ(parseDouble(doubleToString(value)), value);
+    }
+
+    double parsed = 0.0;
+    EXPECT_TRUE(tryParseDouble(" +12.5\n", parsed));
+    EXPECT_EQ(parsed, 12.5);
+    EXPECT_FALSE(tryParseDouble("12,5", parsed));
+    EXPECT_THROW(parseDouble("abc"), invalid_argument);
+    // Содержимое значения - число только без пробельных символов по краям
+    EXPECT_TRUE(parseDecimal("5.", parsed));
+    EXPECT_TRUE(parseDecimal("-1e+20", parsed));
+    EXPECT_FALSE(parseDecimal("5 ", parsed));
+    EXPECT_FALSE(parseDecimal("5\n", parsed));
+    EXPECT_FALSE(parseDecimal("5\t", parsed));
+    EXPECT_FALSE(parseDecimal(" 5", parsed));
+
+    KBValue *number = KBValue::fromString("-.5e2");
+    KBValue *symbol = KBValue::fromString("nan");
+    ASSERT_NE(dynamic_cast<KBNumericValue *>(number), nullptr);
+    EXPECT_EQ(number->getContent<double>(), -50);
+    EXPECT_NE(dynamic_cast<KBSymbolicValue *>(symbol), nullptr);
+    delete number;
+    delete symbol;
+}
@@ -0,0 +1,115 @@
+#include <gtest/gtest.h>
+#include "kb_xml_reader.h"
+#include <cstdio>
+#include <fstream>
+
+using namespace std;
+
+// Проверяет потоковое чтение типов всех видов.
+TEST(KBXMLReaderTest, ReadTypes)
+{
+    string xml = R"(
+    <types>
+        <type id="num" meta="number" desc="numeric"><from>0</from><to>10.5</to></type>
+        <type id="sym" meta="string" desc="symbolic"><value>a</value><value>b</value></type>
+        <type id="fz" meta="fuzzy" desc="fuzzy">
+            <parameter min-value="0" max-value="10">
+                <value>LOW</value>
+                <mf><point x="0" y="1"/><point x="5" y="0"/></mf>
+            </parameter>
+        </type>
+    </types>)";
+    KBXMLReader reader(xml);
+    vector<KBType *> types;
+    reader.forEachElement("type", [&](KBXMLReader &r)
+                          { types.push_back(r.readType()); });
+    ASSERT_EQ(types.size(), 3);
+
+    KBNumericType *num = dynamic_cast<KBNumericType *>(types[0]);
+    ASSERT_NE(num, nullptr);
+    EXPECT_EQ(num->getId(), "num");
+    EXPECT_EQ(num->getTo(), 10.5);
+
+    KBSymbolicType *sym = dynamic_cast<KBSymbolicType *>(types[1]);
+    ASSERT_NE(sym, nullptr);
+    EXPECT_EQ(sym->getValues(), vector<string>({"a", "b"}));
+
+    KBFuzzyType *fz = dynamic_cast<KBFuzzyType *>(types[2]);
+    ASSERT_NE(fz, nullptr);
+    vector<MembershipFunction *> mfs = fz->getMembershipFunctions();
+    ASSERT_EQ(mfs.size(), 1);
+    EXPECT_EQ(mfs[0]->name, "LOW");
+    EXPECT_EQ(mfs[0]->max, 10.0);
+    EXPECT_EQ(mfs[0]->points.size(), 2);
+
+    for (MembershipFunction *mf : mfs)
+    {
+        delete mf;
+    }
+    for (KBType *type : types)
+    {
+        delete type;
+    }
+}
+
+// Проверяет чтение выражения с вложенными ссылками и коэффициентами уверенности.
+TEST(KBXMLReaderTest, ReadExpression)
+{
+    string xml = R"(
+    <eq>
+        <ref id="OBJ">
+            <ref id="X"/>
+            <with belief="70" probability="90" accuracy="0"/>
+        </ref>
+        <value>hello</value>
+        <with belief="60" probability="100" accuracy="1"/>
+    </eq>)";
+    KBXMLReader reader(xml);
+    ASSERT_TRUE(reader.nextElement());
+    Evaluatable *expression = reader.readEvaluatable();
+    KBOperation *op = dynamic_cast<KBOperation *>(expression);
+    ASSERT_NE(op, nullptr);
+    EXPECT_EQ(op->getOperator(), KBOperator::EQ);
+    EXPECT_EQ(op->getNonFactor()->getBelief(), 60.0);
+
+    const KBReference *ref = dynamic_cast<const KBReference *>(op->getLeft());
+    ASSERT_NE(ref, nullptr);
+    EXPECT_EQ(ref->getInnerKRL(), "OBJ.X");
+    EXPECT_EQ(ref->getNonFactor()->getBelief(), 70.0);
+
+    const KBValue *value = dynamic_cast<const KBValue *>(op->getRight());
+    ASSERT_NE(value, nullptr);
+    EXPECT_EQ(value->getContent<string>(), "hello");
+    EXPECT_FALSE(reader.nextElement());
+    delete expression;
+}
+
+// Проверяет чтение из файла через mmap и сообщения об ошибках.
+TEST(KBXMLReaderTest, ReadFromFile)
+{
+    string path = testing::TempDir() + "kb_xml_reader_test.xml";
+    {
+        ofstream out(path);
+        out << "<rules><and><value>True</value><not><value>False</value></not></and></rules>";
+    }
+    KBXMLReader *reader = KBXMLReader::fromFile(path);
+    ASSERT_TRUE(reader->nextElement());
+    EXPECT_EQ(reader->getName(), "rules");
+    ASSERT_TRUE(reader->nextElement());
+    Evaluatable *expression = reader->readEvaluatable();
+    EXPECT_EQ(expression->KRL(), "(true) && (! (false))");
+    delete expression;
+    delete reader;
+    remove(path.c_str());
+
+    EXPECT_THROW(KBXMLReader::fromFile(path), runtime_error);
+
+    KBXMLReader bad("<add><value>1</value></add>");
+    ASSERT_TRUE(bad.nextElement());
+    EXPECT_THROW(bad.readEvaluatable(), invalid_argument);
+
+    // Ошибка во вложенном операнде после прочитанного операнда и коэффициента
+    KBXMLReader nested("<add><value>1</value><with belief=\"60\"/><bogus/></add>");
+    ASSERT_TRUE(nested.nextElement());
+    EXPECT_THROW(nested.readEvaluatable(), invalid_argument);
+}
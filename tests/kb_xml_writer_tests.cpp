@@ -0,0 +1,150 @@
+#include <gtest/gtest.h>
+#include "kb_xml_writer.h"
+#include "kb_type.h"
+#include "kb_operation.h"
+#include "kb_reference.h"
+#include "kb_value.h"
+#include "non_factor.h"
+#include <libxml/tree.h>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace std;
+
+// Документ, сериализованный libxml2 из дерева toXML()
+static string dumpWithLibxml(const KBEntity &entity)
+{
+    xmlDocPtr doc = xmlNewDoc(BAD_CAST "1.0");
+    xmlDocSetRootElement(doc, entity.toXML());
+    xmlChar *data = nullptr;
+    int size = 0;
+    xmlDocDumpMemoryEnc(doc, &data, &size, "UTF-8");
+    string result((const char *)data, size);
+    xmlFree(data);
+    xmlFreeDoc(doc);
+    return result;
+}
+
+static string dumpWithWriter(const KBEntity &entity)
+{
+    KBXMLWriter writer;
+    writer.document(entity);
+    return writer.str();
+}
+
+// Проверяет, что список атрибутов заменяет значения и упорядочивает имена как map.
+TEST(KBAttrListTest, SetAndSort)
+{
+    KBAttrList attrs;
+    attrs.set("meta", "number");
+    attrs.set("desc", "first");
+    attrs.set("desc", "second");
+    attrs.set("id", "x");
+    ASSERT_EQ(attrs.size(), 3);
+    EXPECT_EQ(*attrs.get("desc"), "second");
+    EXPECT_EQ(attrs.get("values"), nullptr);
+
+    attrs.sort();
+    vector<string> names;
+    for (const auto &attr : attrs)
+    {
+        names.push_back(attr.first);
+    }
+    EXPECT_EQ(names, vector<string>({"desc", "id", "meta"}));
+}
+
+// Проверяет экранирование текста и атрибутов, а также запись пустых элементов.
+TEST(KBXMLWriterTest, Escaping)
+{
+    KBXMLWriter writer;
+    writer.startElement("a");
+    writer.attribute("v", "<\"&\">\n\t");
+    writer.text("1 < 2 & \"3\" > 0\r");
+    writer.startElement("b");
+    writer.endElement();
+    writer.endElement();
+    EXPECT_EQ(writer.str(), "<a v=\"&lt;&quot;&amp;&quot;&gt;&#10;&#9;\">1 &lt; 2 &amp; \"3\" &gt; 0&#13;<b/></a>");
+}
+
+// Проверяет совпадение вывода для типов всех видов с сериализацией libxml2.
+TEST(KBXMLWriterTest, TypesMatchLibxml)
+{
+    KBNumericType numeric("Температура", -10.5, 100, "Температура <воздуха>");
+    KBSymbolicType symbolic("Цвет", {"красный", "синий \"темный\""});
+    MFPoint p1(0, 0), p2(5.5, 1), p3(10, 0);
+    MembershipFunction low("низкий", 0, 10, {&p1, &p2, &p3});
+    MembershipFunction high("высокий", 5, 20, {&p2, &p3});
+    KBFuzzyType fuzzy("Уровень", {&low, &high});
+    KBType abstract("abstract");
+
+    EXPECT_EQ(dumpWithWriter(numeric), dumpWithLibxml(numeric));
+    EXPECT_EQ(dumpWithWriter(symbolic), dumpWithLibxml(symbolic));
+    EXPECT_EQ(dumpWithWriter(fuzzy), dumpWithLibxml(fuzzy));
+    EXPECT_EQ(dumpWithWriter(abstract), dumpWithLibxml(abstract));
+    EXPECT_EQ(dumpWithWriter(low), dumpWithLibxml(low));
+}
+
+// Проверяет совпадение вывода для выражений с коэффициентами уверенности.
+TEST(KBXMLWriterTest, ExpressionsMatchLibxml)
+{
+    NonFactor nf(80, 90, 5);
+    KBOperation expr("&&",
+                     new KBOperation(">", new KBReference("obj", new KBReference("attr")), new KBNumericValue(3.25)),
+                     new KBOperation("!", new KBSymbolicValue("a & b", &nf)),
+                     &nf);
+    KBOperation eq("==", new KBBooleanValue(true), new KBSymbolicValue(""));
+
+    EXPECT_EQ(dumpWithWriter(expr), dumpWithLibxml(expr));
+    EXPECT_EQ(dumpWithWriter(eq), dumpWithLibxml(eq));
+    EXPECT_EQ(dumpWithWriter(nf), dumpWithLibxml(nf));
+}
+
+// Проверяет, что элемент значения хранит коэффициент атрибутом non_factor.
+TEST(KBXMLWriterTest, ValueNonFactorAttribute)
+{
+    NonFactor nf(70, 80, 10);
+    KBSymbolicValue value("да", &nf);
+    xmlNodePtr node = value.toXML();
+    xmlChar *attr = xmlGetProp(node, BAD_CAST "non_factor");
+    ASSERT_NE(attr, nullptr);
+    EXPECT_EQ(string((const char *)attr), nf.toJSON().toStyledString());
+    xmlFree(attr);
+    xmlFreeNode(node);
+    EXPECT_EQ(dumpWithWriter(value), dumpWithLibxml(value));
+}
+
+// Проверяет запись в файловый дескриптор с небольшим буфером.
+TEST(KBXMLWriterTest, WriteToFile)
+{
+    KBSymbolicType symbolic("colors", {"red", "green", "blue"});
+    string path = "kb_xml_writer_test.xml";
+    int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    ASSERT_GE(fd, 0);
+    {
+        KBXMLWriter writer(fd, 16);
+        writer.declaration();
+        writer.startElement("types");
+        for (int i = 0; i < 100; ++i)
+        {
+            writer.write(symbolic);
+        }
+        writer.endElement();
+        writer.flush();
+        EXPECT_TRUE(writer.str().empty());
+    }
+    close(fd);
+
+    ifstream file(path);
+    stringstream content;
+    content << file.rdbuf();
+    remove(path.c_str());
+
+    KBXMLWriter expected;
+    expected.write(symbolic);
+    string text = content.str();
+    EXPECT_EQ(text.size(), string("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<types></types>").size() + 100 * expected.str().size());
+    EXPECT_NE(text.find(expected.str()), string::npos);
+}
@@ -0,0 +1,104 @@
+#include <gtest/gtest.h>
+#include "knowledge_base.h"
+#include "kb_operation.h"
+#include "kb_json_writer.h"
+#include "kb_xml_writer.h"
+#include "kb_test_helpers.h"
+#include <json/reader.h>
+#include <memory>
+
+using namespace std;
+
+class KnowledgeBaseTest : public ::testing::Test
+{
+protected:
+    unique_ptr<KnowledgeBase> kb;
+
+    void SetUp() override
+    {
+        kb.reset(new KnowledgeBase());
+        MFPoint p1(0, 0), p2(5, 1), p3(10, 0);
+        MembershipFunction low("низкое", 0, 10, {&p1, &p2, &p3});
+        kb->addType(new KBNumericType("Давление", 0, 100, "давление в атм"));
+        kb->addType(new KBSymbolicType("Режим", {"норма", "авария"}));
+        kb->addType(new KBFuzzyType("Уровень", {&low}));
+        kb->addObject(new KBObject("Насос", {new KBProperty("давление", "Давление"), new KBProperty("режим", "Режим")}));
+        kb->addRule(new KBRule("ПРАВИЛО1",
+                               new KBOperation(">", reference("Насос", "давление"), new KBNumericValue(10)),
+                               {new KBAssign(reference("Насос", "режим"), new KBSymbolicValue("авария"))}));
+    }
+};
+
+// Проверяет хеш-индекс символов: вставку, повторные ключи и рост таблицы.
+TEST(KBSymbolIndexTest, InsertAndFind)
+{
+    KBSymbolIndex index;
+    EXPECT_EQ(index.find("a"), KBSymbolIndex::NOT_FOUND);
+    for (uint32_t i = 0; i < 1000; ++i)
+    {
+        EXPECT_TRUE(index.insert(KBSymbol("key" + to_string(i)), i));
+    }
+    EXPECT_FALSE(index.insert(KBSymbol("key5"), 0));
+    EXPECT_FALSE(index.insert(KBSymbol(), 0));
+    EXPECT_EQ(index.size(), 1000);
+    for (uint32_t i = 0; i < 1000; ++i)
+    {
+        EXPECT_EQ(index.find(KBSymbol("key" + to_string(i))), i);
+    }
+    EXPECT_FALSE(index.contains(KBSymbol("missing")));
+    EXPECT_FALSE(index.contains(KBSymbol()));
+}
+
+// Проверяет поиск сущностей по идентификатору и запрет повторных идентификаторов.
+TEST_F(KnowledgeBaseTest, Lookup)
+{
+    EXPECT_EQ(kb->size(), 5);
+    EXPECT_EQ(kb->getType("Режим")->getMeta(), "string");
+    EXPECT_EQ(kb->getTypeIndex("Уровень"), 2);
+    EXPECT_EQ(kb->getType("Нет"), nullptr);
+    EXPECT_EQ(kb->getObject("Насос")->owner, kb.get());
+    EXPECT_EQ(kb->getProperty("Насос", "режим")->getType(), "Режим");
+    EXPECT_EQ(kb->getProperty("Насос", "нет"), nullptr);
+    EXPECT_NE(kb->getRule("ПРАВИЛО1"), nullptr);
+    EXPECT_THROW(kb->addType(new KBNumericType("Давление", 0, 1)), invalid_argument);
+    EXPECT_EQ(kb->getTypes().size(), 3);
+}
+
+// Проверяет, что база знаний восстанавливается из XML и JSON без потерь.
+TEST_F(KnowledgeBaseTest, RoundTrip)
+{
+    string krl = kb->KRL();
+    EXPECT_EQ(krl.find("ТИП Давление"), 0);
+    EXPECT_NE(krl.find("\n\nОБЪЕКТ Насос\n"), string::npos);
+    EXPECT_NE(krl.find("\n\nПРАВИЛО ПРАВИЛО1\n"), string::npos);
+
+    xmlNodePtr xml = kb->toXML();
+    unique_ptr<KnowledgeBase> fromXML(KnowledgeBase::fromXML(xml));
+    xmlFreeNode(xml);
+    EXPECT_EQ(fromXML->KRL(), krl);
+    EXPECT_GT(fromXML->getArena().getBytesUsed(), 0);
+    EXPECT_TRUE(fromXML->getArena().owns(fromXML->getRule("ПРАВИЛО1")));
+
+    Json::Value json = kb->toJSON();
+    unique_ptr<KnowledgeBase> fromJSON(KnowledgeBase::fromJSON(json));
+    EXPECT_EQ(fromJSON->KRL(), krl);
+    EXPECT_EQ(fromJSON->toJSON(), json);
+}
+
+// Проверяет, что потоковые сериализаторы дают то же, что toXML() и toJSON().
+TEST_F(KnowledgeBaseTest, StreamingWriters)
+{
+    KBJSONWriter jsonWriter;
+    jsonWriter.write(*kb);
+    Json::Value parsed;
+    ASSERT_TRUE(Json::Reader().parse(jsonWriter.str(), parsed));
+    EXPECT_EQ(parsed, kb->toJSON());
+
+    KBXMLWriter xmlWriter;
+    xmlWriter.write(*kb);
+    xmlDocPtr doc = xmlReadMemory(xmlWriter.str().data(), xmlWriter.str().size(), "kb.xml", nullptr, 0);
+    ASSERT_NE(doc, nullptr);
+    unique_ptr<KnowledgeBase> loaded(KnowledgeBase::fromXML(xmlDocGetRootElement(doc)));
+    xmlFreeDoc(doc);
+    EXPECT_EQ(loaded->KRL(), kb->KRL());
+}
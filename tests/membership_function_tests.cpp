@@ -67,8 +67,8 @@ TEST(MembershipFunctionTest, GetAttrs) {
     vector<MFPoint*> points = {new MFPoint(1.5, 2.5), new MFPoint(3.5, 4.5)};
     MembershipFunction mf("TestFunction", 0.0, 5.0, points);
     auto attrs = mf.getAttrs();
-    EXPECT_EQ(attrs["min-value"], "0.000000");
-    EXPECT_EQ(attrs["max-value"], "5.000000");
+    EXPECT_EQ(attrs["min-value"], "0");
+    EXPECT_EQ(attrs["max-value"], "5");
 }
 
 TEST(MembershipFunctionTest, ToJSON) {
@@ -136,3 +136,77 @@ TEST(MembershipFunctionTest, KRL) {
     MembershipFunction mf("TestFunction", 0.0, 5.0, points);
     EXPECT_EQ(mf.KRL(), "\"TestFunction\" 0 5 2 ={1.5|2.5; 3.5|4.5}");
 }
+
+TEST(MembershipFunctionTest, EvaluateTrapezoid) {
+    vector<MFPoint*> points = {new MFPoint(0, 0), new MFPoint(2, 1), new MFPoint(4, 1), new MFPoint(8, 0)};
+    MembershipFunction mf("Trapezoid", 0.0, 10.0, points);
+    EXPECT_DOUBLE_EQ(mf.evaluate(-5), 0.0);
+    EXPECT_DOUBLE_EQ(mf.evaluate(0), 0.0);
+    EXPECT_DOUBLE_EQ(mf.evaluate(1), 0.5);
+    EXPECT_DOUBLE_EQ(mf.evaluate(2), 1.0);
+    EXPECT_DOUBLE_EQ(mf.evaluate(3), 1.0);
+    EXPECT_DOUBLE_EQ(mf.evaluate(6), 0.5);
+    EXPECT_DOUBLE_EQ(mf.evaluate(8), 0.0);
+    EXPECT_DOUBLE_EQ(mf.evaluate(100), 0.0);
+}
+
+TEST(MembershipFunctionTest, EvaluateUnsortedAndStep) {
+    // Точки сортируются по x; одинаковые x дают ступеньку, непрерывную справа
+    vector<MFPoint*> points = {new MFPoint(5, 1), new MFPoint(0, 0), new MFPoint(5, 0.2), new MFPoint(10, 1)};
+    MembershipFunction mf("Step", 0.0, 10.0, points);
+    EXPECT_EQ(mf.getCurveX(), vector<double>({0, 5, 5, 10}));
+    EXPECT_DOUBLE_EQ(mf.evaluate(2.5), 0.5);
+    EXPECT_DOUBLE_EQ(mf.evaluate(5), 0.2);
+    EXPECT_DOUBLE_EQ(mf.evaluate(7.5), 0.6);
+}
+
+TEST(MembershipFunctionTest, EvaluateDegenerate) {
+    MembershipFunction empty("Empty", 0.0, 1.0, {});
+    EXPECT_DOUBLE_EQ(empty.evaluate(0.5), 0.0);
+
+    vector<MFPoint*> points = {new MFPoint(3, 0.7)};
+    MembershipFunction single("Single", 0.0, 10.0, points);
+    EXPECT_DOUBLE_EQ(single.evaluate(0), 0.7);
+    EXPECT_DOUBLE_EQ(single.evaluate(9), 0.7);
+
+    single.points[0]->y = 0.3;
+    single.updateCurve();
+    EXPECT_DOUBLE_EQ(single.evaluate(9), 0.3);
+}
+
+TEST(MembershipFunctionTest, LookupTable) {
+    // Изломы кривой не совпадают с узлами сетки
+    vector<MFPoint*> points = {new MFPoint(0.3, 0), new MFPoint(3.7, 1), new MFPoint(5.1, 1), new MFPoint(9.9, 0)};
+    MembershipFunction mf("Trapezoid", 0.0, 10.0, points);
+    EXPECT_FALSE(mf.hasLookupTable());
+    ASSERT_TRUE(mf.useLookupTable(4096, 1e-3));
+    EXPECT_TRUE(mf.hasLookupTable());
+    EXPECT_LE(mf.getLookupError(), 1e-3);
+    for (double x = -1.0; x <= 11.0; x += 0.01) {
+        EXPECT_NEAR(mf.evaluate(x), mf.evaluateExact(x), mf.getLookupError() + 1e-7) << x;
+    }
+
+    mf.dropLookupTable();
+    EXPECT_FALSE(mf.hasLookupTable());
+    EXPECT_DOUBLE_EQ(mf.evaluate(2.0), mf.evaluateExact(2.0));
+}
+
+TEST(MembershipFunctionTest, LookupTableErrorBound) {
+    // Ступенька внутри ячейки сетки дает отклонение порядка высоты скачка
+    vector<MFPoint*> points = {new MFPoint(0, 0), new MFPoint(5.0001, 0), new MFPoint(5.0001, 1), new MFPoint(10, 1)};
+    MembershipFunction mf("Step", 0.0, 10.0, points);
+    EXPECT_FALSE(mf.useLookupTable(16, 1e-3));
+    EXPECT_FALSE(mf.hasLookupTable());
+    EXPECT_GT(mf.getLookupError(), 0.1);
+    EXPECT_DOUBLE_EQ(mf.evaluate(5.0), 0.0);
+
+    // Без отрезков между узлами таблица точна; после изменения точек таблица перестраивается
+    vector<MFPoint*> line = {new MFPoint(0, 0), new MFPoint(10, 1)};
+    MembershipFunction ramp("Ramp", 0.0, 10.0, line);
+    ASSERT_TRUE(ramp.useLookupTable(16, 1e-6));
+    EXPECT_NEAR(ramp.evaluate(2.5), 0.25, 1e-7);
+    ramp.points[1]->y = 0.5;
+    ramp.updateCurve();
+    EXPECT_TRUE(ramp.hasLookupTable());
+    EXPECT_NEAR(ramp.evaluate(2.5), 0.125, 1e-7);
+}